@@ -0,0 +1,43 @@
+#include "benchmark.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+void printResults(const std::vector<BenchmarkResult>& results)
+{
+    std::printf("%-28s %12s %12s %10s %10s %9s %9s\n",
+        "benchmark", "instructions", "cycles", "time [s]", "MHz", "ns/instr", "x real");
+    for (auto& result : results)
+        std::printf("%-28s %12llu %12llu %10.4f %10.2f %9.2f %9.1f\n",
+            result.name.c_str(), (unsigned long long)result.instructions, (unsigned long long)result.cycles,
+            result.hostSeconds, result.getEmulatedMHz(), result.getNsPerInstruction(), result.getRealTimeRatio());
+}
+
+bool writeResultsJSON(const char* filename, const std::vector<BenchmarkResult>& results)
+{
+    std::ofstream file{ filename };
+    if (!file)
+        return false;
+
+    // Names are plain identifiers, nothing has to be escaped.
+    file << std::setprecision(10) << "{\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        auto& result = results[i];
+        file << (i ? ",\n" : "\n")
+             << "    {\n"
+             << "      \"name\": \"" << result.name << "\",\n"
+             << "      \"clock_hz\": " << result.clockFrequency << ",\n"
+             << "      \"instructions\": " << result.instructions << ",\n"
+             << "      \"cycles\": " << result.cycles << ",\n"
+             << "      \"host_seconds\": " << result.hostSeconds << ",\n"
+             << "      \"emulated_mhz\": " << result.getEmulatedMHz() << ",\n"
+             << "      \"host_ns_per_instruction\": " << result.getNsPerInstruction() << ",\n"
+             << "      \"cycles_per_host_second\": " << result.getCyclesPerSecond() << ",\n"
+             << "      \"real_time_ratio\": " << result.getRealTimeRatio() << "\n"
+             << "    }";
+    }
+    file << "\n  ]\n}\n";
+
+    return (bool)file;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "shared/source/types.hpp"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+struct BenchmarkResult
+{
+    std::string name;
+    double clockFrequency; // of emulated CPU in Hz, cycles are counted in its units
+    u64 instructions = 0;
+    u64 cycles = 0;
+    double hostSeconds = 0.0;
+
+    double getEmulatedMHz() const { return cycles / hostSeconds / 1000000.0; }
+    double getNsPerInstruction() const { return hostSeconds * 1000000000.0 / instructions; }
+    double getCyclesPerSecond() const { return cycles / hostSeconds; }
+    double getRealTimeRatio() const { return getCyclesPerSecond() / clockFrequency; }
+};
+
+class Stopwatch
+{
+public:
+    Stopwatch() : m_start{ Clock::now() } {}
+
+    double getSeconds() const { return std::chrono::duration<double>(Clock::now() - m_start).count(); }
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point m_start;
+};
+
+void printResults(const std::vector<BenchmarkResult>& results);
+bool writeResultsJSON(const char* filename, const std::vector<BenchmarkResult>& results);
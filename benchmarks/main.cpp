@@ -0,0 +1,318 @@
+#include "benchmark.hpp"
+
+#include "emulators/gameboy/gameboy.hpp"
+#include "emulators/psx/cpu.hpp"
+#include "shared/source/devices/cpu40xx/cpu40xx.hpp"
+#include "shared/source/devices/cpu6502/cpu6502.hpp"
+#include "shared/source/devices/cpu8080/cpu8080.hpp"
+#include "shared/source/file_io.hpp"
+#include "shared/source/memory_bus.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+// Synthetic workloads run this many instructions, ROM based ones run until the ROM finishes.
+static constexpr u64 SYNTHETIC_INSTRUCTIONS = 20'000'000;
+
+// Each workload returns nullptr on success or a reason why it couldn't run.
+using Workload = const char* (*)(BenchmarkResult& result);
+
+struct Benchmark
+{
+    const char* name;
+    double clockFrequency;
+    Workload workload;
+};
+
+static const char* runCPU6502FunctionalTest(BenchmarkResult& result)
+{
+    std::vector<u8> ram(0x10000);
+    size_t size = ram.size();
+    if (!readFile("test_files/6502/6502_functional_test.bin", (char*)ram.data(), size, true))
+        return "6502_functional_test.bin not found";
+
+    MemoryBus16 bus;
+    bus.mapMemory({ 0x0000, 0xFFFF }, ram.data());
+    CPU6502Core<MemoryBus16> cpu{ bus };
+    cpu.reset();
+    cpu.setPC(0x0400);
+
+    // Same end condition as CPU6502Core::runUntilEndlessLoop().
+    Stopwatch stopwatch;
+    u16 lastPC = cpu.getPC();
+    u8 counter = 0;
+    while (counter < 10) {
+        result.cycles += cpu.runInstruction();
+        result.instructions++;
+
+        counter = lastPC == cpu.getPC() ? counter + 1 : 0;
+        lastPC = cpu.getPC();
+    }
+    result.hostSeconds = stopwatch.getSeconds();
+
+    return cpu.getPC() == 0x3469 ? nullptr : "functional test failed";
+}
+
+static const char* runCPU8080Checksum(BenchmarkResult& result)
+{
+    // Sums 4KB block into D and stores running sums back, forever.
+    static constexpr u8 PROGRAM[] = {
+        0x21, 0x00, 0x10, // 0000: LXI H, 1000h
+        0x01, 0x00, 0x10, // 0003: LXI B, 1000h
+        0x7E,             // 0006: MOV A, M
+        0x82,             // 0007: ADD D
+        0x57,             // 0008: MOV D, A
+        0x77,             // 0009: MOV M, A
+        0x23,             // 000A: INX H
+        0x0B,             // 000B: DCX B
+        0x78,             // 000C: MOV A, B
+        0xB1,             // 000D: ORA C
+        0xC2, 0x06, 0x00, // 000E: JNZ 0006h
+        0xC3, 0x00, 0x00  // 0011: JMP 0000h
+    };
+
+    std::vector<u8> memory(0x10000);
+    std::memcpy(memory.data(), PROGRAM, sizeof(PROGRAM));
+
+    CPU8080 cpu;
+    cpu.mapReadMemoryCallback([&](u16 address) { return memory[address]; });
+    cpu.mapWriteMemoryCallback([&](u16 address, u8 data) { memory[address] = data; });
+    cpu.mapReadIOCallback([](u8) -> u8 { return 0; });
+    cpu.mapWriteIOCallback([](u8, u8) {});
+    cpu.reset();
+
+    Stopwatch stopwatch;
+    for (; result.instructions < SYNTHETIC_INSTRUCTIONS; result.instructions++)
+        result.cycles += cpu.runInstruction();
+    result.hostSeconds = stopwatch.getSeconds();
+
+    return nullptr;
+}
+
+// Tells whether a ROM that settled in its final loop reported success.
+using ROMCheck = bool (*)(const Gameboy& gameboy, const std::string& serialOutput);
+
+static const char* runGameboyROMs(BenchmarkResult& result, const char* directory, std::initializer_list<const char*> roms, ROMCheck hasPassed)
+{
+    // Some of the ROMs never settle in a loop when they fail.
+    static constexpr u64 MAX_INSTRUCTIONS_PER_ROM = 100'000'000;
+
+    for (const char* rom : roms) {
+        auto gameboy = std::make_unique<Gameboy>();
+        std::string path = std::string{ directory } + rom + ".gb";
+        if (!gameboy->loadCartridge(path.c_str(), true, Cartridge::RAMMode::Volatile))
+            return "test ROMs not found";
+        std::string serialOutput;
+        gameboy->mapSerialOutputCallback([&serialOutput](u8 data) { serialOutput += (char)data; });
+        gameboy->reset();
+
+        // Same end condition as Gameboy::runUntilEndlessLoop().
+        Stopwatch stopwatch;
+        u64 instructions = 0;
+        u16 lastPC = gameboy->getCPU().getState().PC;
+        u8 counter = 0;
+        while (counter < 10 && instructions < MAX_INSTRUCTIONS_PER_ROM) {
+            result.cycles += gameboy->runInstruction();
+            instructions++;
+
+            auto& state = gameboy->getCPU().getState();
+            counter = (lastPC == state.PC && !state.IsHalted) ? counter + 1 : 0;
+            lastPC = state.PC;
+        }
+        result.hostSeconds += stopwatch.getSeconds();
+        result.instructions += instructions;
+
+        if (counter < 10) {
+            std::cerr << rom << " did not finish\n";
+            return "test ROM did not finish";
+        }
+        if (!hasPassed(*gameboy, serialOutput)) {
+            std::cerr << rom << " failed\n";
+            return "test ROM failed";
+        }
+    }
+
+    return nullptr;
+}
+
+static const char* runGameboyBlargg(BenchmarkResult& result)
+{
+    return runGameboyROMs(result, "test_files/gameboy/blargg/", {
+        "01-special", "02-interrupts", "03-op sp,hl", "04-op r,imm", "05-op rp", "06-ld r,r",
+        "07-jr,jp,call,ret,rst", "08-misc instrs", "09-op r,r", "10-bit ops", "11-op a,(hl)"
+    }, [](const Gameboy&, const std::string& serialOutput) {
+        return serialOutput.find("Passed") != std::string::npos;
+    });
+}
+
+static const char* runGameboyMooneye(BenchmarkResult& result)
+{
+    return runGameboyROMs(result, "test_files/gameboy/mooneye/", {
+        "daa", "dma/basic", "dma/oam_dma_timing", "timer/div_write", "timer/rapid_toggle",
+        "timer/tim00", "timer/tim01", "timer/tim10", "timer/tim11", "timer/tima_reload",
+        "timing/div_timing", "timing/ei_timing", "mem_oam", "reg_f"
+    }, [](const Gameboy& gameboy, const std::string&) {
+        // Mooneye ROMs load Fibonacci numbers into registers on success.
+        const auto& state = gameboy.getCPU().getState();
+        return state.BC == 0x0305 && state.DE == 0x080D && state.HL == 0x1522;
+    });
+}
+
+static const char* runCPU4004Loop(BenchmarkResult& result)
+{
+    // Nested ISZ loops doing RAM read-modify-write, forever.
+    static constexpr u8 PROGRAM[] = {
+        0x20, 0x00, // 000: FIM P0, 00h
+        0x21,       // 002: SRC P0
+        0xA2,       // 003: LD R2
+        0x83,       // 004: ADD R3
+        0xE0,       // 005: WRM
+        0xB3,       // 006: XCH R3
+        0x71, 0x02, // 007: ISZ R1, 002h
+        0x70, 0x02, // 009: ISZ R0, 002h
+        0x72, 0x02, // 00B: ISZ R2, 002h
+        0x40, 0x00  // 00D: JUN 000h
+    };
+    // Instruction cycle is 8 clock periods, these instructions take two of them.
+    auto isTwoCycle = [](u8 opcode) {
+        u8 group = opcode >> 4;
+        return group == 0x1 || (group == 0x2 && !(opcode & 1)) || group == 0x4 || group == 0x5 || group == 0x7;
+    };
+
+    u8 ram[0x100]{};
+    u8 status[0x100]{};
+    CPU40xx cpu{ CPU40xx::Mode::Intel4004 };
+    cpu.mapReadROMCallback([&](u16 address) -> u8 { return address < sizeof(PROGRAM) ? PROGRAM[address] : 0x40; });
+    cpu.mapReadRAMCallback([&](u8 address) { return ram[address]; });
+    cpu.mapWriteRAMCallback([&](u8 address, u8 data) { ram[address] = data; });
+    cpu.mapReadIOCallback([](u8) -> u8 { return 0; });
+    cpu.mapWriteIOCallback([](u8, u8) {});
+    cpu.mapReadRAMStatus([&](u8 address) { return status[address]; });
+    cpu.mapWriteRAMStatus([&](u8 address, u8 data) { status[address] = data; });
+    cpu.reset();
+
+    Stopwatch stopwatch;
+    for (; result.instructions < SYNTHETIC_INSTRUCTIONS; result.instructions++) {
+        result.cycles += isTwoCycle(PROGRAM[cpu.getPC()]) ? 16 : 8;
+        cpu.clock();
+    }
+    result.hostSeconds = stopwatch.getSeconds();
+
+    return nullptr;
+}
+
+static const char* runPSXCPULoop(BenchmarkResult& result)
+{
+    // Runs from reset vector in place of BIOS. Sums 4KB of RAM storing running sums back, forever.
+    static constexpr u32 PROGRAM[] = {
+        0x3C088001, // BFC00000: LUI   t0, 8001h
+        0x34090400, // BFC00004: ORI   t1, zero, 400h
+        0x8D0A0000, // BFC00008: LW    t2, 0(t0)
+        0x00000000, // BFC0000C: NOP   (load delay)
+        0x016A5821, // BFC00010: ADDU  t3, t3, t2
+        0xAD0B0000, // BFC00014: SW    t3, 0(t0)
+        0x25080004, // BFC00018: ADDIU t0, t0, 4
+        0x2529FFFF, // BFC0001C: ADDIU t1, t1, -1
+        0x1520FFF9, // BFC00020: BNE   t1, zero, BFC00008
+        0x00000000, // BFC00024: NOP   (branch delay)
+        0x0BF00000, // BFC00028: J     BFC00000
+        0x00000000  // BFC0002C: NOP   (branch delay)
+    };
+    static constexpr u32 BIOS_START = 0x1FC00000;
+
+    std::vector<u8> ram(2 * 1024 * 1024);
+    auto read32 = [&](u32 address) -> u32 {
+        address &= 0x1FFFFFFF;
+        if (address >= BIOS_START) return PROGRAM[(address - BIOS_START) / 4 % std::size(PROGRAM)];
+
+        u32 data;
+        std::memcpy(&data, ram.data() + address % ram.size(), 4);
+        return data;
+    };
+
+    PSX::CPU cpu;
+    cpu.mapRead8MemoryCallback([&](u32 address) { return (u8)(read32(address & ~3u) >> (address & 3) * 8); });
+    cpu.mapRead16MemoryCallback([&](u32 address) { return (u16)(read32(address & ~3u) >> (address & 2) * 8); });
+    cpu.mapRead32MemoryCallback(read32);
+    cpu.mapWrite8MemoryCallback([&](u32 address, u8 data) { ram[(address & 0x1FFFFFFF) % ram.size()] = data; });
+    cpu.mapWrite16MemoryCallback([&](u32 address, u16 data) { std::memcpy(ram.data() + (address & 0x1FFFFFFF) % ram.size(), &data, 2); });
+    cpu.mapWrite32MemoryCallback([&](u32 address, u32 data) { std::memcpy(ram.data() + (address & 0x1FFFFFFF) % ram.size(), &data, 4); });
+    cpu.reset();
+
+    // CPU has no timing model yet, every instruction is counted as a single cycle.
+    Stopwatch stopwatch;
+    for (; result.instructions < SYNTHETIC_INSTRUCTIONS; result.instructions++)
+        cpu.clock();
+    result.cycles = result.instructions;
+    result.hostSeconds = stopwatch.getSeconds();
+
+    return nullptr;
+}
+
+static const Benchmark BENCHMARKS[] = {
+    { "cpu6502/functional_test", 1000000.0, runCPU6502FunctionalTest },
+    { "cpu8080/checksum_loop", 2000000.0, runCPU8080Checksum },
+    { "gameboy/blargg_cpu_instrs", 1024.0 * 1024.0, runGameboyBlargg },
+    { "gameboy/mooneye", 1024.0 * 1024.0, runGameboyMooneye },
+    { "cpu4004/isz_loop", 740000.0, runCPU4004Loop },
+    { "psx_cpu/checksum_loop", 33868800.0, runPSXCPULoop },
+};
+
+static void printUsage()
+{
+    std::cerr << "usage: benchmarks [--json file.json] [--repeat N] [--filter text]\n";
+}
+
+int main(int argc, char* argv[])
+{
+    const char* jsonPath = nullptr;
+    const char* filter = nullptr;
+    u32 repeat = 3;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--json") == 0 && hasValue) jsonPath = argv[++i];
+        else if (std::strcmp(argv[i], "--repeat") == 0 && hasValue) repeat = (u32)std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--filter") == 0 && hasValue) filter = argv[++i];
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::vector<BenchmarkResult> results;
+    for (auto& benchmark : BENCHMARKS) {
+        if (filter && !std::strstr(benchmark.name, filter))
+            continue;
+
+        // Fastest run is the one least disturbed by the host.
+        BenchmarkResult best;
+        const char* error = nullptr;
+        for (u32 i = 0; i < repeat && !error; i++) {
+            BenchmarkResult result{ benchmark.name, benchmark.clockFrequency };
+            error = benchmark.workload(result);
+            if (!error && (i == 0 || result.hostSeconds < best.hostSeconds))
+                best = result;
+        }
+
+        if (error) {
+            std::cerr << benchmark.name << " skipped: " << error << '\n';
+            continue;
+        }
+        results.push_back(best);
+    }
+
+    printResults(results);
+
+    if (jsonPath && !writeResultsJSON(jsonPath, results)) {
+        std::cerr << "Could not write " << jsonPath << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+#
+# Copyright (C) 2021-2022 Konstanty Misiak
+#
+# SPDX-License-Identifier: MIT
+#
+
+option(EMULATORS_EMBED_FIRMWARE "Link firmware images found at configure time into the binaries" ON)
+set(EMULATORS_FIRMWARE_DIR ${CMAKE_SOURCE_DIR}/rom CACHE PATH "Directory with user provided firmware images, laid out like rom/ next to the binaries")
+
+# embed_firmware(<target> <header> <name> <file> [<name> <file> ...])
+#
+# Generates <header>, included privately by <target>, with a page aligned
+# `inline constexpr std::array<u8, N> firmware::<name>` for every image.
+# Images missing at configure time become empty arrays and the code reads them at runtime
+# instead, see shared/source/firmware.hpp. Adding an image later needs a reconfigure.
+function(embed_firmware target_name header)
+    set(generated_dir ${CMAKE_CURRENT_BINARY_DIR}/generated)
+    set(definitions "")
+
+    set(images ${ARGN})
+    list(LENGTH images images_length)
+    math(EXPR last_index "${images_length} - 1")
+    foreach(name_index RANGE 0 ${last_index} 2)
+        math(EXPR file_index "${name_index} + 1")
+        list(GET images ${name_index} name)
+        list(GET images ${file_index} file)
+
+        set(size 0)
+        set(bytes "")
+        if(EMULATORS_EMBED_FIRMWARE AND EXISTS ${file})
+            set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${file})
+            file(READ ${file} hex HEX)
+            string(LENGTH "${hex}" hex_length)
+            math(EXPR size "${hex_length} / 2")
+            string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+            string(REPEAT "0x..," 16 line_pattern)
+            string(REGEX REPLACE "(${line_pattern})" "\n    \\1" bytes "${bytes}")
+            string(APPEND bytes "\n")
+        endif()
+
+        string(APPEND definitions "alignas(4096) inline constexpr std::array<u8, ${size}> ${name}{${bytes}};\n")
+    endforeach()
+
+    file(CONFIGURE OUTPUT ${generated_dir}/${header} CONTENT "// Generated by embed_firmware(), do not edit.
+#pragma once
+#include \"shared/source/types.hpp\"
+
+#include <array>
+
+namespace firmware {
+
+${definitions}
+} // namespace firmware
+" @ONLY)
+
+    target_sources(${target_name} PRIVATE ${generated_dir}/${header})
+    target_include_directories(${target_name} PRIVATE ${generated_dir})
+endfunction()
@@ -1,9 +1,12 @@
 #include "c64.hpp"
+#include "c64_firmware.hpp"
 #include "shared/source/address_range.hpp"
-#include "shared/source/file_io.hpp"
+#include "shared/source/devices/cpu6502/cpu6502.inl"
+#include "shared/source/save_state.hpp"
 
 #include <cassert>
-#include <iostream>
+
+template class CPU6502Core<C64::Bus>;
 
 namespace C64 {
 
@@ -15,22 +18,34 @@ namespace C64 {
     static constexpr AddressRange16 BASIC_RANGE{ 0xA000, 0xBFFF };
     static constexpr AddressRange16 RAM_RANGE{ 0x0000, 0x9FFF };
 
+    static constexpr u32 STATE_ID = makeStateID("C64 ");
+    static constexpr u32 STATE_VERSION = 1;
+
     Emulator::Emulator()
     {
-        size_t size = 0x2000;
-        if (!readFile("rom/c64c/kernal.bin", (char*)m_KERNAL, size, true))
-            std::cerr << "Could not read KERNAL ROM file!\n";
-
-        size = 0x1000;
-        if (!readFile("rom/c64c/characters.bin", (char*)m_characters, size, true))
-            std::cerr << "Could not read characters ROM file!\n";
-
-        size = 0x2000;
-        if (!readFile("rom/c64c/basic.bin", (char*)m_BASIC, size, true))
-            std::cerr << "Could not read BASIC ROM file!\n";
-
-        m_cpu.mapReadMemoryCallback([this](u16 address) { return memoryRead(address); });
-        m_cpu.mapWriteMemoryCallback([this](u16 address, u8 data) { return memoryWrite(address, data); });
+        m_KERNAL.load(firmware::c64_kernal, "rom/c64c/kernal.bin", 0x2000);
+        m_characters.load(firmware::c64_characters, "rom/c64c/characters.bin", 0x1000);
+        m_BASIC.load(firmware::c64_basic, "rom/c64c/basic.bin", 0x2000);
+
+        m_bus.mapMemory(RAM_RANGE, m_RAM);
+        m_bus.mapPortWriteCallback([this](u16 address, u8 data) {
+            if (address == 0x0000) m_cpuDDR = data;
+            if (address == 0x0001) {
+                m_cpuPORT = data;
+                mapKERNAL();
+            }
+        });
+        m_bus.mapReadMemory(BASIC_RANGE, m_BASIC.getData());
+        m_bus.mapWriteMemory(BASIC_RANGE, m_RAM + BASIC_RANGE.start);
+        m_bus.mapReadCallback(VIC_RANGE, [this](u16 address) { return m_vic.load8(address - VIC_RANGE.start); });
+        m_bus.mapWriteCallback(VIC_RANGE, [this](u16 address, u8 data) { m_vic.store8(address - VIC_RANGE.start, data); });
+        m_bus.mapWriteCallback(SID_RANGE, [this](u16 address, u8 data) { m_sid.store8(address - SID_RANGE.start, data); });
+        m_bus.mapReadCallback(CIA1_RANGE, [this](u16 address) { return m_cia1.load8(address - CIA1_RANGE.start); });
+        m_bus.mapWriteCallback(CIA1_RANGE, [this](u16 address, u8 data) { m_cia1.store8(address - CIA1_RANGE.start, data); });
+        m_bus.mapReadCallback(CIA2_RANGE, [this](u16 address) { return m_cia2.load8(address - CIA2_RANGE.start); });
+        m_bus.mapWriteCallback(CIA2_RANGE, [this](u16 address, u8 data) { m_cia2.store8(address - CIA2_RANGE.start, data); });
+        m_bus.mapWriteMemory(KERNAL_RANGE, m_RAM + KERNAL_RANGE.start);
+        mapKERNAL();
 
         m_cpu.reset();
     }
@@ -40,71 +55,54 @@ namespace C64 {
         m_cpu.clock();
     }
 
-    u8 Emulator::memoryRead(u16 address) const
+    u32 Emulator::runCycles(u32 budget)
     {
-        u16 offset;
-
-        if (KERNAL_RANGE.contains(address, offset)) {
-            return ((m_cpuPORT & 3) > 1) ? m_KERNAL[offset] : m_RAM[address];
-        }
-
-        if (CIA2_RANGE.contains(address, offset)) return m_cia2.load8(offset);
-
-        if (CIA1_RANGE.contains(address, offset)) return m_cia1.load8(offset);
-
-        if (VIC_RANGE.contains(address, offset)) return m_vic.load8(offset);
-
-        if (BASIC_RANGE.contains(address, offset)) return m_BASIC[offset];
+        m_bus.syncWatchpoints();
+        return m_cpu.runCycles(budget);
+    }
 
-        if (RAM_RANGE.contains(address, offset)) return m_RAM[offset];
+    void Emulator::saveState(std::vector<u8>& state) const
+    {
+        StateWriter writer{ state, STATE_ID, STATE_VERSION };
+        writer.writeBytes(m_RAM, sizeof(m_RAM));
+        writer.writeBytes(m_upperRAM, sizeof(m_upperRAM));
+        writer.write(m_cpuDDR);
+        writer.write(m_cpuPORT);
+        m_cpu.saveState(writer);
+        m_cia1.saveState(writer);
+        m_cia2.saveState(writer);
+        m_sid.saveState(writer);
+        m_vic.saveState(writer);
+    }
 
-        assert(false && "Unhandled memory read!");
-        return 0;
+    bool Emulator::loadState(std::span<const u8> state)
+    {
+        StateReader reader{ state, STATE_ID, STATE_VERSION };
+        if (!reader.isValid())
+            return false;
+
+        reader.readBytes(m_RAM, sizeof(m_RAM));
+        reader.readBytes(m_upperRAM, sizeof(m_upperRAM));
+        reader.read(m_cpuDDR);
+        reader.read(m_cpuPORT);
+        m_cpu.loadState(reader);
+        m_cia1.loadState(reader);
+        m_cia2.loadState(reader);
+        m_sid.loadState(reader);
+        m_vic.loadState(reader);
+
+        // Bus mapping depends on the restored processor port.
+        mapKERNAL();
+
+        return reader.isValid() && reader.isAtEnd();
     }
 
-    void Emulator::memoryWrite(u16 address, u8 data)
+    void Emulator::mapKERNAL()
     {
-        if (address == 0x0000) m_cpuDDR = data;
-
-        if (address == 0x0001) m_cpuPORT = data;
-
-        u16 offset;
-        if (KERNAL_RANGE.contains(address, offset)) {
-            m_RAM[address] = data;
-            return;
-        }
-
-        if (CIA2_RANGE.contains(address, offset)) {
-            m_cia2.store8(offset, data);
-            return;
-        }
-
-        if (CIA1_RANGE.contains(address, offset)) {
-            m_cia1.store8(offset, data);
-            return;
-        }
-
-        if (SID_RANGE.contains(address, offset)) {
-            m_sid.store8(offset, data);
-            return;
-        }
-
-        if (VIC_RANGE.contains(address, offset)) {
-            m_vic.store8(offset, data);
-            return;
-        }
-
-        if (BASIC_RANGE.contains(address, offset)) {
-            m_RAM[address] = data;
-            return;
-        }
-
-        if (RAM_RANGE.contains(address, offset)) {
-            m_RAM[offset] = data;
-            return;
-        }
-
-        assert(false && "Unhandled memory write!");
+        if ((m_cpuPORT & 3) > 1)
+            m_bus.mapReadMemory(KERNAL_RANGE, m_KERNAL.getData());
+        else
+            m_bus.mapReadMemory(KERNAL_RANGE, m_RAM + KERNAL_RANGE.start);
     }
 
 } // namespace C64
@@ -1,33 +1,66 @@
 #pragma once
 #include "shared/source/devices/cpu6502/cpu6502.hpp"
+#include "shared/source/firmware.hpp"
+#include "shared/source/memory_bus.hpp"
 #include "cia.hpp"
 #include "sid.hpp"
 #include "vic_ii.hpp"
 
+#include <functional>
+#include <span>
+#include <vector>
+
 namespace C64 {
 
     constexpr u16 SCREEN_WIDTH = 320;
     constexpr u16 SCREEN_HEIGHT = 200;
 
+    // 6510 processor port at 0x0000 - 0x0001 is checked before the page table,
+    // so the rest of zero page stays plain memory.
+    class Bus :
+        public MemoryBus16
+    {
+    public:
+        using PortWriteCallback = std::function<void(u16, u8)>;
+        void mapPortWriteCallback(PortWriteCallback callback) { portWrite = callback; }
+
+        void write8(u16 address, u8 data)
+        {
+            MemoryBus16::write8(address, data);
+            if (address < 2) portWrite(address, data);
+        }
+    private:
+        PortWriteCallback portWrite = nullptr;
+    };
+
     class Emulator
     {
     public:
         Emulator();
 
         void clock();
+        u32 runCycles(u32 budget);
+        void setBreakpoints(Breakpoints* breakpoints) { m_cpu.setBreakpoints(breakpoints); m_bus.setBreakpoints(breakpoints); }
+        void setProfiler(PCProfiler* profiler) { m_cpu.setProfiler(profiler); }
+        void setCallProfiler(CallProfiler* profiler) { m_cpu.setCallProfiler(profiler); }
+
+        // ROMs are not part of the state. Machine has to be reset when loading fails.
+        void saveState(std::vector<u8>& state) const;
+        bool loadState(std::span<const u8> state);
     private:
-        u8 memoryRead(u16 address) const;
-        void memoryWrite(u16 address, u8 data);
+        void mapKERNAL();
+
+        Bus m_bus;
 
-        u8 m_KERNAL[0x2000];
-        u8 m_characters[0x1000];
+        Firmware m_KERNAL;
+        Firmware m_characters;
         u8 m_upperRAM[0x1000];
-        u8 m_BASIC[0x2000];
+        Firmware m_BASIC;
         u8 m_RAM[0x10000];
 
         u8 m_cpuDDR = 0;
         u8 m_cpuPORT = 7; // Simulate pull-up resistors on system initialization
-        CPU6502 m_cpu{};
+        CPU6502Core<Bus> m_cpu{ m_bus };
         CIA m_cia1{};
         CIA m_cia2{};
         SID m_sid{};
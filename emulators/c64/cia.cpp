@@ -1,4 +1,5 @@
 #include "cia.hpp"
+#include "shared/source/save_state.hpp"
 
 #include <cassert>
 
@@ -37,4 +38,28 @@ namespace C64 {
         assert(false);
     }
 
+    void CIA::saveState(StateWriter& writer) const
+    {
+        writer.write(m_PRA);
+        writer.write(m_DDRA);
+        writer.write(m_DDRB);
+        writer.write(m_TAL);
+        writer.write(m_TAH);
+        writer.write(m_ICR);
+        writer.write(m_CRA);
+        writer.write(m_CRB);
+    }
+
+    void CIA::loadState(StateReader& reader)
+    {
+        reader.read(m_PRA);
+        reader.read(m_DDRA);
+        reader.read(m_DDRB);
+        reader.read(m_TAL);
+        reader.read(m_TAH);
+        reader.read(m_ICR);
+        reader.read(m_CRA);
+        reader.read(m_CRB);
+    }
+
 } // namespace C64
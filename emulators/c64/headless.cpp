@@ -0,0 +1,34 @@
+#include "c64.hpp"
+
+#include "shared/source/headless_application.hpp"
+
+#include <memory>
+
+class C64Headless :
+    public HeadlessApplication
+{
+public:
+    explicit C64Headless(C64::Emulator& c64) :
+        HeadlessApplication{ {
+                .name = "c64",
+                .screenWidth = C64::SCREEN_WIDTH,
+                .screenHeight = C64::SCREEN_HEIGHT,
+                .cyclesPerFrame = 312 * 63,
+                .clockFrequency = 985248,
+                .needsROM = false
+        } },
+        m_c64{ c64 }
+    {}
+private:
+    void setCallProfiler(CallProfiler* profiler) override { m_c64.setCallProfiler(profiler); }
+    u32 runCycles(u32 budget) override { return m_c64.runCycles(budget); }
+
+    C64::Emulator& m_c64;
+};
+
+int main(int argc, char* argv[])
+{
+    std::unique_ptr<C64::Emulator> c64 = std::make_unique<C64::Emulator>();
+    C64Headless app{ *c64.get() };
+    return app.run(argc, argv);
+}
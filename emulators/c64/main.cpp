@@ -1,6 +1,7 @@
 #include "c64.hpp"
 
 #include "shared/source/application.hpp"
+#include "shared/source/frame_pacer.hpp"
 
 #include <thread>
 
@@ -19,18 +20,24 @@ public:
         } }
     {}
 private:
-    std::span<const unsigned int> getScreenPixels() const override { return {}; }
+    ScreenFrame acquireScreenFrame() override { return { {}, 0 }; }
 };
 
+static constexpr u32 CYCLES_PER_FRAME = 312 * 63; // PAL
+static constexpr double FRAMES_PER_SECOND = 985248.0 / CYCLES_PER_FRAME;
+
 int main()
 {
     C64App app;
     std::unique_ptr<C64::Emulator> c64 = std::make_unique<C64::Emulator>();
+    FramePacer pacer{ FRAMES_PER_SECOND };
 
     std::thread emuThread{
         [&]() {
+            pacer.reset();
             while (app.isRunning()) {
-                c64->clock();
+                c64->runCycles(CYCLES_PER_FRAME);
+                pacer.waitForNextFrame();
             }
         }
     };
@@ -1,4 +1,5 @@
 #include "sid.hpp"
+#include "shared/source/save_state.hpp"
 
 #include <cassert>
 
@@ -22,4 +23,14 @@ namespace C64 {
         assert(false);
     }
 
+    void SID::saveState(StateWriter& writer) const
+    {
+        writer.write(m_filter_mode_and_main_volume_control);
+    }
+
+    void SID::loadState(StateReader& reader)
+    {
+        reader.read(m_filter_mode_and_main_volume_control);
+    }
+
 } // namespace C64
@@ -1,6 +1,9 @@
 #pragma once
 #include "shared/source/types.hpp"
 
+class StateWriter;
+class StateReader;
+
 namespace C64 {
 
     class SID
@@ -10,6 +13,9 @@ namespace C64 {
 
         u8 load8(u16 address) const;
         void store8(u16 address, u8 data);
+
+        void saveState(StateWriter& writer) const;
+        void loadState(StateReader& reader);
     private:
         u8 m_filter_mode_and_main_volume_control;
     };
@@ -1,4 +1,5 @@
 #include "vic_ii.hpp"
+#include "shared/source/save_state.hpp"
 
 #include <cassert>
 
@@ -41,4 +42,46 @@ namespace C64 {
         assert(false);
     }
 
+    void VICII::saveState(StateWriter& writer) const
+    {
+        writer.write(m_control_register2);
+        writer.write(m_SpriteX_expansion);
+        writer.write(m_border_color);
+        writer.write(m_bg_color0);
+        writer.write(m_bg_color1);
+        writer.write(m_bg_color2);
+        writer.write(m_bg_color3);
+        writer.write(m_sprite_multicolor0);
+        writer.write(m_sprite_multicolor1);
+        writer.write(m_sprite0_color);
+        writer.write(m_sprite1_color);
+        writer.write(m_sprite2_color);
+        writer.write(m_sprite3_color);
+        writer.write(m_sprite4_color);
+        writer.write(m_sprite5_color);
+        writer.write(m_sprite6_color);
+        writer.write(m_sprite7_color);
+    }
+
+    void VICII::loadState(StateReader& reader)
+    {
+        reader.read(m_control_register2);
+        reader.read(m_SpriteX_expansion);
+        reader.read(m_border_color);
+        reader.read(m_bg_color0);
+        reader.read(m_bg_color1);
+        reader.read(m_bg_color2);
+        reader.read(m_bg_color3);
+        reader.read(m_sprite_multicolor0);
+        reader.read(m_sprite_multicolor1);
+        reader.read(m_sprite0_color);
+        reader.read(m_sprite1_color);
+        reader.read(m_sprite2_color);
+        reader.read(m_sprite3_color);
+        reader.read(m_sprite4_color);
+        reader.read(m_sprite5_color);
+        reader.read(m_sprite6_color);
+        reader.read(m_sprite7_color);
+    }
+
 } // namespace C64
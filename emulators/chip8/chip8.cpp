@@ -3,11 +3,15 @@
 #include "chip8_instruction.hpp"
 
 #include "shared/source/file_io.hpp"
+#include "shared/source/save_state.hpp"
 
 #include <cassert>
 #include <cstring>
 #include <iostream>
 
+static constexpr u32 STATE_ID = makeStateID("CHP8");
+static constexpr u32 STATE_VERSION = 1;
+
 void CHIP8::loadProgram(const char* filename)
 {
     const void* PROGRAM_START = m_memory + 0x200;
@@ -61,6 +65,56 @@ void CHIP8::reset()
     m_elspsedTime = 0.0;
 }
 
+void CHIP8::saveState(std::vector<u8>& state) const
+{
+    StateWriter writer{ state, STATE_ID, STATE_VERSION };
+    writer.writeBytes(m_memory, MEMORY_SIZE);
+    writer.write<u16>(I);
+    writer.write<u16>(PC);
+    writer.write<u8>(SP);
+    writer.write(DT);
+    writer.write(ST);
+    for (bool key : keys)
+        writer.write(key);
+    writer.write(m_elspsedTime);
+}
+
+bool CHIP8::loadState(std::span<const u8> state)
+{
+    StateReader reader{ state, STATE_ID, STATE_VERSION };
+    if (!reader.isValid())
+        return false;
+
+    u16 i, pc;
+    u8 sp;
+    reader.readBytes(m_memory, MEMORY_SIZE);
+    reader.read(i);
+    reader.read(pc);
+    reader.read(sp);
+    I = i;
+    PC = pc;
+    SP = sp;
+    reader.read(DT);
+    reader.read(ST);
+    for (bool& key : keys)
+        reader.read(key);
+    reader.read(m_elspsedTime);
+
+    renderScreen();
+
+    return reader.isValid() && reader.isAtEnd();
+}
+
+void CHIP8::renderScreen()
+{
+    u32* pixels = m_frames.getWriteBuffer().data();
+    for (u16 index = 0; index < CHIP8_WIDTH * CHIP8_HEIGHT / 8; index++)
+        for (u16 bit = 0; bit < 8; bit++)
+            *pixels++ = Screen[index] & (1 << (7 - bit)) ? 0xFFFFFFFF : 0;
+
+    m_frames.publish();
+}
+
 void CHIP8::update(double dt)
 {
     m_elspsedTime += dt;
@@ -82,7 +136,7 @@ void CHIP8::update(double dt)
         if (instruction.word == 0x00E0)
         {
             std::memset(Screen, 0, 8 * 32);
-            std::memset(m_screenPixels, 0, CHIP8_WIDTH * CHIP8_HEIGHT * sizeof(u32));
+            renderScreen();
         }
         else if (instruction.word == 0x00EE)
         {
@@ -186,18 +240,8 @@ void CHIP8::update(double dt)
             GPR[0xF] = (Screen[index] & m_memory[I + i] >> x_bit) | (Screen[index + 1] & m_memory[I + i] << (8 - x_bit));
             Screen[index] ^= m_memory[I + i] >> x_bit;
             Screen[index + 1] ^= m_memory[I + i] << (8 - x_bit);
-
-            for (u16 bit = 0; bit < 8; bit++)
-            {
-                bool on = Screen[index] & (1 << (7 - bit));
-                u16 x_coord = x_byte * 8 + bit;
-                u16 y_coord = y + i;
-                m_screenPixels[y_coord * CHIP8_WIDTH + x_coord] = on ? 0xFFFFFFFF : 0;
-                on = Screen[index + 1] & (1 << (7 - bit));
-                x_coord = (x_byte + 1) * 8 + bit;
-                m_screenPixels[y_coord * CHIP8_WIDTH + x_coord] = on ? 0xFFFFFFFF : 0;
-            }
         }
+        renderScreen();
     } break;
     case 0xE:
         if (instruction.h1 == 0x9E)
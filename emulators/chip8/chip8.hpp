@@ -1,5 +1,6 @@
 #pragma once
 #include "shared/source/disassembly_line.hpp"
+#include "shared/source/triple_buffer.hpp"
 #include "shared/source/types.hpp"
 
 #include <span>
@@ -17,12 +18,20 @@ public:
     void reset();
     void update(double dt);
 
+    // Program is part of the memory, so state can be loaded without loading it first.
+    void saveState(std::vector<u8>& state) const;
+    bool loadState(std::span<const u8> state);
+
     void handleKey(int key, int action);
-    std::span<const u32> getScreenPixels() const { return { m_screenPixels, CHIP8_WIDTH * CHIP8_HEIGHT }; }
+    // Screen is published after every change, these can be called from other thread.
+    std::span<const u32> acquireScreenPixels() { return m_frames.acquire(); }
+    u64 getScreenSequence() const { return m_frames.getSequence(); }
     const std::vector<DisassemblyLine>& getDisassembly() const { return m_disassembly; }
 private:
     static constexpr size_t MEMORY_SIZE = 0x1000;
 
+    void renderScreen();
+
     u8 m_memory[MEMORY_SIZE];
     u8* Stack = m_memory + 0xEA0;
     u8* GPR = m_memory + 0xEF0;
@@ -36,5 +45,5 @@ private:
     double m_elspsedTime;
 
     std::vector<DisassemblyLine> m_disassembly;
-    u32 m_screenPixels[CHIP8_WIDTH * CHIP8_HEIGHT] ;
+    TripleBuffer<std::vector<u32>> m_frames{ std::vector<u32>(CHIP8_WIDTH * CHIP8_HEIGHT, 0) };
 };
@@ -1,6 +1,7 @@
 #include "chip8.hpp"
 
 #include "shared/source/application.hpp"
+#include "shared/source/frame_pacer.hpp"
 
 #include <thread>
 
@@ -20,7 +21,10 @@ public:
         m_chip8{ chip8 }
     {}
 private:
-    std::span<const unsigned int> getScreenPixels() const override { return m_chip8.getScreenPixels(); }
+    ScreenFrame acquireScreenFrame() override {
+        auto pixels = m_chip8.acquireScreenPixels();
+        return { pixels, m_chip8.getScreenSequence() };
+    }
 
     void onKeyCallback(int key, int action, int /*mods*/) override {
         m_chip8.handleKey(key, action);
@@ -29,9 +33,13 @@ private:
     CHIP8& m_chip8;
 };
 
+static constexpr u32 INSTRUCTIONS_PER_FRAME = 10;
+static constexpr double FRAME_TIME_MS = 1000.0 / 60.0;
+
 int main()
 {
     CHIP8 chip8;
+    FramePacer pacer{ 60.0 };
     CHIP8App app{ chip8 };
 
     //chip8.loadProgram("C:/Users/kmisiak/myplace/retro-extras/programs/chip8/Space Invaders [David Winter].ch8");
@@ -39,17 +47,11 @@ int main()
 
     std::thread emuThread{
         [&]() {
-            std::chrono::steady_clock::time_point lastFrameTime;
-            std::chrono::duration<double, std::micro> elapsedTime{ 0 };
+            pacer.reset();
             while (app.isRunning()) {
-                auto time = std::chrono::steady_clock::now();
-                std::chrono::duration<double, std::micro> dt = time - lastFrameTime;
-                elapsedTime += dt;
-                lastFrameTime = time;
-
-                chip8.update(dt.count() * 0.000001);
-
-                std::this_thread::sleep_for(std::chrono::nanoseconds{ 64 });
+                for (u32 i = 0; i < INSTRUCTIONS_PER_FRAME; i++)
+                    chip8.update(FRAME_TIME_MS / INSTRUCTIONS_PER_FRAME);
+                pacer.waitForNextFrame();
             }
         }
     };
@@ -1,5 +1,5 @@
 #pragma once
-#include "shared/source/types.hpp"
+#include "shared/source/save_state.hpp"
 
 class APU
 {
@@ -37,6 +37,9 @@ public:
     {
         return m_buffer[address];
     }
+
+    void saveState(StateWriter& writer) const { writer.writeBytes(m_buffer, sizeof(m_buffer)); }
+    void loadState(StateReader& reader) { reader.readBytes(m_buffer, sizeof(m_buffer)); }
 private:
     u8 m_buffer[0x17];
 };
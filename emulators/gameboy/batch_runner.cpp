@@ -0,0 +1,53 @@
+#include "batch_runner.hpp"
+#include "gameboy.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static void runJob(BatchJob& job)
+{
+    // Fresh machine per job, nothing can leak from the previous cartridge.
+    auto gameboy = std::make_unique<Gameboy>();
+    gameboy->mapSerialOutputCallback([&job](u8 data) { job.serialOutput += (char)data; });
+
+    // Jobs running the same ROM in parallel must not share a save file.
+    job.isLoaded = gameboy->loadCartridge(job.romPath.c_str(), true, Cartridge::RAMMode::Volatile);
+    if (!job.isLoaded)
+        return;
+
+    gameboy->reset();
+    while (job.cyclesRun < job.cycles) {
+        u32 budget = (u32)std::min<u64>(job.cycles - job.cyclesRun, 1 << 16);
+        u32 cyclesRun = gameboy->runCycles(budget);
+        if (cyclesRun == 0) break;
+
+        job.cyclesRun += cyclesRun;
+    }
+
+    const auto& state = gameboy->getCPU().getState();
+    job.hasMooneyePassed = state.BC == 0x0305 && state.DE == 0x080D && state.HL == 0x1522;
+}
+
+void runBatch(std::span<BatchJob> jobs, unsigned int threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    threadCount = std::min<unsigned int>(threadCount, (unsigned int)jobs.size());
+
+    std::atomic<size_t> nextJob = 0;
+    auto worker = [&]() {
+        for (size_t i = nextJob.fetch_add(1, std::memory_order_relaxed); i < jobs.size();
+             i = nextJob.fetch_add(1, std::memory_order_relaxed))
+            runJob(jobs[i]);
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++)
+        workers.emplace_back(worker);
+    for (std::thread& thread : workers)
+        thread.join();
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "shared/source/types.hpp"
+
+#include <span>
+#include <string>
+
+// Runs many cartridges in one process, each on its own Gameboy instance.
+// Jobs are handed out to a pool of worker threads, so a ROM corpus runs on all host cores.
+struct BatchJob
+{
+    std::string romPath;
+    u64 cycles = 0;
+
+    // results:
+    bool isLoaded = false;
+    u64 cyclesRun = 0;
+    std::string serialOutput;
+    bool hasMooneyePassed = false; // registers hold Fibonacci numbers after the test's LD B,B
+};
+
+// threadCount == 0 starts one worker per hardware thread.
+void runBatch(std::span<BatchJob> jobs, unsigned int threadCount = 0);
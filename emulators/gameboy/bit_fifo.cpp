@@ -1,4 +1,5 @@
 #include "bit_fifo.hpp"
+#include "shared/source/save_state.hpp"
 
 bool BitFIFO::push(u8 byteL, u8 byteH)
 {
@@ -29,3 +30,17 @@ void BitFIFO::clear()
 	m_bufferH = 0;
 	m_size = 0;
 }
+
+void BitFIFO::saveState(StateWriter& writer) const
+{
+	writer.write(m_bufferH);
+	writer.write(m_bufferL);
+	writer.write(m_size);
+}
+
+void BitFIFO::loadState(StateReader& reader)
+{
+	reader.read(m_bufferH);
+	reader.read(m_bufferL);
+	reader.read(m_size);
+}
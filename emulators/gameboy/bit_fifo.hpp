@@ -1,6 +1,9 @@
 #pragma once
 #include "shared/source/types.hpp"
 
+class StateWriter;
+class StateReader;
+
 class BitFIFO
 {
 public:
@@ -9,6 +12,9 @@ public:
 	bool push(u8 byteL, u8 byteH);
 	u8 pop();
 	void clear();
+
+	void saveState(StateWriter& writer) const;
+	void loadState(StateReader& reader);
 private:
 	u16 m_bufferH = 0;
 	u16 m_bufferL = 0;
@@ -1,11 +1,12 @@
 #include "cartridge.hpp"
 
-#include "shared/source/file_io.hpp"
+#include "shared/source/save_state.hpp"
 
 #include <cassert>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <string>
 
 static const char* CartridgeTypeCodeToStr(u8 code) {
     switch (code) {
@@ -68,22 +69,29 @@ static size_t ROMSizeCodeToKB(u8 code) {
     return 0xDEADBEEF;
 }
 
-static u8 ROMSizeCodeToBankMask(u8 code) {
+static bool hasBattery(u8 code) {
     switch (code) {
-    case 0x00: return 0b1;
-    case 0x01: return 0b11;
-    case 0x02: return 0b111;
-    case 0x03: return 0b1111;
-    case 0x04: return 0b11111;
+    case 0x03:
+    case 0x06:
+    case 0x09:
+    case 0x0D:
+    case 0x0F:
+    case 0x10:
+    case 0x13:
+    case 0x1B:
+    case 0x1E:
+    case 0x22:
+    case 0xFF:
+        return true;
     }
 
-    assert(false && "Unhandled code");
-    return 0xDE;
+    return false;
 }
 
 static size_t RAMSizeCodeToKB(u8 code) {
     switch (code) {
     case 0x00: return 0;
+    case 0x01: return 2;
     case 0x02: return 8;
     case 0x03: return 32;
     case 0x04: return 128;
@@ -94,97 +102,77 @@ static size_t RAMSizeCodeToKB(u8 code) {
     return 0xDEADBEEF;
 }
 
-Cartridge::~Cartridge()
+void Cartridge::store8(u16 address, u8 data)
 {
-    delete[] m_data;
-    delete[] m_RAM;
+    if (!m_MBC) return;
+
+    MBC::Banks banks = m_banks;
+    m_MBC->store8(address, data);
+    if (banksChanged && (banks.ROM0 != m_banks.ROM0 || banks.ROMN != m_banks.ROMN ||
+                         banks.RAM != m_banks.RAM || banks.RAMMask != m_banks.RAMMask))
+        banksChanged();
 }
 
-u8 Cartridge::load8(u16 address) const
+u8 Cartridge::load8ExtRAM(u16 address) const
 {
-    switch (m_header->cartridgeTypeCode)
-    {
-    case 0:
-        if (address < 0x8000)
-            return m_data[address];
-        break;
-    case 1:
-    case 2:
-    case 3:
-        if (address < 0x4000)
-            return m_data[address];
-
-        if (address < 0x8000) {
-            u8 bankNumber = m_MBC1ROMBank ? m_MBC1ROMBank : 1;
-            bankNumber &= ROMSizeCodeToBankMask(m_header->ROMSizeCode);
-            return m_data[bankNumber * 0x4000 + (address - 0x4000)];
-        }
-        break;
-    }
-    
-    assert(false);
-    return 0;
+    if (m_banks.RAM)
+        return m_banks.RAM[address & m_banks.RAMMask];
+
+    return m_MBC ? m_MBC->load8ExtRAM(address) : 0xFF;
 }
 
-void Cartridge::store8(u16 address, u8 data)
+void Cartridge::store8ExtRAM(u16 address, u8 data)
 {
-    switch (m_header->cartridgeTypeCode)
-    {
-    case 1:
-    case 2:
-    case 3:
-        if (address >= 0x0000 && address < 0x2000) {
-            m_MBC1RAMEnable = data & 0xF;
-            return;
-        }
-        if (address >= 0x2000 && address < 0x4000) {
-            m_MBC1ROMBank = (data & 0x1F) ? (data & 0x1F) : 1;
-            return;
-        }
-    }
-    
-    std::cerr << "Unexpected write to cartridge - " << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << address;
-    std::cerr << ':' << std::hex << std::setw(2) << (u16)data << '\n';
+    if (m_banks.RAM)
+        m_banks.RAM[address & m_banks.RAMMask] = data;
+    else if (m_MBC)
+        m_MBC->store8ExtRAM(address, data);
 }
 
-u8 Cartridge::load8ExtRAM(u16 address) const
+void Cartridge::saveState(StateWriter& writer) const
 {
-    if (m_MBC1RAMEnable == 0xA)
-    {
-        m_RAM[address];
-    }
-
-    return 0xFF;
+    if (m_MBC)
+        m_MBC->saveState(writer);
+    writer.write((u32)m_RAMSize);
+    if (m_RAM)
+        writer.writeBytes(m_RAM, m_RAMSize);
 }
 
-void Cartridge::store8ExtRAM(u16 address, u8 data)
+void Cartridge::loadState(StateReader& reader)
 {
-    if (m_MBC1RAMEnable == 0xA)
-    {
-        m_RAM[address] = data;
+    if (m_MBC)
+        m_MBC->loadState(reader);
+    u32 RAMSize;
+    reader.read(RAMSize);
+    if (RAMSize != m_RAMSize) {
+        reader.invalidate();
+        return;
     }
+    if (m_RAM)
+        reader.readBytes(m_RAM, m_RAMSize);
 }
 
-bool Cartridge::loadFromFile(const char* filename, bool quiet)
+bool Cartridge::loadFromFile(const char* filename, bool quiet, RAMMode mode)
 {
-    if (!readFile(filename, nullptr, m_size, true)) {
-        std::cerr << "Failed to read size of cartridge ROM file: " << filename << '\n';
+    m_header = nullptr;
+    m_data = nullptr;
+    m_size = 0;
+    m_MBC.reset();
+    m_banks = {};
+    if (!m_ROM.open(filename, MappedFile::Mode::ReadOnly)) {
+        std::cerr << "Failed to read cartridge ROM file: " << filename << '\n';
         return false;
     }
 
-    if (m_size < 0x8000) {
+    if (m_ROM.getSize() < 0x8000) {
         std::cerr << "Size of cartridge ROM is less than 32KB!\n";
+        m_ROM.close();
         return false;
     }
 
-    delete[] m_data;
-    m_data = new uint8_t[m_size];
-    if (!readFile(filename, (char*)m_data, m_size, true)) {
-        std::cerr << "Failed to read cartridge ROM file: " << filename << '\n';
-        return false;
-    }
-
-    m_header = (Header*)(m_data + 0x100);
+    m_data = m_ROM.getData();
+    m_size = m_ROM.getSize();
+    m_header = (const Header*)(m_data + 0x100);
 
     u16 x = 0;
     for (u16 i = 0x0134; i <= 0x014C; i++)
@@ -199,6 +187,13 @@ bool Cartridge::loadFromFile(const char* filename, bool quiet)
     if (ROMSizeCodeToKB(m_header->ROMSizeCode) * 1024 != m_size)
         std::cerr << "WARNING: Header ROM size is different than file size read!\n";
 
+    if (!MBC::isSupported(m_header->cartridgeTypeCode)) {
+        std::cerr << "Unsupported cartridge type: " << std::hex << std::uppercase << std::setw(2) << std::setfill('0')
+                  << (u16)m_header->cartridgeTypeCode << std::dec << '\n';
+        m_ROM.close();
+        return false;
+    }
+
     if (!quiet) {
         std::cout << "Loaded cartridge ROM file: " << filename << '\n'
                   << "Size loaded: " << m_size / 1024 << "KB\n"
@@ -209,10 +204,30 @@ bool Cartridge::loadFromFile(const char* filename, bool quiet)
                   << "  RAM size: " << RAMSizeCodeToKB(m_header->RAMSizeCode) << "KB\n";
     }
 
-    delete[] m_RAM;
+    m_batteryRAM.close();
+    m_volatileRAM.reset();
     m_RAM = nullptr;
-    if (m_header->RAMSizeCode)
-        m_RAM = new u8[RAMSizeCodeToKB(m_header->RAMSizeCode) * 0x400];
+    m_RAMSize = MBC::getRAMSize(m_header->cartridgeTypeCode, RAMSizeCodeToKB(m_header->RAMSizeCode) * 0x400);
+    if (m_RAMSize) {
+        if (mode == RAMMode::Battery && hasBattery(m_header->cartridgeTypeCode)) {
+            std::string saveFilename = filename;
+            size_t extension = saveFilename.find_last_of('.');
+            if (extension != std::string::npos && saveFilename.find_first_of("/\\", extension) == std::string::npos)
+                saveFilename.resize(extension);
+            saveFilename += ".sav";
+
+            if (m_batteryRAM.open(saveFilename.c_str(), MappedFile::Mode::ReadWrite, m_RAMSize))
+                m_RAM = m_batteryRAM.getData();
+            else
+                std::cerr << "WARNING: Failed to map save file, RAM won't persist: " << saveFilename << '\n';
+        }
+
+        if (!m_RAM) {
+            m_volatileRAM = std::make_unique<u8[]>(m_RAMSize);
+            m_RAM = m_volatileRAM.get();
+        }
+    }
 
+    m_MBC = MBC::create(m_header->cartridgeTypeCode, { m_data, m_size }, { m_RAM, m_RAMSize }, m_banks);
     return true;
 }
@@ -1,17 +1,39 @@
 #pragma once
+#include "mbc.hpp"
+#include "shared/source/mapped_file.hpp"
 #include "shared/source/types.hpp"
 
+#include <functional>
+#include <memory>
+
+class StateWriter;
+class StateReader;
+
 class Cartridge
 {
 public:
-    ~Cartridge();
+    enum class RAMMode {
+        Battery, // battery backed RAM persists in a .sav file
+        Volatile // RAM is always fresh and never written to disk
+    };
 
-    u8 load8(u16 address) const;
     void store8(u16 address, u8 data);
     u8 load8ExtRAM(u16 address) const;
     void store8ExtRAM(u16 address, u8 data);
 
-    bool loadFromFile(const char* filename, bool quiet = false);
+    // ROM and plain RAM are accessed through bank pointers mapped directly into the memory bus.
+    const MBC::Banks& getBanks() const { return m_banks; }
+    // Called after a write to a bank register changed any of the banks.
+    using BanksChangedCallback = std::function<void()>;
+    void mapBanksChangedCallback(BanksChangedCallback callback) { banksChanged = callback; }
+
+    // ROM is mapped, not copied. Battery backed RAM is mapped from a .sav file next to the ROM,
+    // so it persists without explicit saving. Fails for unsupported memory bank controllers.
+    bool loadFromFile(const char* filename, bool quiet = false, RAMMode mode = RAMMode::Battery);
+
+    // ROM is not saved, state can only be loaded with the same cartridge inserted.
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
 
     Cartridge() = default;
     Cartridge(const Cartridge&) = delete;
@@ -35,11 +57,15 @@ private:
     };
     static_assert(sizeof(Header) == 0x50);
 
-    Header* m_header = nullptr;
-    u8* m_data = nullptr;
+    MappedFile m_ROM;
+    const Header* m_header = nullptr;
+    const u8* m_data = nullptr;
     size_t m_size = 0;
-    u8 m_MBC1RAMEnable = 0;
-    u8 m_MBC1ROMBank = 0;
-    u8 m_MBC1RAMBank = 0;
-    u8* m_RAM = nullptr;
+    MappedFile m_batteryRAM;
+    std::unique_ptr<u8[]> m_volatileRAM;
+    u8* m_RAM = nullptr; // points into one of the above
+    size_t m_RAMSize = 0;
+    std::unique_ptr<MBC> m_MBC;
+    MBC::Banks m_banks; // resolved by m_MBC whenever a bank register changes
+    BanksChangedCallback banksChanged = nullptr;
 };
@@ -1,4 +1,6 @@
 #include "cpu.hpp"
+#include "shared/source/call_profiler.hpp"
+#include "shared/source/save_state.hpp"
 
 #include <bitset>
 #include <cassert>
@@ -104,27 +106,90 @@ void CPU::clock()
     }
 
     if (m_cyclesLeft == 0)
-    {
-        if (!m_prefixMode) {
-            if (m_interruptRequested) {
-                m_interruptRequested = false;
-                RST(m_interruptVector);
-            }
+        executeNextInstruction();
+}
+
+u32 CPU::runInstruction()
+{
+    // Finish instruction started with clock() if there is one.
+    if (m_cyclesLeft > 1) {
+        u32 cycles = m_cyclesLeft - 1u;
+        m_cyclesLeft = 1;
+        return cycles;
+    }
+
+    m_cyclesLeft = 0;
+
+    if (m_EIRequested) {
+        m_EIRequested = false;
+        m_state.InterruptEnabled = true;
+    }
+
+    executeNextInstruction();
+
+    // Halted CPU idles one cycle at a time.
+    u32 cycles = m_cyclesLeft > 0 ? m_cyclesLeft : 1u;
+    m_cyclesLeft = 1;
+    return cycles;
+}
+
+void CPU::saveState(StateWriter& writer) const
+{
+    writer.write(m_state.PC);
+    writer.write(m_state.SP);
+    writer.write(m_state.AF);
+    writer.write(m_state.BC);
+    writer.write(m_state.DE);
+    writer.write(m_state.HL);
+    writer.write(m_state.InterruptEnabled);
+    writer.write(m_state.IsHalted);
+    writer.write(m_interruptVector);
+    writer.write(m_interruptRequested);
+    writer.write(m_prefixMode);
+    writer.write(m_conditionalTaken);
+    writer.write(m_EIRequested);
+    writer.write(m_cyclesLeft);
+}
+
+void CPU::loadState(StateReader& reader)
+{
+    reader.read(m_state.PC);
+    reader.read(m_state.SP);
+    reader.read(m_state.AF);
+    reader.read(m_state.BC);
+    reader.read(m_state.DE);
+    reader.read(m_state.HL);
+    reader.read(m_state.InterruptEnabled);
+    reader.read(m_state.IsHalted);
+    reader.read(m_interruptVector);
+    reader.read(m_interruptRequested);
+    reader.read(m_prefixMode);
+    reader.read(m_conditionalTaken);
+    reader.read(m_EIRequested);
+    reader.read(m_cyclesLeft);
+}
+
+void CPU::executeNextInstruction()
+{
+    if (!m_prefixMode) {
+        if (m_interruptRequested) {
+            m_interruptRequested = false;
+            RST(m_interruptVector);
         }
+    }
+
+    if (!m_state.IsHalted) {
+        u8 opcode = load8(m_state.PC++);
 
-        if (!m_state.IsHalted) {
-            u8 opcode = load8(m_state.PC++);
-
-            if (m_prefixMode) {
-                m_prefixMode = false;
-                prefixInstruction(opcode);
-                m_cyclesLeft += prefixCycleCounts[opcode];
-            }
-            else {
-                standardInstruction(opcode);
-                m_cyclesLeft += m_conditionalTaken ? conditionalCycleCounts[opcode] : standardCycleCounts[opcode];
-                m_conditionalTaken = false;
-            }
+        if (m_prefixMode) {
+            m_prefixMode = false;
+            prefixInstruction(opcode);
+            m_cyclesLeft += prefixCycleCounts[opcode];
+        }
+        else {
+            standardInstruction(opcode);
+            m_cyclesLeft += m_conditionalTaken ? conditionalCycleCounts[opcode] : standardCycleCounts[opcode];
+            m_conditionalTaken = false;
         }
     }
 }
@@ -801,6 +866,7 @@ void CPU::CALL(bool flag)
         m_conditionalTaken = true;
         push16(m_state.PC);
         m_state.PC = address;
+        if (m_callProfiler) m_callProfiler->call(m_state.PC);
     }
 }
 
@@ -809,6 +875,7 @@ void CPU::RET(bool flag)
     if (flag) {
         m_conditionalTaken = true;
         m_state.PC = pop16();
+        if (m_callProfiler) m_callProfiler->ret();
     }
 }
 
@@ -816,6 +883,7 @@ void CPU::RST(u8 vector)
 {
     push16(m_state.PC);
     m_state.PC = vector * 8;
+    if (m_callProfiler) m_callProfiler->call(m_state.PC);
 }
 
 void CPU::ADD(u8 value)
@@ -3,6 +3,10 @@
 
 #include <functional>
 
+class CallProfiler;
+class StateWriter;
+class StateReader;
+
 class CPU
 {
 public:
@@ -60,6 +64,7 @@ public:
     void reset();
     bool interrupt(u8 vector);
     void clock();
+    u32 runInstruction();
 
     // TODO(Kostu): make state non const to remove setters
     const State& getState() const { return m_state; }
@@ -82,6 +87,11 @@ public:
     void setPC(u16 value) { m_state.PC = value; }
     u8 getCyclesLeft() const { return m_cyclesLeft; }
     bool isHandlingInterrupt() const { return m_interruptRequested; }
+    // Reports CALL, RET, RST and interrupts, nullptr stops reporting.
+    void setCallProfiler(CallProfiler* profiler) { m_callProfiler = profiler; }
+
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
     
     CPU() = default;
     CPU(const CPU&) = delete;
@@ -96,6 +106,7 @@ private:
     u8 pop8() { return load8(m_state.SP++); }
     u16 pop16() { m_state.SP += 2; return load16(m_state.SP - 2); }
 
+    void executeNextInstruction();
     void standardInstruction(u8 opcode);
     void prefixInstruction(u8 opcode);
 
@@ -156,4 +167,5 @@ private:
     bool m_conditionalTaken;
     bool m_EIRequested;
     u8 m_cyclesLeft;
+    CallProfiler* m_callProfiler = nullptr;
 };
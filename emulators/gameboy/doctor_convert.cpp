@@ -0,0 +1,29 @@
+#include "gb_doctor.hpp"
+
+#include <fstream>
+#include <iostream>
+
+// Converts binary trace written by gameboy_headless --trace into Gameboy Doctor text log.
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3) {
+        std::cerr << "usage: gameboy_doctor_convert trace.gbdt [output.log]\n";
+        return 1;
+    }
+
+    std::ofstream file;
+    if (argc == 3) {
+        file.open(argv[2]);
+        if (!file.is_open()) {
+            std::cerr << "Could not open " << argv[2] << '\n';
+            return 1;
+        }
+    }
+
+    if (!convertGBDoctorTrace(argv[1], argc == 3 ? file : std::cout)) {
+        std::cerr << "Could not read " << argv[1] << '\n';
+        return 1;
+    }
+
+    return 0;
+}
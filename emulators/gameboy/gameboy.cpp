@@ -1,16 +1,25 @@
 #include "gameboy.hpp"
 #include "gb_doctor.hpp"
 #include "shared/source/address_range.hpp"
+#include "shared/source/instrumentation.hpp"
+#include "shared/source/save_state.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <iomanip>
 
 static const AddressRange16 ROM_RANGE{       0x0000, 0x7FFF };
+static const AddressRange16 BOOTLOADER_RANGE{0x0000, 0x00FF };
+static const AddressRange16 ROM0_RANGE{      0x0000, 0x3FFF };
+static const AddressRange16 ROMN_RANGE{      0x4000, 0x7FFF };
 static const AddressRange16 VRAM_RANGE{      0x8000, 0x9FFF };
 static const AddressRange16 EXTRAM_RANGE{    0xA000, 0xBFFF };
 static const AddressRange16 WRAM_RANGE{      0xC000, 0xDFFF };
+static const AddressRange16 ECHO_RAM_RANGE{  0xE000, 0xFDFF };
 static const AddressRange16 OAM_RANGE{       0xFE00, 0xFE9F };
+static const AddressRange16 IO_PAGES_RANGE{  0xFE00, 0xFEFF };
+static const AddressRange16 HIGH_PAGE_RANGE{ 0xFF00, 0xFFFF };
 static const AddressRange16 UNUSED1_RANGE{   0xFEA0, 0xFEFF };
 static const AddressRange16 SERIAL_RANGE{    0xFF01, 0xFF02 };
 static const AddressRange16 TIMER_RANGE{     0xFF04, 0xFF07 };
@@ -20,16 +29,43 @@ static const AddressRange16 PPU_RANGE{       0xFF40, 0xFF4B };
 static const AddressRange16 UNUSED3_RANGE{   0xFF7F, 0xFF7F };
 static const AddressRange16 HRAM_RANGE{      0xFF80, 0xFFFE };
 
+static constexpr u32 STATE_ID = makeStateID("DMG ");
+static constexpr u32 STATE_VERSION = 5;
+
 Gameboy::Gameboy() :
-    m_PPU{ m_interruptFlags },
+    m_PPU{ m_interruptFlags, m_scheduler },
     m_WRAM{ new u8[0x2000] },
-    m_timer{ m_interruptFlags },
+    m_timer{ m_interruptFlags, m_scheduler },
     m_hasCartridge{ false }
 {
-    m_CPU.mapReadMemoryCallback([this](u16 address) { return memoryRead(address); });
-    m_CPU.mapWriteMemoryCallback([this](u16 address, u8 data) { memoryWrite(address, data); });
+    m_bus.mapWriteCallback(ROM_RANGE, [this](u16 address, u8 data) { m_cartridge.store8(address, data); });
+    m_bus.mapReadMemory(VRAM_RANGE, m_PPU.getVRAM());
+    m_bus.mapWriteCallback(VRAM_RANGE, [this](u16 address, u8 data) { m_PPU.storeVRAM8(address - VRAM_RANGE.start, data); });
+    m_extRAMReadCallback = m_bus.addReadCallback([this](u16 address) { return m_cartridge.load8ExtRAM(address - EXTRAM_RANGE.start); });
+    m_extRAMWriteCallback = m_bus.addWriteCallback([this](u16 address, u8 data) { m_cartridge.store8ExtRAM(address - EXTRAM_RANGE.start, data); });
+    m_bus.mapMemory(WRAM_RANGE, m_WRAM);
+    m_bus.mapMemory(ECHO_RAM_RANGE, m_WRAM, 0x1FFF);
+    m_bus.mapReadCallback(IO_PAGES_RANGE, [this](u16 address) { return loadIO8(address); });
+    m_bus.mapWriteCallback(IO_PAGES_RANGE, [this](u16 address, u8 data) { storeIO8(address, data); });
+    // HRAM shares its page with IO registers, it is tested first as most accesses go there.
+    m_bus.mapReadCallback(HIGH_PAGE_RANGE, [this](u16 address) {
+        u16 offset;
+        if (HRAM_RANGE.contains(address, offset)) return m_HRAM[offset];
+        return loadIO8(address);
+    });
+    m_bus.mapWriteCallback(HIGH_PAGE_RANGE, [this](u16 address, u8 data) {
+        u16 offset;
+        if (HRAM_RANGE.contains(address, offset)) m_HRAM[offset] = data;
+        else storeIO8(address, data);
+    });
+    m_cartridge.mapBanksChangedCallback([this]() { mapCartridge(); });
+    std::memset(m_openBus, 0xFF, sizeof(m_openBus));
+
+    m_CPU.mapReadMemoryCallback([this](u16 address) { return m_bus.read8(address); });
+    m_CPU.mapWriteMemoryCallback([this](u16 address, u8 data) { m_bus.write8(address, data); });
 
-    m_PPU.mapReadExternalMemoryCallback([this](u16 address) { return memoryRead(address); });
+    m_PPU.mapReadExternalMemoryCallback([this](u16 address) { return m_bus.read8(address); });
+    m_PPU.mapExternalMemoryPointerCallback([this](u16 address) { return m_bus.getReadPointer(address); });
 
     //std::ifstream file{ "DMG_ROM.bin", std::ios_base::binary };
     //assert(file.is_open() && "Cannot open bootloader file");
@@ -37,13 +73,10 @@ Gameboy::Gameboy() :
     //file.close();
 
     reset();
-    initGBDoctor();
 }
 
 Gameboy::~Gameboy()
 {
-    shutdownGBDoctor();
-
     delete[] m_WRAM;
 }
 
@@ -51,6 +84,7 @@ void Gameboy::reset()
 {
     std::memset(m_WRAM, 0, 0x2000);
     m_PPU.clearVRAM();
+    m_scheduler.reset();
 
     m_CPU.reset();
     m_CPU.setAF(0x01B0);
@@ -74,45 +108,218 @@ void Gameboy::reset()
     m_serialBufferSize = 0;
 
     m_isRunning = true;
+    mapCartridge();
 }
 
 void Gameboy::update()
 {
     if (m_hasCartridge && m_isRunning) {
-        updateGBDoctor(m_unmapBootloader & 1, m_CPU.getCyclesLeft() == 1, m_CPU.getState(), [this](u16 address) { return memoryRead(address); });
-        m_timer.clock();
-        m_PPU.clock();
+        if (m_trace && m_CPU.getCyclesLeft() == 1)
+            traceInstruction();
+        tick();
         m_CPU.clock();
-        if (!m_CPU.isHandlingInterrupt()) {
-            if ((m_interruptEnables & 1) & (m_interruptFlags & 1)) { // V-Blank
-                if (m_CPU.interrupt(8))
-                    m_interruptFlags &= ~0x1;
-            }
-            else if ((m_interruptEnables & 2) & (m_interruptFlags & 2)) { // LCD STAT
-                if (m_CPU.interrupt(9))
-                    m_interruptFlags &= ~0x2;
-            }
-            else if ((m_interruptEnables & 4) & (m_interruptFlags & 4)) { // Timer
-                if (m_CPU.interrupt(10))
-                    m_interruptFlags &= ~0x4;
-            }
-            else if ((m_interruptEnables & 8) & (m_interruptFlags & 8)) { // Serial
-                if (m_CPU.interrupt(11))
-                    m_interruptFlags &= ~0x8;
-            }
-            else if ((m_interruptEnables & 0x10) & (m_interruptFlags & 0x10)) { // Joypad
-                if (m_CPU.interrupt(12))
-                    m_interruptFlags &= ~0x10;
-            }
+        handleInterrupts();
+    }
+}
+
+u32 Gameboy::runCycles(u32 budget)
+{
+    m_bus.syncWatchpoints();
+    if ((m_breakpoints && m_breakpoints->isArmed()) || (m_profiler && m_profiler->isEnabled()) ||
+        (m_callProfiler && m_callProfiler->isEnabled()))
+        return runCyclesInstrumented(budget);
+
+    u32 cycles = 0;
+    while (cycles < budget && m_hasCartridge && m_isRunning)
+        cycles += runInstruction();
+
+    return cycles;
+}
+
+u32 Gameboy::runCyclesInstrumented(u32 budget)
+{
+    Instrumentation instrumentation{ m_breakpoints, m_profiler, m_callProfiler };
+    m_CPU.setCallProfiler(instrumentation.callProfiler);
+    u32 cycles = instrumentation.run(budget,
+        [this]() -> u32 { return m_CPU.getState().PC; },
+        [this]() { return m_CPU.getCyclesLeft() <= 1; },
+        [this]() { return runInstruction(); });
+    m_CPU.setCallProfiler(nullptr);
+    return cycles;
+}
+
+u32 Gameboy::runInstruction()
+{
+    if (!m_hasCartridge || !m_isRunning)
+        return 0;
+
+    if (m_trace && m_CPU.getCyclesLeft() == 1)
+        traceInstruction();
+
+    // Instruction executes on its first cycle, devices catch up for the rest of it.
+    tick();
+    u32 cycles = m_CPU.runInstruction();
+    handleInterrupts();
+
+    // Interrupt flags can only change on scheduled events or while PPU is clocked,
+    // so idle stretches are skipped up to the next event.
+    u32 cyclesLeft = cycles - 1;
+    while (cyclesLeft > 0) {
+        u32 step = 1;
+        if (m_PPU.isClockNeeded())
+            tick();
+        else {
+            step = (u32)std::min<u64>(cyclesLeft, m_scheduler.getCyclesUntilNextEvent());
+            m_scheduler.advance(step);
+        }
+
+        handleInterrupts();
+        cyclesLeft -= step;
+    }
+
+    return cycles;
+}
+
+void Gameboy::traceInstruction()
+{
+    // Gameboy Doctor logs start after boot ROM.
+    if ((m_unmapBootloader & 1) == 0)
+        return;
+
+    const CPU::State& state = m_CPU.getState();
+    GBDoctorTrace::Record record;
+    record.cycle = m_scheduler.getNow();
+    record.A = state.A;
+    record.F = state.F.byte;
+    record.B = state.B;
+    record.C = state.C;
+    record.D = state.D;
+    record.E = state.E;
+    record.H = state.H;
+    record.L = state.L;
+    record.SP = state.SP;
+    record.PC = state.PC;
+    for (u16 i = 0; i < 4; i++)
+        record.PCMEM[i] = memoryRead(state.PC + i);
+
+    m_trace->record(record);
+}
+
+void Gameboy::tick()
+{
+    if (m_PPU.isClockNeeded())
+        m_PPU.clock();
+
+    m_scheduler.advance(1);
+}
+
+void Gameboy::handleInterrupts()
+{
+    if (!m_CPU.isHandlingInterrupt()) {
+        if ((m_interruptEnables & 1) & (m_interruptFlags & 1)) { // V-Blank
+            if (m_CPU.interrupt(8))
+                m_interruptFlags &= ~0x1;
+        }
+        else if ((m_interruptEnables & 2) & (m_interruptFlags & 2)) { // LCD STAT
+            if (m_CPU.interrupt(9))
+                m_interruptFlags &= ~0x2;
+        }
+        else if ((m_interruptEnables & 4) & (m_interruptFlags & 4)) { // Timer
+            if (m_CPU.interrupt(10))
+                m_interruptFlags &= ~0x4;
+        }
+        else if ((m_interruptEnables & 8) & (m_interruptFlags & 8)) { // Serial
+            if (m_CPU.interrupt(11))
+                m_interruptFlags &= ~0x8;
+        }
+        else if ((m_interruptEnables & 0x10) & (m_interruptFlags & 0x10)) { // Joypad
+            if (m_CPU.interrupt(12))
+                m_interruptFlags &= ~0x10;
         }
     }
 }
 
-void Gameboy::loadCartridge(const char* filename, bool quiet)
+bool Gameboy::loadCartridge(const char* filename, bool quiet, Cartridge::RAMMode mode)
 {
     m_isRunning = false;
-    m_cartridge.loadFromFile(filename, quiet);
-    m_hasCartridge = true;
+    m_hasCartridge = m_cartridge.loadFromFile(filename, quiet, mode);
+    mapCartridge();
+    return m_hasCartridge;
+}
+
+void Gameboy::saveState(std::vector<u8>& state) const
+{
+    StateWriter writer{ state, STATE_ID, STATE_VERSION };
+    m_CPU.saveState(writer);
+    m_PPU.saveState(writer);
+    m_cartridge.saveState(writer);
+    writer.writeBytes(m_WRAM, 0x2000);
+    writer.write(m_joypad);
+    writer.write(m_serialData);
+    writer.write(m_serialControl);
+    m_timer.saveState(writer);
+    writer.write(m_interruptFlags);
+    m_APU.saveState(writer);
+    writer.write(m_unmapBootloader);
+    writer.writeBytes(m_HRAM, sizeof(m_HRAM));
+    writer.write(m_interruptEnables);
+    writer.write(m_isRunning);
+    writer.writeBytes(m_serialBuffer, sizeof(m_serialBuffer));
+    writer.write(m_serialBufferSize);
+    m_scheduler.saveState(writer);
+}
+
+bool Gameboy::loadState(std::span<const u8> state)
+{
+    StateReader reader{ state, STATE_ID, STATE_VERSION };
+    if (!reader.isValid())
+        return false;
+
+    m_CPU.loadState(reader);
+    m_PPU.loadState(reader);
+    m_cartridge.loadState(reader);
+    reader.readBytes(m_WRAM, 0x2000);
+    reader.read(m_joypad);
+    reader.read(m_serialData);
+    reader.read(m_serialControl);
+    m_timer.loadState(reader);
+    reader.read(m_interruptFlags);
+    m_APU.loadState(reader);
+    reader.read(m_unmapBootloader);
+    reader.readBytes(m_HRAM, sizeof(m_HRAM));
+    reader.read(m_interruptEnables);
+    reader.read(m_isRunning);
+    reader.readBytes(m_serialBuffer, sizeof(m_serialBuffer));
+    reader.read(m_serialBufferSize);
+    m_scheduler.loadState(reader);
+
+    // Bus mapping depends on the restored banks and bootloader register.
+    mapCartridge();
+
+    return reader.isValid() && reader.isAtEnd();
+}
+
+void Gameboy::mapCartridge()
+{
+    const MBC::Banks& banks = m_cartridge.getBanks();
+    if (!banks.ROM0) {
+        m_bus.mapReadMemory(ROM_RANGE, m_openBus, 0xFF);
+        m_bus.mapOpenBus(EXTRAM_RANGE);
+        return;
+    }
+
+    m_bus.mapReadMemory(ROM0_RANGE, banks.ROM0);
+    m_bus.mapReadMemory(ROMN_RANGE, banks.ROMN);
+    if ((m_unmapBootloader & 1) == 0)
+        m_bus.mapReadMemory(BOOTLOADER_RANGE, m_bootloader);
+
+    // Disabled RAM and controller registers like RTC are left to the cartridge.
+    if (banks.RAM && banks.RAMMask >= MemoryBus16::PAGE_SIZE - 1)
+        m_bus.mapMemory(EXTRAM_RANGE, banks.RAM, banks.RAMMask);
+    else {
+        m_bus.mapReadCallback(EXTRAM_RANGE, m_extRAMReadCallback);
+        m_bus.mapWriteCallback(EXTRAM_RANGE, m_extRAMWriteCallback);
+    }
 }
 
 void Gameboy::runUntilEndlessLoop()
@@ -121,7 +328,7 @@ void Gameboy::runUntilEndlessLoop()
     u8 counter = 0;
     while (counter < 10)
     {
-        update();
+        runInstruction();
 
         if (lastPC == m_CPU.getState().PC && !m_CPU.getState().IsHalted)
             counter++;
@@ -137,22 +344,14 @@ void Gameboy::runUntilDebugBreak()
     u8 nextInstr = memoryRead(m_CPU.getState().PC);
     while (nextInstr != 0x40)
     {
-        update();
+        runInstruction();
         nextInstr = memoryRead(m_CPU.getState().PC);
     }
 }
 
-u8 Gameboy::memoryRead(u16 address)
+u8 Gameboy::loadIO8(u16 address)
 {
     u16 offset;
-    if (ROM_RANGE.contains(address, offset)) {
-        if ((m_unmapBootloader & 1) == 0 && offset < 0x100) return m_bootloader[offset];
-        return m_cartridge.load8(offset);
-    }
-
-    if (VRAM_RANGE.contains(address, offset)) return m_PPU.loadVRAM8(offset);
-    if (EXTRAM_RANGE.contains(address, offset)) return m_cartridge.load8ExtRAM(offset);
-    if (WRAM_RANGE.contains(address, offset)) return m_WRAM[offset];
     if (OAM_RANGE.contains(address, offset)) return m_PPU.loadOAM8(offset);
     if (address == 0xFF00) return m_joypad;
     if (SERIAL_RANGE.contains(address, offset)) {
@@ -164,20 +363,15 @@ u8 Gameboy::memoryRead(u16 address)
     if (PPU_RANGE.contains(address, offset)) return m_PPU.load8(offset);
     if (address == 0xFF0F) return m_interruptFlags;
     if (address == 0xFF50) return m_unmapBootloader;
-    if (HRAM_RANGE.contains(address, offset)) return m_HRAM[offset];
     if (address == 0xFFFF) return m_interruptEnables;
 
     std::cerr << "Unexpected memory read - " << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << address << '\n';
     return 0xFF;
 }
 
-void Gameboy::memoryWrite(u16 address, u8 data)
+void Gameboy::storeIO8(u16 address, u8 data)
 {
     u16 offset;
-    if (ROM_RANGE.contains(address, offset)) { m_cartridge.store8(offset, data); return; }
-    if (VRAM_RANGE.contains(address, offset)) { m_PPU.storeVRAM8(offset, data); return; }
-    if (EXTRAM_RANGE.contains(address, offset)) { m_cartridge.store8ExtRAM(offset, data); return; }
-    if (WRAM_RANGE.contains(address, offset)) { m_WRAM[offset] = data; return; }
     if (OAM_RANGE.contains(address, offset)) { m_PPU.storeOAM8(offset, data); return; }
     if (UNUSED1_RANGE.contains(address, offset)) { return; } // Ignore writes to unused memory
 
@@ -199,6 +393,7 @@ void Gameboy::memoryWrite(u16 address, u8 data)
             m_serialBuffer[m_serialBufferSize] = '\0';
             m_serialBufferSize %= 64;
             m_serialControl &= 0x7F;
+            if (serialOutput) serialOutput(m_serialData);
         }
         return;
     }
@@ -212,9 +407,12 @@ void Gameboy::memoryWrite(u16 address, u8 data)
         m_interruptFlags |= data & 0x1F;
         return;
     }
-    if (address == 0xFF50 && (m_unmapBootloader & 1) == 0) { m_unmapBootloader |= data & 1; return; }
+    if (address == 0xFF50 && (m_unmapBootloader & 1) == 0) {
+        m_unmapBootloader |= data & 1;
+        mapCartridge();
+        return;
+    }
     if (UNUSED3_RANGE.contains(address, offset)) { return; } // Ignore writes to unused memory
-    if (HRAM_RANGE.contains(address, offset)) { m_HRAM[offset] = data; return; }
     if (address == 0xFFFF) { m_interruptEnables = data; return; }
 
     if (address >= 0xFF00) {
@@ -4,6 +4,14 @@
 #include "cartridge.hpp"
 #include "ppu.hpp"
 #include "timer.hpp"
+#include "shared/source/memory_bus.hpp"
+#include "shared/source/scheduler.hpp"
+
+#include <span>
+#include <vector>
+
+class GBDoctorTrace;
+class PCProfiler;
 
 #if defined(GAMEBOY_TESTS)
 #define PRIVATE public
@@ -19,19 +27,51 @@ public:
 
     void reset();
     void update();
+    u32 runCycles(u32 budget);
+    // Returns 0 without running anything when there is no cartridge or emulation is stopped.
+    u32 runInstruction();
+    // While breakpoints are armed runCycles() stops at hits, watchpoints are applied at its start.
+    void setBreakpoints(Breakpoints* breakpoints) { m_breakpoints = breakpoints; m_bus.setBreakpoints(breakpoints); }
+    // Records every executed instruction, has to be set while emulation is stopped.
+    void setTrace(GBDoctorTrace* trace) { m_trace = trace; }
+    // While profiler is enabled runCycles() records every instruction in it.
+    void setProfiler(PCProfiler* profiler) { m_profiler = profiler; }
+    // While call profiler is enabled runCycles() reports calls and returns to it.
+    void setCallProfiler(CallProfiler* profiler) { m_callProfiler = profiler; }
 
-    void loadCartridge(const char* filename, bool quiet = false);
+    bool loadCartridge(const char* filename, bool quiet = false, Cartridge::RAMMode mode = Cartridge::RAMMode::Battery);
+
+    // State can only be loaded with the same cartridge inserted.
+    // Machine has to be reset when loading fails, it might have been partially overwritten.
+    void saveState(std::vector<u8>& state) const;
+    bool loadState(std::span<const u8> state);
+    const CPU& getCPU() const { return m_CPU; }
     const PPU& getPPU() const { return m_PPU; }
+    PPU& getPPU() { return m_PPU; }
 
     const char* getSerialBuffer() const { return m_serialBuffer; }
+    using SerialOutputCallback = std::function<void(u8)>;
+    void mapSerialOutputCallback(SerialOutputCallback callback) { serialOutput = callback; }
 
     // test only:
     void runUntilEndlessLoop();
     void runUntilDebugBreak();
 PRIVATE:
-    u8 memoryRead(u16 address);
-    void memoryWrite(u16 address, u8 data);
+    u32 runCyclesInstrumented(u32 budget);
+    void traceInstruction();
+    void tick();
+    void handleInterrupts();
+    // Points ROM and external RAM pages at current cartridge banks,
+    // with bootloader over the first page until unmapped. Open bus without a cartridge.
+    void mapCartridge();
+
+    u8 memoryRead(u16 address) const { return m_bus.read8(address); }
+    void memoryWrite(u16 address, u8 data) { m_bus.write8(address, data); }
+    u8 loadIO8(u16 address);
+    void storeIO8(u16 address, u8 data);
 
+    MemoryBus16 m_bus;
+    Scheduler m_scheduler;
     CPU m_CPU;
     PPU m_PPU;
     Cartridge m_cartridge;
@@ -46,12 +86,20 @@ PRIVATE:
     u8 m_HRAM[0x7F];
     u8 m_interruptEnables;
     u8 m_bootloader[256];
+    u8 m_openBus[256]; // read through ROM pages while there is no cartridge
+    u8 m_extRAMReadCallback;
+    u8 m_extRAMWriteCallback;
     
     bool m_isRunning;
     bool m_hasCartridge;
+    Breakpoints* m_breakpoints = nullptr;
+    GBDoctorTrace* m_trace = nullptr;
+    PCProfiler* m_profiler = nullptr;
+    CallProfiler* m_callProfiler = nullptr;
 
     char m_serialBuffer[65];
     u8 m_serialBufferSize;
+    SerialOutputCallback serialOutput = nullptr;
 };
 
 #undef PRIVATE
@@ -1,55 +1,154 @@
 #include "gb_doctor.hpp"
 
-#define GB_DOCTOR_LOG 0
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
 
-#if GB_DOCTOR_LOG == 1
-#include <cassert>
-#include <fstream>
-#include <iomanip>
+static constexpr char MAGIC[4] = { 'G', 'B', 'D', 'T' };
+static constexpr u8 VERSION = 1;
+static constexpr size_t RECORD_BYTES = 16; // everything except cycle
+static constexpr size_t MAX_ENCODED_SIZE = 2 + RECORD_BYTES + 10;
+static constexpr size_t WRITE_BUFFER_SIZE = 1 << 16;
 
-static std::ofstream s_log;
-#endif
+static void packRecord(const GBDoctorTrace::Record& record, u8* bytes)
+{
+    bytes[0] = record.A;
+    bytes[1] = record.F;
+    bytes[2] = record.B;
+    bytes[3] = record.C;
+    bytes[4] = record.D;
+    bytes[5] = record.E;
+    bytes[6] = record.H;
+    bytes[7] = record.L;
+    bytes[8] = record.SP & 0xFF;
+    bytes[9] = record.SP >> 8;
+    bytes[10] = record.PC & 0xFF;
+    bytes[11] = record.PC >> 8;
+    std::memcpy(bytes + 12, record.PCMEM, 4);
+}
 
-void initGBDoctor()
+bool GBDoctorTrace::open(const char* filename)
 {
-#if GB_DOCTOR_LOG == 1
-    s_log.open("gbdoctor.log");
-    assert(s_log.is_open());
-    s_log << std::setfill('0') << std::uppercase;
-#endif
+    close();
+
+    m_file.open(filename, std::ios::binary);
+    if (!m_file.is_open())
+        return false;
+
+    m_file.write(MAGIC, sizeof(MAGIC));
+    m_file.put((char)VERSION);
+
+    m_isClosing.store(false, std::memory_order_relaxed);
+    m_writer = std::thread{ [this]() { writeRecords(); } };
+    return true;
 }
 
-void shutdownGBDoctor()
+void GBDoctorTrace::close()
 {
-#if GB_DOCTOR_LOG == 1
-    s_log.close();
-#endif
+    if (m_writer.joinable()) {
+        m_isClosing.store(true, std::memory_order_release);
+        m_writer.join();
+    }
+
+    if (m_file.is_open())
+        m_file.close();
 }
 
-void updateGBDoctor(bool isBootloaderUnmapped, bool isLastCycle, const CPU::State& cpuState, CPU::ReadMemoryCallback readMemory)
+void GBDoctorTrace::writeRecords()
 {
-#if GB_DOCTOR_LOG == 1
-    if (isBootloaderUnmapped && isLastCycle) {
-        s_log << "A:" << std::setw(2) << std::hex << (u16)cpuState.A;
-        s_log << " F:" << std::setw(2) << std::hex << (u16)cpuState.F.byte;
-        s_log << " B:" << std::setw(2) << std::hex << (u16)cpuState.B;
-        s_log << " C:" << std::setw(2) << std::hex << (u16)cpuState.C;
-        s_log << " D:" << std::setw(2) << std::hex << (u16)cpuState.D;
-        s_log << " E:" << std::setw(2) << std::hex << (u16)cpuState.E;
-        s_log << " H:" << std::setw(2) << std::hex << (u16)cpuState.H;
-        s_log << " L:" << std::setw(2) << std::hex << (u16)cpuState.L;
-        s_log << " SP:" << std::setw(4) << std::hex << cpuState.SP;
-        s_log << " PC:" << std::setw(4) << std::hex << cpuState.PC;
-        s_log << " PCMEM:" << std::setw(2) << std::hex << (u16)readMemory(cpuState.PC) << ',';
-        s_log << std::setw(2) << std::hex << (u16)readMemory(cpuState.PC + 1) << ',';
-        s_log << std::setw(2) << std::hex << (u16)readMemory(cpuState.PC + 2) << ',';
-        s_log << std::setw(2) << std::hex << (u16)readMemory(cpuState.PC + 3);
-        s_log << '\n';
+    std::vector<char> buffer;
+    buffer.reserve(WRITE_BUFFER_SIZE + MAX_ENCODED_SIZE);
+    u8 previous[RECORD_BYTES]{};
+    u64 previousCycle = 0;
+
+    while (true) {
+        // Flag is read before draining, so records pushed before close() are never lost.
+        bool isClosing = m_isClosing.load(std::memory_order_acquire);
+
+        bool hasRecords = false;
+        Record record;
+        while (m_ring.pop(record)) {
+            hasRecords = true;
+
+            u8 bytes[RECORD_BYTES];
+            packRecord(record, bytes);
+
+            u16 mask = 0;
+            for (u32 i = 0; i < RECORD_BYTES; i++)
+                if (bytes[i] != previous[i])
+                    mask |= 1 << i;
+
+            buffer.push_back((char)(mask & 0xFF));
+            buffer.push_back((char)(mask >> 8));
+            for (u32 i = 0; i < RECORD_BYTES; i++)
+                if (mask & (1 << i))
+                    buffer.push_back((char)bytes[i]);
+
+            // Cycle counter goes back on reset, hence signed delta.
+            s64 delta = (s64)(record.cycle - previousCycle);
+            u64 zigzag = ((u64)delta << 1) ^ (u64)(delta >> 63);
+            do {
+                u8 byte = zigzag & 0x7F;
+                zigzag >>= 7;
+                buffer.push_back((char)(byte | (zigzag ? 0x80 : 0)));
+            } while (zigzag);
+
+            std::memcpy(previous, bytes, RECORD_BYTES);
+            previousCycle = record.cycle;
+
+            if (buffer.size() >= WRITE_BUFFER_SIZE) {
+                m_file.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+
+        if (isClosing)
+            break;
+
+        if (!hasRecords)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    m_file.write(buffer.data(), buffer.size());
+}
+
+bool convertGBDoctorTrace(const char* filename, std::ostream& out)
+{
+    std::ifstream fin{ filename, std::ios::binary };
+    if (!fin.is_open())
+        return false;
+
+    char magic[sizeof(MAGIC)];
+    if (!fin.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || fin.get() != VERSION)
+        return false;
+
+    std::streambuf& in = *fin.rdbuf();
+    u8 bytes[RECORD_BYTES]{};
+    while (true) {
+        int maskLow = in.sbumpc();
+        if (maskLow == std::streambuf::traits_type::eof())
+            return true;
+
+        u16 mask = (u16)(maskLow | (in.sbumpc() << 8));
+        for (u32 i = 0; i < RECORD_BYTES; i++)
+            if (mask & (1 << i))
+                bytes[i] = (u8)in.sbumpc();
+
+        // Cycle is not part of Gameboy Doctor format, delta only has to be skipped.
+        int byte;
+        do {
+            byte = in.sbumpc();
+            if (byte == std::streambuf::traits_type::eof())
+                return false;
+        } while (byte & 0x80);
+
+        char line[80];
+        int length = std::snprintf(line, sizeof(line),
+            "A:%02X F:%02X B:%02X C:%02X D:%02X E:%02X H:%02X L:%02X SP:%04X PC:%04X PCMEM:%02X,%02X,%02X,%02X\n",
+            bytes[0], bytes[1], bytes[2], bytes[3], bytes[4], bytes[5], bytes[6], bytes[7],
+            bytes[8] | (bytes[9] << 8), bytes[10] | (bytes[11] << 8),
+            bytes[12], bytes[13], bytes[14], bytes[15]);
+        out.write(line, length);
     }
-#else
-    (void)isBootloaderUnmapped;
-    (void)isLastCycle;
-    (void)cpuState;
-    (void)readMemory;
-#endif
 }
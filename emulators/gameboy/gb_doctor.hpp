@@ -1,6 +1,56 @@
 #pragma once
-#include "cpu.hpp"
+#include "shared/source/spsc_ring.hpp"
+#include "shared/source/types.hpp"
 
-void initGBDoctor();
-void shutdownGBDoctor();
-void updateGBDoctor(bool isBootloaderUnmapped, bool isLastCycle, const CPU::State& cpuState, CPU::ReadMemoryCallback readMemory);
+#include <atomic>
+#include <fstream>
+#include <ostream>
+#include <thread>
+
+// Binary execution trace that converts to Gameboy Doctor log format.
+// Emulation thread only pushes fixed size records to a lock-free ring. A background thread
+// delta encodes each record against the previous one and writes it out, so full test ROM
+// runs can be traced at close to normal speed and give files a fraction of the text log size.
+//
+// File: "GBDT" magic, version byte, then per record:
+// u16 mask of bytes changed since previous record, changed bytes, zigzag LEB128 cycle delta.
+class GBDoctorTrace
+{
+public:
+    struct Record
+    {
+        u64 cycle;
+        u8 A, F, B, C, D, E, H, L;
+        u16 SP;
+        u16 PC;
+        u8 PCMEM[4];
+    };
+
+    GBDoctorTrace() = default;
+    ~GBDoctorTrace() { close(); }
+
+    bool open(const char* filename);
+    // Writes out all recorded instructions.
+    void close();
+    bool isOpen() const { return m_file.is_open(); }
+
+    // emulation thread, waits only when writer falls a whole ring behind:
+    void record(const Record& record)
+    {
+        while (!m_ring.push(record))
+            std::this_thread::yield();
+    }
+
+    GBDoctorTrace(const GBDoctorTrace&) = delete;
+    GBDoctorTrace& operator=(const GBDoctorTrace&) = delete;
+private:
+    void writeRecords();
+
+    SPSCRing<Record> m_ring{ 1 << 16 };
+    std::ofstream m_file;
+    std::thread m_writer;
+    std::atomic<bool> m_isClosing{ false };
+};
+
+// Decodes binary trace into Gameboy Doctor text log, one line per instruction.
+bool convertGBDoctorTrace(const char* filename, std::ostream& out);
@@ -134,6 +134,10 @@ namespace GUI {
             ImGui::MenuItem("Show Tile Data", nullptr, &s_showTileData);
             ImGui::MenuItem("Show Tile Map 0", nullptr, &s_showMap0);
             ImGui::MenuItem("Show Tile Map 1", nullptr, &s_showMap1);
+            ImGui::Separator();
+            bool isPixelFIFO = gb.getPPU().getRenderer() == PPU::Renderer::PixelFIFO;
+            if (ImGui::MenuItem("Pixel FIFO Renderer", nullptr, &isPixelFIFO))
+                gb.getPPU().setRenderer(isPixelFIFO ? PPU::Renderer::PixelFIFO : PPU::Renderer::Scanline);
 
             ImGui::EndMenu();
         }
@@ -0,0 +1,140 @@
+#include "batch_runner.hpp"
+#include "gameboy.hpp"
+#include "gb_doctor.hpp"
+
+#include "shared/source/headless_application.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+static constexpr u32 CYCLES_PER_FRAME = 114 * 154;
+
+class GameboyHeadless :
+    public HeadlessApplication
+{
+public:
+    explicit GameboyHeadless(Gameboy& gameboy) :
+        HeadlessApplication{ {
+                .name = "gameboy",
+                .screenWidth = PPU::LCD_WIDTH,
+                .screenHeight = PPU::LCD_HEIGHT,
+                .cyclesPerFrame = CYCLES_PER_FRAME,
+                .clockFrequency = 1024 * 1024,
+                .needsROM = true,
+                .extraUsage = "[--trace file.gbdt] [--fifo-ppu] [--battery-saves] | --batch [--frames N] [--threads N] rom..."
+        } },
+        m_gameboy{ gameboy }
+    {
+        m_gameboy.mapSerialOutputCallback([this](u8 data) { m_serialOutput += (char)data; });
+    }
+private:
+    int parseOption(int argc, char* argv[], int i) override {
+        if (std::strcmp(argv[i], "--fifo-ppu") == 0) {
+            m_gameboy.getPPU().setRenderer(PPU::Renderer::PixelFIFO);
+            return 1;
+        }
+        if (std::strcmp(argv[i], "--battery-saves") == 0) {
+            m_RAMMode = Cartridge::RAMMode::Battery;
+            return 1;
+        }
+
+        if (std::strcmp(argv[i], "--trace") != 0 || i + 1 >= argc) return 0;
+
+        if (!m_trace.open(argv[i + 1])) {
+            std::cerr << "Could not open " << argv[i + 1] << '\n';
+            return 0;
+        }
+
+        m_gameboy.setTrace(&m_trace);
+        return 2;
+    }
+
+    bool loadROM(const char* filename) override {
+        if (!m_gameboy.loadCartridge(filename, true, m_RAMMode)) return false;
+
+        m_gameboy.reset();
+        return true;
+    }
+
+    void setCallProfiler(CallProfiler* profiler) override { m_gameboy.setCallProfiler(profiler); }
+    u32 runCycles(u32 budget) override { return m_gameboy.runCycles(budget); }
+    std::span<const u32> acquireScreenPixels() override { return m_gameboy.getPPU().acquireScreenPixels(); }
+
+    Gameboy& m_gameboy;
+    GBDoctorTrace m_trace;
+    // Runs don't touch .sav files next to ROMs unless asked to, so they don't depend on each other.
+    Cartridge::RAMMode m_RAMMode = Cartridge::RAMMode::Volatile;
+};
+
+// usage: gameboy_headless --batch [--frames N] [--threads N] rom...
+static int runBatchMode(int argc, char* argv[])
+{
+    u64 frames = 60;
+    unsigned int threadCount = 0;
+    std::vector<BatchJob> jobs;
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--frames") == 0 && hasValue) frames = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) threadCount = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (argv[i][0] != '-') jobs.emplace_back().romPath = argv[i];
+        else {
+            jobs.clear();
+            break;
+        }
+    }
+
+    if (jobs.empty()) {
+        std::cerr << "usage: gameboy_headless --batch [--frames N] [--threads N] rom...\n";
+        return 1;
+    }
+
+    for (BatchJob& job : jobs)
+        job.cycles = frames * CYCLES_PER_FRAME;
+
+    if (threadCount == 0)
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+    auto start = std::chrono::steady_clock::now();
+    runBatch(jobs, threadCount);
+    std::chrono::duration<double> hostTime = std::chrono::steady_clock::now() - start;
+
+    int result = 0;
+    for (const BatchJob& job : jobs) {
+        if (!job.isLoaded) {
+            std::cout << job.romPath << ": could not load\n";
+            result = 1;
+            continue;
+        }
+
+        // Last line is where text reporting test ROMs put their verdict, binary output is not printed.
+        std::string_view serial = job.serialOutput;
+        while (!serial.empty() && serial.back() == '\n') serial.remove_suffix(1);
+        serial = serial.substr(serial.find_last_of('\n') + 1);
+        if (std::any_of(serial.begin(), serial.end(), [](char c) { return c < ' ' || c > '~'; }))
+            serial = {};
+
+        std::cout << job.romPath << ": " << job.cyclesRun << " cycles"
+                  << (job.hasMooneyePassed ? ", mooneye passed" : "")
+                  << (serial.empty() ? "" : ", serial: ") << serial << '\n';
+    }
+
+    std::cout << "gameboy: " << jobs.size() << " ROMs in " << hostTime.count() << "s on "
+              << std::min<size_t>(threadCount, jobs.size()) << " threads\n";
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && std::strcmp(argv[1], "--batch") == 0)
+        return runBatchMode(argc, argv);
+
+    Gameboy gameboy;
+    GameboyHeadless app{ gameboy };
+    return app.run(argc, argv);
+}
@@ -2,8 +2,11 @@
 #include "gui.hpp"
 
 #include "shared/source/application.hpp"
+#include "shared/source/frame_pacer.hpp"
+#include "shared/source/rewind_buffer.hpp"
 
 #include <thread>
+#include <vector>
 
 class GameboyApp :
     public Application
@@ -21,7 +24,12 @@ public:
         m_gameboy{ gameboy }
     {}
 private:
-    std::span<const unsigned int> getScreenPixels() const override { return m_gameboy.getPPU().getScreenPixels(); }
+    ScreenFrame acquireScreenFrame() override {
+        auto pixels = m_gameboy.getPPU().acquireScreenPixels();
+        return { pixels, m_gameboy.getPPU().getScreenSequence() };
+    }
+
+    bool supportsRewind() const override { return true; }
 
     void onImGUIRender() override {
         GUI::update(m_gameboy);
@@ -30,18 +38,36 @@ private:
     Gameboy& m_gameboy;
 };
 
+static constexpr u32 CYCLES_PER_FRAME = 114 * 154;
+static constexpr double FRAMES_PER_SECOND = 1024.0 * 1024.0 / CYCLES_PER_FRAME;
+static constexpr size_t REWIND_FRAMES = 60 * 60;
+static constexpr size_t REWIND_BYTES = 16 * 1024 * 1024;
+
 int main()
 {
     Gameboy gameboy;
+    FramePacer pacer{ FRAMES_PER_SECOND };
     GameboyApp app{ gameboy };
 
     GUI::init(&app);
 
     std::thread emuThread{
         [&]() {
+            RewindBuffer rewind{ REWIND_FRAMES, REWIND_BYTES };
+            std::vector<u8> state;
+            pacer.reset();
             while (app.isRunning()) {
-                std::this_thread::sleep_for(std::chrono::nanoseconds{ 24 }); // TODO: temp
-                gameboy.update();
+                if (app.isRewinding()) {
+                    // States are taken at frame start, running the frame again redraws it.
+                    if (rewind.pop(state) && gameboy.loadState(state))
+                        gameboy.runCycles(CYCLES_PER_FRAME);
+                }
+                else {
+                    gameboy.saveState(state);
+                    rewind.push(state);
+                    gameboy.runCycles(CYCLES_PER_FRAME);
+                }
+                pacer.waitForNextFrame();
             }
         }
     };
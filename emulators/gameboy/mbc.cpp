@@ -0,0 +1,412 @@
+#include "mbc.hpp"
+
+#include "shared/source/save_state.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+static constexpr size_t ROM_BANK_SIZE = 0x4000;
+static constexpr size_t RAM_BANK_SIZE = 0x2000;
+
+void MBC::setBanks(u32 ROMBank0, u32 ROMBankN, s32 RAMBank)
+{
+    size_t ROMBanks = m_ROM.size() / ROM_BANK_SIZE;
+    m_banks.ROM0 = m_ROM.data() + ROMBank0 % ROMBanks * ROM_BANK_SIZE;
+    m_banks.ROMN = m_ROM.data() + ROMBankN % ROMBanks * ROM_BANK_SIZE;
+
+    size_t RAMBanks = (m_RAM.size() + RAM_BANK_SIZE - 1) / RAM_BANK_SIZE;
+    m_banks.RAM = RAMBank >= 0 && RAMBanks ? m_RAM.data() + RAMBank % RAMBanks * RAM_BANK_SIZE : nullptr;
+    m_banks.RAMMask = (u16)(std::min(m_RAM.size(), RAM_BANK_SIZE) - 1);
+}
+
+namespace {
+
+    class NoMBC :
+        public MBC
+    {
+    public:
+        NoMBC(std::span<const u8> ROM, std::span<u8> RAM, Banks& banks) :
+            MBC{ ROM, RAM, banks }
+        {
+            setBanks(0, 1, 0);
+        }
+
+        void store8(u16 address, u8 data) override
+        {
+            std::cerr << "Unexpected write to cartridge - " << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << address;
+            std::cerr << ':' << std::hex << std::setw(2) << (u16)data << '\n';
+        }
+
+        void saveState(StateWriter& /*writer*/) const override {}
+        void loadState(StateReader& /*reader*/) override {}
+    };
+
+    class MBC1 :
+        public MBC
+    {
+    public:
+        MBC1(std::span<const u8> ROM, std::span<u8> RAM, Banks& banks) :
+            MBC{ ROM, RAM, banks }
+        {
+            remap();
+        }
+
+        void store8(u16 address, u8 data) override
+        {
+            switch (address >> 13)
+            {
+            case 0: m_isRAMEnabled = (data & 0xF) == 0xA; break;
+            case 1: m_bankLow = (data & 0x1F) ? (data & 0x1F) : 1; break;
+            case 2: m_bankHigh = data & 0b11; break;
+            case 3: m_isAdvancedMode = data & 1; break;
+            }
+
+            remap();
+        }
+
+        void saveState(StateWriter& writer) const override
+        {
+            writer.write(m_isRAMEnabled);
+            writer.write(m_bankLow);
+            writer.write(m_bankHigh);
+            writer.write(m_isAdvancedMode);
+        }
+
+        void loadState(StateReader& reader) override
+        {
+            reader.read(m_isRAMEnabled);
+            reader.read(m_bankLow);
+            reader.read(m_bankHigh);
+            reader.read(m_isAdvancedMode);
+            remap();
+        }
+    private:
+        // Upper bank bits select ROM bank above 512KB, in advanced mode they also bank
+        // the lower ROM area and RAM.
+        void remap()
+        {
+            u32 upperBank = m_bankHigh << 5;
+            setBanks(m_isAdvancedMode ? upperBank : 0, upperBank | m_bankLow,
+                !m_isRAMEnabled ? -1 : m_isAdvancedMode ? m_bankHigh : 0);
+        }
+
+        bool m_isRAMEnabled = false;
+        u8 m_bankLow = 1;
+        u8 m_bankHigh = 0;
+        bool m_isAdvancedMode = false;
+    };
+
+    class MBC2 :
+        public MBC
+    {
+    public:
+        MBC2(std::span<const u8> ROM, std::span<u8> RAM, Banks& banks) :
+            MBC{ ROM, RAM, banks }
+        {
+            assert(RAM.size() == RAM_SIZE);
+            remap();
+        }
+
+        // Address bit 8 decides which register is written.
+        void store8(u16 address, u8 data) override
+        {
+            if (address >= 0x4000)
+                return;
+
+            if (address & 0x100)
+                m_ROMBank = (data & 0xF) ? (data & 0xF) : 1;
+            else
+                m_isRAMEnabled = (data & 0xF) == 0xA;
+
+            remap();
+        }
+
+        // Built-in RAM is 512 half-bytes mirrored over the whole area, it can't be accessed through a pointer.
+        u8 load8ExtRAM(u16 address) const override
+        {
+            return m_isRAMEnabled ? 0xF0 | m_RAM[address & (RAM_SIZE - 1)] : 0xFF;
+        }
+
+        void store8ExtRAM(u16 address, u8 data) override
+        {
+            if (m_isRAMEnabled)
+                m_RAM[address & (RAM_SIZE - 1)] = data & 0xF;
+        }
+
+        void saveState(StateWriter& writer) const override
+        {
+            writer.write(m_isRAMEnabled);
+            writer.write(m_ROMBank);
+        }
+
+        void loadState(StateReader& reader) override
+        {
+            reader.read(m_isRAMEnabled);
+            reader.read(m_ROMBank);
+            remap();
+        }
+
+        static constexpr size_t RAM_SIZE = 512;
+    private:
+        void remap() { setBanks(0, m_ROMBank, -1); }
+
+        bool m_isRAMEnabled = false;
+        u8 m_ROMBank = 1;
+    };
+
+    class MBC3 :
+        public MBC
+    {
+    public:
+        // RTC keeps running while the emulator is closed, its base is persisted after RAM.
+        struct RTCSave {
+            s64 start;      // host time in seconds when the counter was 0, all zeros for a new save
+            s64 haltedTime; // counter while halted, -1 while running
+        };
+
+        MBC3(std::span<const u8> ROM, std::span<u8> RAM, Banks& banks, bool hasRTC) :
+            MBC{ ROM, RAM.first(hasRTC ? RAM.size() - sizeof(RTCSave) : RAM.size()), banks },
+            m_RTCSave{ hasRTC ? RAM.data() + RAM.size() - sizeof(RTCSave) : nullptr }
+        {
+            if (m_RTCSave) {
+                RTCSave save = getRTCSave();
+                if (save.start == 0 && save.haltedTime == 0)
+                    setRTCSave({ getHostTime(), -1 });
+                latchRTC();
+            }
+
+            remap();
+        }
+
+        void store8(u16 address, u8 data) override
+        {
+            switch (address >> 13)
+            {
+            case 0: m_isRAMEnabled = (data & 0xF) == 0xA; break;
+            case 1: m_ROMBank = (data & 0x7F) ? (data & 0x7F) : 1; break;
+            case 2: m_RAMBank = data & 0xF; break;
+            case 3:
+                if (m_latchData == 0 && data == 1 && m_RTCSave)
+                    latchRTC();
+                m_latchData = data;
+                break;
+            }
+
+            remap();
+        }
+
+        // RTC registers are selected in place of RAM banks 8-C.
+        u8 load8ExtRAM(u16 /*address*/) const override
+        {
+            if (m_isRAMEnabled && m_RTCSave && m_RAMBank >= 0x8 && m_RAMBank <= 0xC)
+                return m_latchedRTC[m_RAMBank - 0x8];
+
+            return 0xFF;
+        }
+
+        void store8ExtRAM(u16 /*address*/, u8 data) override
+        {
+            if (m_isRAMEnabled && m_RTCSave && m_RAMBank >= 0x8 && m_RAMBank <= 0xC)
+                writeRTC(m_RAMBank - 0x8, data);
+        }
+
+        void saveState(StateWriter& writer) const override
+        {
+            writer.write(m_isRAMEnabled);
+            writer.write(m_ROMBank);
+            writer.write(m_RAMBank);
+            writer.write(m_latchData);
+            writer.writeBytes(m_latchedRTC, sizeof(m_latchedRTC));
+        }
+
+        void loadState(StateReader& reader) override
+        {
+            reader.read(m_isRAMEnabled);
+            reader.read(m_ROMBank);
+            reader.read(m_RAMBank);
+            reader.read(m_latchData);
+            reader.readBytes(m_latchedRTC, sizeof(m_latchedRTC));
+            remap();
+        }
+    private:
+        static constexpr s64 SECONDS_PER_DAY = 24 * 60 * 60;
+        static constexpr s64 DAY_COUNTER_LIMIT = 512;
+
+        static s64 getHostTime()
+        {
+            auto now = std::chrono::system_clock::now().time_since_epoch();
+            return std::chrono::duration_cast<std::chrono::seconds>(now).count();
+        }
+
+        RTCSave getRTCSave() const
+        {
+            RTCSave save;
+            std::memcpy(&save, m_RTCSave, sizeof(save));
+            return save;
+        }
+
+        void setRTCSave(const RTCSave& save) { std::memcpy(m_RTCSave, &save, sizeof(save)); }
+
+        // Seconds counted so far, days past the 9-bit counter mean the carry flag is set.
+        s64 getRTCTime() const
+        {
+            RTCSave save = getRTCSave();
+            return save.haltedTime >= 0 ? save.haltedTime : std::max<s64>(getHostTime() - save.start, 0);
+        }
+
+        void latchRTC()
+        {
+            s64 time = getRTCTime();
+            s64 days = time / SECONDS_PER_DAY;
+            m_latchedRTC[0] = (u8)(time % 60);
+            m_latchedRTC[1] = (u8)(time / 60 % 60);
+            m_latchedRTC[2] = (u8)(time / 3600 % 24);
+            m_latchedRTC[3] = (u8)days;
+            m_latchedRTC[4] = (u8)(((days >> 8) & 1) | (getRTCSave().haltedTime >= 0 ? 0x40 : 0) | (days >= DAY_COUNTER_LIMIT ? 0x80 : 0));
+        }
+
+        // Written values replace one field of the counter, out of range seconds, minutes
+        // and hours wrap instead of counting up to the next overflow like hardware does.
+        void writeRTC(u8 reg, u8 data)
+        {
+            s64 time = getRTCTime();
+            s64 seconds = time % 60;
+            s64 minutes = time / 60 % 60;
+            s64 hours = time / 3600 % 24;
+            s64 days = time / SECONDS_PER_DAY;
+            bool isCarry = days >= DAY_COUNTER_LIMIT;
+            bool isHalted = getRTCSave().haltedTime >= 0;
+            days %= DAY_COUNTER_LIMIT;
+
+            switch (reg)
+            {
+            case 0: seconds = (data & 0x3F) % 60; break;
+            case 1: minutes = (data & 0x3F) % 60; break;
+            case 2: hours = (data & 0x1F) % 24; break;
+            case 3: days = (days & 0x100) | data; break;
+            case 4:
+                days = (days & 0xFF) | ((data & 1) << 8);
+                isHalted = data & 0x40;
+                isCarry = data & 0x80;
+                break;
+            }
+
+            time = ((days + (isCarry ? DAY_COUNTER_LIMIT : 0)) * SECONDS_PER_DAY) + hours * 3600 + minutes * 60 + seconds;
+            setRTCSave({ getHostTime() - time, isHalted ? time : -1 });
+            m_latchedRTC[reg] = data;
+        }
+
+        void remap() { setBanks(0, m_ROMBank, m_isRAMEnabled && m_RAMBank < 4 ? m_RAMBank : -1); }
+
+        bool m_isRAMEnabled = false;
+        u8 m_ROMBank = 1;
+        u8 m_RAMBank = 0;
+        u8 m_latchData = 0xFF;
+        u8 m_latchedRTC[5]{}; // S, M, H, DL, DH
+        u8* m_RTCSave;
+    };
+
+    class MBC5 :
+        public MBC
+    {
+    public:
+        MBC5(std::span<const u8> ROM, std::span<u8> RAM, Banks& banks, bool hasRumble) :
+            MBC{ ROM, RAM, banks },
+            m_RAMBankMask{ (u8)(hasRumble ? 0x7 : 0xF) } // bit 3 drives the motor
+        {
+            remap();
+        }
+
+        // Unlike older controllers bank 0 can be selected for the upper ROM area.
+        void store8(u16 address, u8 data) override
+        {
+            switch (address >> 12)
+            {
+            case 0: case 1: m_isRAMEnabled = (data & 0xF) == 0xA; break;
+            case 2: m_ROMBank = (m_ROMBank & 0x100) | data; break;
+            case 3: m_ROMBank = (m_ROMBank & 0xFF) | ((data & 1) << 8); break;
+            case 4: case 5: m_RAMBank = data & m_RAMBankMask; break;
+            }
+
+            remap();
+        }
+
+        void saveState(StateWriter& writer) const override
+        {
+            writer.write(m_isRAMEnabled);
+            writer.write(m_ROMBank);
+            writer.write(m_RAMBank);
+        }
+
+        void loadState(StateReader& reader) override
+        {
+            reader.read(m_isRAMEnabled);
+            reader.read(m_ROMBank);
+            reader.read(m_RAMBank);
+            remap();
+        }
+    private:
+        void remap() { setBanks(0, m_ROMBank, m_isRAMEnabled ? m_RAMBank : -1); }
+
+        const u8 m_RAMBankMask;
+        bool m_isRAMEnabled = false;
+        u16 m_ROMBank = 1;
+        u8 m_RAMBank = 0;
+    };
+
+} // namespace
+
+bool MBC::isSupported(u8 cartridgeTypeCode)
+{
+    switch (cartridgeTypeCode)
+    {
+    case 0x00: case 0x08: case 0x09:
+    case 0x01: case 0x02: case 0x03:
+    case 0x05: case 0x06:
+    case 0x0F: case 0x10: case 0x11: case 0x12: case 0x13:
+    case 0x19: case 0x1A: case 0x1B: case 0x1C: case 0x1D: case 0x1E:
+        return true;
+    }
+
+    return false;
+}
+
+std::unique_ptr<MBC> MBC::create(u8 cartridgeTypeCode, std::span<const u8> ROM, std::span<u8> RAM, Banks& banks)
+{
+    switch (cartridgeTypeCode)
+    {
+    case 0x00: case 0x08: case 0x09:
+        return std::make_unique<NoMBC>(ROM, RAM, banks);
+    case 0x01: case 0x02: case 0x03:
+        return std::make_unique<MBC1>(ROM, RAM, banks);
+    case 0x05: case 0x06:
+        return std::make_unique<MBC2>(ROM, RAM, banks);
+    case 0x0F: case 0x10:
+        return std::make_unique<MBC3>(ROM, RAM, banks, true);
+    case 0x11: case 0x12: case 0x13:
+        return std::make_unique<MBC3>(ROM, RAM, banks, false);
+    case 0x19: case 0x1A: case 0x1B:
+        return std::make_unique<MBC5>(ROM, RAM, banks, false);
+    case 0x1C: case 0x1D: case 0x1E:
+        return std::make_unique<MBC5>(ROM, RAM, banks, true);
+    }
+
+    return nullptr;
+}
+
+size_t MBC::getRAMSize(u8 cartridgeTypeCode, size_t headerRAMSize)
+{
+    switch (cartridgeTypeCode)
+    {
+    case 0x05: case 0x06:
+        return MBC2::RAM_SIZE;
+    case 0x0F: case 0x10:
+        return headerRAMSize + sizeof(MBC3::RTCSave);
+    }
+
+    return headerRAMSize;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "shared/source/types.hpp"
+
+#include <memory>
+#include <span>
+
+class StateWriter;
+class StateReader;
+
+// Memory bank controller of a cartridge, picked once when the cartridge is loaded.
+// Bank registers are decoded on write into pointers the cartridge reads through,
+// so ROM and RAM accesses never look at the controller type.
+class MBC
+{
+public:
+    struct Banks {
+        const u8* ROM0 = nullptr; // 0x0000 - 0x3FFF
+        const u8* ROMN = nullptr; // 0x4000 - 0x7FFF
+        u8* RAM = nullptr;        // 0xA000 - 0xBFFF, nullptr when disabled or not plain RAM
+        u16 RAMMask = 0x1FFF;     // RAM smaller than a bank is mirrored
+    };
+
+    static bool isSupported(u8 cartridgeTypeCode);
+    static std::unique_ptr<MBC> create(u8 cartridgeTypeCode, std::span<const u8> ROM, std::span<u8> RAM, Banks& banks);
+    // Size of the RAM span create() expects, including memory built into the controller
+    // and RTC state that is persisted after RAM in the save file.
+    static size_t getRAMSize(u8 cartridgeTypeCode, size_t headerRAMSize);
+
+    virtual ~MBC() = default;
+
+    virtual void store8(u16 address, u8 data) = 0;
+    // External RAM accesses while Banks::RAM is nullptr.
+    virtual u8 load8ExtRAM(u16 /*address*/) const { return 0xFF; }
+    virtual void store8ExtRAM(u16 /*address*/, u8 /*data*/) {}
+
+    // Registers only, banks are resolved again after loading.
+    virtual void saveState(StateWriter& writer) const = 0;
+    virtual void loadState(StateReader& reader) = 0;
+
+    MBC(const MBC&) = delete;
+    MBC& operator=(const MBC&) = delete;
+protected:
+    MBC(std::span<const u8> ROM, std::span<u8> RAM, Banks& banks) :
+        m_ROM{ ROM }, m_RAM{ RAM }, m_banks{ banks } {}
+
+    // Bank numbers wrap around the actual ROM and RAM sizes, RAMBank < 0 disables RAM.
+    void setBanks(u32 ROMBank0, u32 ROMBankN, s32 RAMBank);
+
+    std::span<const u8> m_ROM;
+    std::span<u8> m_RAM;
+private:
+    Banks& m_banks;
+};
@@ -1,33 +1,49 @@
 #include "ppu.hpp"
+#include "shared/source/save_state.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
 
-static u32 s_colors[4]{
+static constexpr u32 COLORS[4]{
     0xFFBBDDBB,
     0xFF668866,
     0xFF335533,
     0xFF002200,
 };
 
-static u8 s_bgColorMap[4]{
-    0, 1, 2, 3
-};
+static constexpr u16 TICKS_PER_LINE = 114;
+static constexpr u16 OAM_SEARCH_TICKS = 20;
+static constexpr u16 PIXEL_TRANSFER_TICKS = 44;
+static constexpr u16 DMA_START_DELAY = 3;
+static constexpr u16 DMA_TICKS = 160;
+static constexpr u16 LINES_PER_FRAME = 154;
 
-PPU::PPU(u8& interruptFlagsRef) :
+PPU::PPU(u8& interruptFlagsRef, Scheduler& scheduler) :
     m_VRAM{ new u8[VRAM_SIZE] },
-    m_screenPixels{ new u32[LCD_WIDTH * LCD_HEIGHT] },
-    m_tileDataPixels{ new u32[TILE_DATA_WIDTH * TILE_DATA_HEIGHT] },
-    m_interruptFlagsRef{ interruptFlagsRef }
-{}
+    m_decodedTiles{ new DecodedTile[TILE_COUNT] },
+    m_frames{ std::vector<u32>(LCD_WIDTH * LCD_HEIGHT, COLORS[0]) },
+    m_interruptFlagsRef{ interruptFlagsRef },
+    m_schedulerRef{ scheduler },
+    m_tileDataPixels{ new u32[TILE_DATA_WIDTH * TILE_DATA_HEIGHT] }
+{
+    m_lineEvent = m_schedulerRef.registerEvent([this]() { endLine(); });
+    m_pixelTransferEvent = m_schedulerRef.registerEvent([this]() { startPixelTransfer(); });
+    m_VBlankEvent = m_schedulerRef.registerEvent([this]() {
+        if (m_LCDStatus.Mode == (u8)Mode::VBlank)
+            m_interruptFlagsRef |= 1;
+    });
+    m_HBlankEvent = m_schedulerRef.registerEvent([this]() { endPixelTransfer(); });
+    m_DMAStartEvent = m_schedulerRef.registerEvent([this]() { startDMA(); });
+    m_DMAEndEvent = m_schedulerRef.registerEvent([this]() { m_DMAInProgress = false; });
+}
 
 PPU::~PPU()
 {
     delete[] m_VRAM;
-
-    delete[] m_screenPixels;
+    delete[] m_decodedTiles;
 
     delete[] m_tileDataPixels;
 }
@@ -36,6 +52,8 @@ void PPU::reset()
 {
     constexpr u8 LCDCONTROL_AFTER_BOOT = 0x91;
     constexpr u8 LCDSTATUS_AFTER_BOOT = 0x82;
+    constexpr u8 BGPALETTE_AFTER_BOOT = 0xFC;
+    constexpr u8 OBJPALETTE_AFTER_BOOT = 0xFF;
 
     m_LCDControl.byte = LCDCONTROL_AFTER_BOOT;
     m_LCDStatus.byte = LCDSTATUS_AFTER_BOOT;
@@ -43,8 +61,16 @@ void PPU::reset()
     m_SCY = 0;
     m_SCX = 0;
     m_LY = 1;
+    m_LYC = 0;
     //m_LCDStatus.Mode = 2;
 
+    m_BGpaletteData = BGPALETTE_AFTER_BOOT;
+    m_OBJpalette0Data = OBJPALETTE_AFTER_BOOT;
+    m_OBJpalette1Data = OBJPALETTE_AFTER_BOOT;
+
+    m_WY = 0;
+    m_WX = 0;
+
     m_fetcherMode = 0;
     m_fetcherTileX = 0;
     m_fetcherTileY = 0;
@@ -57,56 +83,302 @@ void PPU::reset()
 
     m_currentPixelX = 0;
 
+    m_lineRenderer = getRenderer();
+    m_lineLogSize = 0;
+    m_windowLine = 0;
+
     // DMA
-    m_DMARequested = false;
+    m_DMAAddress = 0;
     m_DMAInProgress = false;
+
+    m_schedulerRef.cancel(m_VBlankEvent);
+    m_schedulerRef.cancel(m_HBlankEvent);
+    m_schedulerRef.cancel(m_DMAStartEvent);
+    m_schedulerRef.cancel(m_DMAEndEvent);
+    m_schedulerRef.scheduleIn(m_pixelTransferEvent, OAM_SEARCH_TICKS);
+    m_schedulerRef.scheduleIn(m_lineEvent, TICKS_PER_LINE);
 }
 
-void PPU::clock()
+void PPU::saveState(StateWriter& writer) const
+{
+    writer.writeBytes(m_VRAM, VRAM_SIZE);
+    writer.writeBytes(m_OAM.bytes, sizeof(m_OAM.bytes));
+    writer.write(m_LCDControl.byte);
+    writer.write(m_LCDStatus.byte);
+    writer.write(m_SCY);
+    writer.write(m_SCX);
+    writer.write(m_LY);
+    writer.write(m_LYC);
+    writer.write(m_BGpaletteData);
+    writer.write(m_OBJpalette0Data);
+    writer.write(m_OBJpalette1Data);
+    writer.write(m_WY);
+    writer.write(m_WX);
+
+    writer.write(m_fetcherMode);
+    writer.write(m_fetcherTileX);
+    writer.write(m_fetcherTileY);
+    writer.write(m_tileDataAddress);
+    writer.write(m_fetchedColorL);
+    writer.write(m_fetchedPaletteL);
+    writer.write(m_pixelFIFOEmpty);
+    writer.write(m_pixelFIFONeedFetch);
+    m_colorFIFO.saveState(writer);
+    writer.write(m_pixelFIFOPaletteL);
+    writer.write(m_pixelFIFOPaletteH);
+    writer.write(m_currentPixelX);
+
+    writer.write(m_lineRenderer);
+    writer.write(m_pixelTransferStart);
+    writer.write(m_lineRegisters.SCY);
+    writer.write(m_lineRegisters.SCX);
+    writer.write(m_lineRegisters.BGP);
+    writer.writeBytes(m_lineLog, sizeof(m_lineLog));
+    writer.write(m_lineLogSize);
+    writer.write(m_windowLine);
+
+    writer.write(m_DMAInProgress);
+    writer.write(m_DMAAddress);
+}
+
+void PPU::loadState(StateReader& reader)
+{
+    reader.readBytes(m_VRAM, VRAM_SIZE);
+    reader.readBytes(m_OAM.bytes, sizeof(m_OAM.bytes));
+    reader.read(m_LCDControl.byte);
+    reader.read(m_LCDStatus.byte);
+    reader.read(m_SCY);
+    reader.read(m_SCX);
+    reader.read(m_LY);
+    reader.read(m_LYC);
+    reader.read(m_BGpaletteData);
+    reader.read(m_OBJpalette0Data);
+    reader.read(m_OBJpalette1Data);
+    reader.read(m_WY);
+    reader.read(m_WX);
+
+    reader.read(m_fetcherMode);
+    reader.read(m_fetcherTileX);
+    reader.read(m_fetcherTileY);
+    reader.read(m_tileDataAddress);
+    reader.read(m_fetchedColorL);
+    reader.read(m_fetchedPaletteL);
+    reader.read(m_pixelFIFOEmpty);
+    reader.read(m_pixelFIFONeedFetch);
+    m_colorFIFO.loadState(reader);
+    reader.read(m_pixelFIFOPaletteL);
+    reader.read(m_pixelFIFOPaletteH);
+    reader.read(m_currentPixelX);
+
+    reader.read(m_lineRenderer);
+    reader.read(m_pixelTransferStart);
+    reader.read(m_lineRegisters.SCY);
+    reader.read(m_lineRegisters.SCX);
+    reader.read(m_lineRegisters.BGP);
+    reader.readBytes(m_lineLog, sizeof(m_lineLog));
+    reader.read(m_lineLogSize);
+    reader.read(m_windowLine);
+
+    reader.read(m_DMAInProgress);
+    reader.read(m_DMAAddress);
+
+    for (u16 tile = 0; tile < TILE_COUNT; tile++)
+        for (u8 row = 0; row < 8; row++)
+            decodeTileRow(tile, row);
+    m_areSpriteBucketsDirty = true;
+}
+
+void PPU::endLine()
+{
+    if (m_LCDStatus.Mode == (u8)Mode::HBlank) {
+        m_LCDStatus.Mode = (u8)((m_LY >= LCD_HEIGHT) ? Mode::VBlank : Mode::OAMSearch);
+        if (m_LCDStatus.Mode == (u8)Mode::VBlank)
+            m_frames.publish();
+    }
+    else if (m_LCDStatus.Mode == (u8)Mode::VBlank && m_LY >= LINES_PER_FRAME) {
+        m_LCDStatus.Mode = (u8)Mode::OAMSearch;
+        m_LY = 0;
+        m_windowLine = 0;
+    }
+
+    if (m_LY++ == m_LYC) {
+        m_LCDStatus.LYCEqLY = 1;
+        if (m_LCDStatus.STATSource & 0b1000)
+            m_interruptFlagsRef |= 2;
+    }
+
+    if (m_LCDStatus.Mode == (u8)Mode::OAMSearch)
+        m_schedulerRef.scheduleIn(m_pixelTransferEvent, OAM_SEARCH_TICKS);
+    if (m_LCDStatus.Mode == (u8)Mode::VBlank && m_LY == LCD_HEIGHT + 1)
+        m_schedulerRef.scheduleIn(m_VBlankEvent, 1);
+    m_schedulerRef.scheduleIn(m_lineEvent, TICKS_PER_LINE);
+}
+
+void PPU::startPixelTransfer()
+{
+    if (m_LCDStatus.Mode != (u8)Mode::OAMSearch)
+        return;
+
+    m_LCDStatus.Mode = (u8)Mode::PixelTransfer;
+    m_lineRenderer = getRenderer();
+    if (m_lineRenderer == Renderer::Scanline) {
+        m_pixelTransferStart = m_schedulerRef.getNow();
+        m_lineRegisters = { m_SCY, m_SCX, m_BGpaletteData };
+        m_lineLogSize = 0;
+        m_schedulerRef.scheduleIn(m_HBlankEvent, PIXEL_TRANSFER_TICKS);
+    }
+}
+
+void PPU::endPixelTransfer()
+{
+    if (m_LCDStatus.Mode != (u8)Mode::PixelTransfer)
+        return;
+
+    renderLine();
+    m_LCDStatus.Mode = (u8)Mode::HBlank;
+}
+
+void PPU::logRegisterWrite(u8 address, u8 data)
+{
+    // FIFO spends first 4 cycles fetching and then outputs 4 pixels per cycle.
+    s64 x = ((s64)(m_schedulerRef.getNow() - m_pixelTransferStart) - 4) * 4;
+    RegisterWrite write{ (u8)std::clamp<s64>(x, 0, LCD_WIDTH), address, data };
+
+    // Raster effects write a few registers per line at most, overflowing writes replace the last one.
+    if (m_lineLogSize < LINE_LOG_SIZE)
+        m_lineLogSize++;
+    m_lineLog[m_lineLogSize - 1] = write;
+}
+
+u8 PPU::getTilePixel(u16 tileMapAddress, u8 x, u8 y) const
 {
-    constexpr u16 TICKS_PER_LINE = 114;
-    constexpr u16 LINES_PER_FRAME = 154;
-    static u16 ticks = 0;
-    ticks++;
-
-    auto checkForLYC = [&]() {
-        if (m_LY++ == m_LYC) {
-            m_LCDStatus.LYCEqLY = 1;
-            if (m_LCDStatus.STATSource & 0b1000)
-                m_interruptFlagsRef |= 2;
+    u8 tile = m_VRAM[tileMapAddress + (y / 8) * 32 + x / 8];
+    return m_decodedTiles[m_LCDControl.WinBGTileData ? tile : 0x100 + (s8)tile].rows[y % 8][x % 8];
+}
+
+void PPU::renderLine()
+{
+    u8 row = m_LY - 1;
+    u32* pixels = m_frames.getWriteBuffer().data() + row * LCD_WIDTH;
+    u8 colors[LCD_WIDTH]; // before palette, sprites need them for priority
+
+    u16 bgTileMap = m_LCDControl.BGTileMap ? 0x1C00 : 0x1800;
+    u16 winTileMap = m_LCDControl.WinTileMap ? 0x1C00 : 0x1800;
+    bool isWindowVisible = m_LCDControl.WinBGEnable && m_LCDControl.WinEnable && row >= m_WY && m_WX <= 166;
+    u8 windowStart = isWindowVisible ? (u8)std::max(m_WX - 7, 0) : LCD_WIDTH;
+
+    LineRegisters registers = m_lineRegisters;
+    u8 logIndex = 0;
+    for (u8 x = 0; x < LCD_WIDTH; x++) {
+        while (logIndex < m_lineLogSize && m_lineLog[logIndex].x <= x) {
+            const RegisterWrite& write = m_lineLog[logIndex++];
+            switch (write.address)
+            {
+            case 0x2: registers.SCY = write.data; break;
+            case 0x3: registers.SCX = write.data; break;
+            case 0x7: registers.BGP = write.data; break;
+            }
         }
-    };
 
-    switch ((Mode)m_LCDStatus.Mode)
-    {
-    case Mode::HBlank:
-        if (ticks >= TICKS_PER_LINE)
-        {
-            ticks = 0;
-            m_LCDStatus.Mode = (u8)((m_LY >= LCD_HEIGHT) ? Mode::VBlank : Mode::OAMSearch);
+        u8 color = 0;
+        if (x >= windowStart)
+            color = getTilePixel(winTileMap, (u8)(x + 7 - m_WX), m_windowLine);
+        else if (m_LCDControl.WinBGEnable)
+            color = getTilePixel(bgTileMap, (u8)(x + registers.SCX), (u8)(row + registers.SCY));
+
+        colors[x] = color;
+        pixels[x] = COLORS[(registers.BGP >> (color * 2)) & 0b11];
+    }
+
+    if (isWindowVisible)
+        m_windowLine++;
 
-            checkForLYC();
+    if (m_LCDControl.OBJEnable)
+        renderSprites(row, pixels, colors);
+}
+
+void PPU::buildSpriteBuckets()
+{
+    u8 height = m_LCDControl.OBJSize ? 16 : 8;
+    std::memset(m_spriteBucketSizes, 0, sizeof(m_spriteBucketSizes));
+
+    // OAM order decides which sprites fit in the limit.
+    for (u8 index = 0; index < 40; index++) {
+        int top = m_OAM.entries[index].YPosition - 16;
+        int bottom = std::min(top + height, (int)LCD_HEIGHT);
+        for (int row = std::max(top, 0); row < bottom; row++) {
+            u8& size = m_spriteBucketSizes[row];
+            if (size < MAX_SPRITES_PER_LINE)
+                m_spriteBuckets[row][size++] = index;
         }
-        break;
-    case Mode::VBlank:
-        if (m_LY == LCD_HEIGHT + 1 && ticks == 1) {
-            m_interruptFlagsRef |= 1;
+    }
+
+    // Then lower X wins and ties go to the lower OAM index, insertion sort keeps that order.
+    for (u8 row = 0; row < LCD_HEIGHT; row++) {
+        u8* bucket = m_spriteBuckets[row];
+        for (u8 i = 1; i < m_spriteBucketSizes[row]; i++) {
+            u8 index = bucket[i];
+            u8 x = m_OAM.entries[index].XPosition;
+            u8 j = i;
+            for (; j > 0 && m_OAM.entries[bucket[j - 1]].XPosition > x; j--)
+                bucket[j] = bucket[j - 1];
+            bucket[j] = index;
         }
-        if (ticks >= TICKS_PER_LINE)
-        {
-            ticks = 0;
-            if (m_LY >= LINES_PER_FRAME) {
-                m_LCDStatus.Mode = (u8)Mode::OAMSearch;
-                m_LY = 0;
-            }
+    }
+
+    m_areSpriteBucketsDirty = false;
+}
+
+void PPU::renderSprites(u8 row, u32* pixels, const u8* colors)
+{
+    if (m_areSpriteBucketsDirty)
+        buildSpriteBuckets();
 
-            checkForLYC();
+    u8 height = m_LCDControl.OBJSize ? 16 : 8;
+    const u32 palettes[2][4]{
+        { COLORS[m_OBJpalette0Data & 3], COLORS[(m_OBJpalette0Data >> 2) & 3], COLORS[(m_OBJpalette0Data >> 4) & 3], COLORS[m_OBJpalette0Data >> 6] },
+        { COLORS[m_OBJpalette1Data & 3], COLORS[(m_OBJpalette1Data >> 2) & 3], COLORS[(m_OBJpalette1Data >> 4) & 3], COLORS[m_OBJpalette1Data >> 6] }
+    };
+
+    // Pixel of a sprite hidden behind background still hides sprites of lower priority.
+    bool isTaken[LCD_WIDTH]{};
+    for (u8 i = 0; i < m_spriteBucketSizes[row]; i++) {
+        const OAMEntry& sprite = m_OAM.entries[m_spriteBuckets[row][i]];
+        u8 line = row + 16 - sprite.YPosition;
+        if (sprite.Flags.yFlip) line = height - 1 - line;
+
+        u8 tile = (height == 16 ? sprite.TileIndex & 0xFE : sprite.TileIndex) + line / 8;
+        const u8* spriteColors = m_decodedTiles[tile].rows[line % 8];
+        const u32* palette = palettes[sprite.Flags.paletteNumber];
+        bool isBehindBG = sprite.Flags.OBJPriority;
+
+        // Clip to the screen once, so the pixel loop has no bounds checks.
+        int left = sprite.XPosition - 8;
+        int first = std::max(-left, 0);
+        int last = std::min(LCD_WIDTH - left, 8);
+        int step = sprite.Flags.xFlip ? -1 : 1;
+        const u8* source = spriteColors + (sprite.Flags.xFlip ? 7 - first : first);
+        for (int pixel = first; pixel < last; pixel++, source += step) {
+            int x = left + pixel;
+            u8 color = *source;
+            if (color == 0 || isTaken[x]) continue;
+
+            isTaken[x] = true;
+            if (!isBehindBG || colors[x] == 0)
+                pixels[x] = palette[color];
         }
-        break;
-    case Mode::OAMSearch:
-        if (ticks >= 20)
-            m_LCDStatus.Mode = (u8)Mode::PixelTransfer;
-        break;
+    }
+}
+
+u32 PPU::getBGColor(u8 color) const
+{
+    return COLORS[(m_BGpaletteData >> (color * 2)) & 0b11];
+}
+
+void PPU::clock()
+{
+    switch ((Mode)m_LCDStatus.Mode)
+    {
     case Mode::PixelTransfer:
         if (!m_pixelFIFONeedFetch) {
             u8 pixelsPerCycle = 4;
@@ -117,12 +389,10 @@ void PPU::clock()
                 m_pixelFIFOPaletteH <<= 1;
                 u8 color = m_colorFIFO.pop();
                 //u8 palette = (paletteH << 1) | paletteL;
-                m_screenPixels[(m_LY - 1) * LCD_WIDTH + m_currentPixelX++] = paletteL ? s_colors[s_bgColorMap[color]] : s_colors[s_bgColorMap[0]];
+                m_frames.getWriteBuffer()[(m_LY - 1) * LCD_WIDTH + m_currentPixelX++] = getBGColor(paletteL ? color : 0);
             }
         }
 
-        static u8 fetchedColorL = 0;
-        static u8 fetchedPaletteL = 0;
         switch (m_fetcherMode)
         {
         case 0: {
@@ -130,13 +400,13 @@ void PPU::clock()
             u16 tileAddressBase = m_LCDControl.BGTileMap ? 0x1C00 : 0x1800;
             u8 tile = m_VRAM[tileAddressBase + tileIndex];
             m_tileDataAddress = (m_LCDControl.WinBGTileData ? tile : 0x100 + (s8)tile) * 16;
-            fetchedColorL = m_VRAM[m_tileDataAddress + ((m_SCY + m_LY - 1) % 8) * 2];
-            fetchedPaletteL = m_LCDControl.WinBGEnable ? 0xFF : 0x00; // temp cause only one palette
+            m_fetchedColorL = m_VRAM[m_tileDataAddress + ((m_SCY + m_LY - 1) % 8) * 2];
+            m_fetchedPaletteL = m_LCDControl.WinBGEnable ? 0xFF : 0x00; // temp cause only one palette
             m_fetcherMode = 1;
         } break;
         case 1: {
-            m_colorFIFO.push(fetchedColorL, m_VRAM[m_tileDataAddress + 1 + ((m_SCY + m_LY - 1) % 8) * 2]);
-            m_pixelFIFOPaletteL |= fetchedPaletteL << (m_pixelFIFOEmpty ? 8 : 0);
+            m_colorFIFO.push(m_fetchedColorL, m_VRAM[m_tileDataAddress + 1 + ((m_SCY + m_LY - 1) % 8) * 2]);
+            m_pixelFIFOPaletteL |= m_fetchedPaletteL << (m_pixelFIFOEmpty ? 8 : 0);
             m_pixelFIFOPaletteH |= 0; // temp cause only one palette
 
             if (!m_pixelFIFOEmpty) m_pixelFIFONeedFetch = false;
@@ -161,17 +431,15 @@ void PPU::clock()
             m_LCDStatus.Mode = 0;
         }
         break;
+    default:
+        break;
     }
-
-    handleDMA();
 }
 
 void PPU::clearVRAM()
 {
     std::memset(m_VRAM, 0, VRAM_SIZE);
-
-    // debug:
-    redrawTileData();
+    std::memset(m_decodedTiles, 0, TILE_COUNT * sizeof(DecodedTile));
 }
 
 u8 PPU::loadVRAM8(u16 address) const
@@ -183,11 +451,18 @@ void PPU::storeVRAM8(u16 address, u8 data)
 {
     m_VRAM[address] = data;
 
-    // debug:
-    if (address < 0x1800) {
-        u16 x = (address / 16u) % 16;
-        u16 y = (address / 16u) / 16;
-        redrawTileData((u8)x, (u8)y, 1, 1);
+    if (address < TILE_COUNT * 16)
+        decodeTileRow(address / 16, (address % 16) / 2);
+}
+
+void PPU::decodeTileRow(u16 tile, u8 row)
+{
+    u8 low = m_VRAM[tile * 16 + row * 2];
+    u8 high = m_VRAM[tile * 16 + row * 2 + 1];
+    u8* colors = m_decodedTiles[tile].rows[row];
+    for (u8 x = 0; x < 8; x++) {
+        u8 bit = 7 - x;
+        colors[x] = (((high >> bit) & 1) << 1) | ((low >> bit) & 1);
     }
 }
 
@@ -198,8 +473,10 @@ u8 PPU::loadOAM8(u16 address) const
 
 void PPU::storeOAM8(u16 address, u8 data)
 {
-    if (!m_DMAInProgress)
+    if (!m_DMAInProgress) {
         m_OAM.bytes[address] = data;
+        m_areSpriteBucketsDirty = true;
+    }
 }
 
 u8 PPU::load8(u16 address) const
@@ -226,9 +503,17 @@ u8 PPU::load8(u16 address) const
 
 void PPU::store8(u16 address, u8 data)
 {
+    if (m_LCDStatus.Mode == (u8)Mode::PixelTransfer && m_lineRenderer == Renderer::Scanline &&
+        (address == 0x2 || address == 0x3 || address == 0x7))
+        logRegisterWrite((u8)address, data);
+
     switch (address)
     {
-    case 0x0: m_LCDControl.byte = data; return;
+    case 0x0:
+        if ((m_LCDControl.byte ^ data) & 0b100)
+            m_areSpriteBucketsDirty = true;
+        m_LCDControl.byte = data;
+        return;
     case 0x1:
         m_LCDStatus.byte &= 0x87;
         m_LCDStatus.byte |= data & 0x78;
@@ -239,19 +524,12 @@ void PPU::store8(u16 address, u8 data)
     case 0x5: m_LYC = data; return;
     case 0x6: {
         m_DMAAddress = data;
-        m_DMARequested = true;
+        // Restarted transfer keeps OAM locked until the new one takes over.
+        m_schedulerRef.cancel(m_DMAEndEvent);
+        m_schedulerRef.scheduleIn(m_DMAStartEvent, DMA_START_DELAY);
         return;
     }
-    case 0x7:
-        m_BGpaletteData = data;
-        s_bgColorMap[0] = (m_BGpaletteData >> 0) & 0b11;
-        s_bgColorMap[1] = (m_BGpaletteData >> 2) & 0b11;
-        s_bgColorMap[2] = (m_BGpaletteData >> 4) & 0b11;
-        s_bgColorMap[3] = (m_BGpaletteData >> 6) & 0b11;
-
-        // debug:
-        redrawTileData();
-        return;
+    case 0x7: m_BGpaletteData = data; return;
     case 0x8: m_OBJpalette0Data = data; return;
     case 0x9: m_OBJpalette1Data = data; return;
     case 0xA: m_WY = data; return;
@@ -262,49 +540,30 @@ void PPU::store8(u16 address, u8 data)
     std::cerr << ':' << std::hex << std::setw(2) << (u16)data << '\n';
 }
 
-void PPU::handleDMA()
+void PPU::startDMA()
 {
-    static u8 ticks = 0;
-    if (ticks > 0)
-    ticks--;
-
-    if (m_DMARequested)
-    {
-        m_DMARequested = false;
-        ticks = 162;
-    }
-
-    if (ticks == 160) m_DMAInProgress = true;
-    if (ticks == 0) m_DMAInProgress = false;
-
-    if (m_DMAInProgress)
-    {
-        u8 index = 160 - ticks;
-        u16 srcAddress = (m_DMAAddress << 8) | index;
-        m_OAM.bytes[index] = loadExternal8(srcAddress);
-
-    }
+    // Whole transfer happens at once, CPU can't see OAM until it would have ended anyway.
+    m_DMAInProgress = true;
+    u16 source = m_DMAAddress << 8;
+    const u8* memory = getExternalPointer ? getExternalPointer(source) : nullptr;
+    if (memory)
+        std::memcpy(m_OAM.bytes, memory, sizeof(m_OAM.bytes));
+    else
+        for (u8 i = 0; i < sizeof(m_OAM.bytes); i++)
+            m_OAM.bytes[i] = loadExternal8(source | i);
+
+    m_areSpriteBucketsDirty = true;
+    m_schedulerRef.scheduleIn(m_DMAEndEvent, DMA_TICKS);
 }
 
-void PPU::redrawTileData(u8 xOffset, u8 yOffset, u8 width, u8 height)
+std::span<u32> PPU::getTileDataPixels()
 {
-    assert(xOffset + width <= 16);
-    assert(yOffset + height <= 24);
-
-    for (u8 y = yOffset; y < height + yOffset; y++)
-        for (u8 x = xOffset; x < width + xOffset; x++)
-        {
-            u16 address = y * 256 + x * 16;
-            for (u8 tileY = 0; tileY < 16; tileY += 2) {
-                u8 b1 = m_VRAM[address + tileY];
-                u8 b2 = m_VRAM[address + tileY + 1];
-                for (s8 bit = 7; bit >= 0; bit--) {
-                    u8 color = (((b2 >> bit) & 1) << 1) | ((b1 >> bit) & 1);
-                    u16 x_coord = x * 8 + 7 - bit;
-                    u16 y_coord = y * 8 + tileY / 2;
-                    u16 line_width = 16 * 8;
-                    m_tileDataPixels[y_coord * line_width + x_coord] = s_colors[s_bgColorMap[color]];
-                }
-            }
+    for (u16 tile = 0; tile < TILE_COUNT; tile++)
+        for (u8 row = 0; row < 8; row++) {
+            u32* pixels = m_tileDataPixels + ((tile / 16) * 8 + row) * TILE_DATA_WIDTH + (tile % 16) * 8;
+            for (u8 x = 0; x < 8; x++)
+                pixels[x] = getBGColor(m_decodedTiles[tile].rows[row][x]);
         }
+
+    return { m_tileDataPixels, TILE_DATA_WIDTH * TILE_DATA_HEIGHT };
 }
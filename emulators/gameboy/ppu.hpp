@@ -1,12 +1,18 @@
 #pragma once
 #include "bit_fifo.hpp"
+#include "shared/source/scheduler.hpp"
+#include "shared/source/triple_buffer.hpp"
 
+#include <atomic>
 #include <functional>
 #include <span>
+#include <vector>
 
 namespace glw {
 	class Texture;
 }
+class StateWriter;
+class StateReader;
 
 class PPU
 {
@@ -14,30 +20,52 @@ public:
 	static constexpr u16 LCD_WIDTH = 160;
 	static constexpr u16 LCD_HEIGHT = 144;
 
-	explicit PPU(u8& interruptFlagsRef);
+	// Scanline draws a whole line with background, window and sprites when pixel transfer ends,
+	// SCX, SCY and BGP writes made during it are logged and applied from the pixel they hit.
+	// PixelFIFO emulates the fetcher every cycle, it only draws the background.
+	enum class Renderer : u8 { Scanline, PixelFIFO };
+
+	PPU(u8& interruptFlagsRef, Scheduler& scheduler);
 	~PPU();
 
 	using ReadMemoryCallback = std::function<u8(u16)>;
 	void mapReadExternalMemoryCallback(ReadMemoryCallback callback) { loadExternal8 = callback; }
+	// Host memory behind an address or nullptr, lets DMA copy a whole page source at once.
+	using MemoryPointerCallback = std::function<const u8*(u16)>;
+	void mapExternalMemoryPointerCallback(MemoryPointerCallback callback) { getExternalPointer = callback; }
 
 	void reset();
+	// Mode changes and DMA are scheduled, PPU has to be clocked only while FIFO is drawing.
 	void clock();
+	bool isClockNeeded() const { return m_LCDStatus.Mode == (u8)Mode::PixelTransfer && m_lineRenderer == Renderer::PixelFIFO; }
+	// Can be called from any thread, takes effect from the next line.
+	void setRenderer(Renderer renderer) { m_renderer.store(renderer, std::memory_order_relaxed); }
+	Renderer getRenderer() const { return m_renderer.load(std::memory_order_relaxed); }
 
 	void clearVRAM();
 	u8 loadVRAM8(u16 address) const;
+	const u8* getVRAM() const { return m_VRAM; }
 	void storeVRAM8(u16 address, u8 data);
 	u8 loadOAM8(u16 address) const;
 	void storeOAM8(u16 address, u8 data);
 	u8 load8(u16 address) const;
 	void store8(u16 address, u8 data);
 	ReadMemoryCallback loadExternal8 = nullptr;
+	MemoryPointerCallback getExternalPointer = nullptr;
+
+	// Mode change events are part of the scheduler state, published frames are not saved.
+	void saveState(StateWriter& writer) const;
+	void loadState(StateReader& reader);
 
-	std::span<const u32> getScreenPixels() const { return { m_screenPixels, LCD_WIDTH * LCD_HEIGHT }; }
+	// Frame is published on VBlank, these can be called from a different thread than the one clocking the PPU.
+	std::span<const u32> acquireScreenPixels() { return m_frames.acquire(); }
+	u64 getScreenSequence() const { return m_frames.getSequence(); }
 
 	// debug:
 	static constexpr u16 TILE_DATA_WIDTH = 16 * 8;
 	static constexpr u16 TILE_DATA_HEIGHT = 24 * 8;
-	std::span<u32> getTileDataPixels() const { return { m_tileDataPixels, TILE_DATA_WIDTH * TILE_DATA_HEIGHT }; }
+	// Redrawn from decoded tiles on every call, emulation doesn't spend time on it while nobody looks.
+	std::span<u32> getTileDataPixels();
 	std::span<u8> getTileMap0() const { return { m_VRAM + 0x1800, 0x400 }; }
 	std::span<u8> getTileMap1() const { return { m_VRAM + 0x1C00, 0x400 }; }
 	bool getTileDataAddressingMode() const { return m_LCDControl.WinBGTileData; }
@@ -65,6 +93,16 @@ private:
 	static_assert(sizeof(OAMEntry) == 4);
 
 	u8* m_VRAM;
+
+	// Tile data part of VRAM expanded to one color index per byte, rows are updated on every write.
+	static constexpr u16 TILE_COUNT = 384;
+	struct alignas(64) DecodedTile {
+		u8 rows[8][8];
+	};
+	static_assert(sizeof(DecodedTile) == 64);
+	void decodeTileRow(u16 tile, u8 row);
+	DecodedTile* m_decodedTiles;
+
 	union {
 		OAMEntry entries[40];
 		u8 bytes[160];
@@ -112,6 +150,8 @@ private:
 	u8 m_fetcherTileX;
 	u8 m_fetcherTileY;
 	u16 m_tileDataAddress;
+	u8 m_fetchedColorL = 0;
+	u8 m_fetchedPaletteL = 0;
 	bool m_pixelFIFOEmpty;
 	bool m_pixelFIFONeedFetch;
 	BitFIFO m_colorFIFO;
@@ -119,17 +159,61 @@ private:
 	u16 m_pixelFIFOPaletteH;
 	u8 m_currentPixelX;
 
-	u32* m_screenPixels;
+	// scanline renderer:
+	struct LineRegisters {
+		u8 SCY;
+		u8 SCX;
+		u8 BGP;
+	};
+	struct RegisterWrite {
+		u8 x;       // first pixel drawn with the new value
+		u8 address; // PPU register offset
+		u8 data;
+	};
+	static constexpr u8 LINE_LOG_SIZE = 32;
+
+	void startPixelTransfer();
+	void endPixelTransfer();
+	void logRegisterWrite(u8 address, u8 data);
+	void renderLine();
+	void buildSpriteBuckets();
+	void renderSprites(u8 row, u32* pixels, const u8* colors);
+	u8 getTilePixel(u16 tileMapAddress, u8 x, u8 y) const;
+
+	std::atomic<Renderer> m_renderer = Renderer::Scanline;
+	Renderer m_lineRenderer = Renderer::Scanline; // latched when pixel transfer starts
+	u64 m_pixelTransferStart = 0;
+	LineRegisters m_lineRegisters{};
+	RegisterWrite m_lineLog[LINE_LOG_SIZE];
+	u8 m_lineLogSize = 0;
+	u8 m_windowLine = 0;
+
+	// Sprites visible on every line in drawing priority order, rebuilt after OAM or sprite size changes.
+	static constexpr u8 MAX_SPRITES_PER_LINE = 10;
+	u8 m_spriteBuckets[LCD_HEIGHT][MAX_SPRITES_PER_LINE];
+	u8 m_spriteBucketSizes[LCD_HEIGHT];
+	bool m_areSpriteBucketsDirty = true;
+
+	TripleBuffer<std::vector<u32>> m_frames;
 	u8& m_interruptFlagsRef;
 
+	void endLine();
+	u32 getBGColor(u8 color) const;
+
+	Scheduler& m_schedulerRef;
+	Scheduler::EventID m_lineEvent;
+	Scheduler::EventID m_pixelTransferEvent;
+	Scheduler::EventID m_VBlankEvent;
+	Scheduler::EventID m_HBlankEvent;
+	Scheduler::EventID m_DMAStartEvent;
+	Scheduler::EventID m_DMAEndEvent;
+
 	// DMA
-	void handleDMA();
+	void startDMA();
 
-	bool m_DMARequested;
 	bool m_DMAInProgress;
 	u8 m_DMAAddress;
 
 	// debug:
-	void redrawTileData(u8 xOffset = 0, u8 yOffset = 0, u8 width = 16, u8 height = 24);
 	u32* m_tileDataPixels;
 };
@@ -0,0 +1,38 @@
+#include "../batch_runner.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(BatchRunnerTests, givenParallelJobsExpectSameResultsAsSingleJob)
+{
+	const char* roms[] = {
+		"test_files/gameboy/mooneye/timer/tim00.gb",
+		"test_files/gameboy/mooneye/timer/tim01.gb",
+		"test_files/gameboy/mooneye/timer/tima_write_reloading.gb",
+	};
+
+	std::vector<BatchJob> jobs;
+	for (int copy = 0; copy < 2; copy++)
+		for (const char* rom : roms) {
+			BatchJob& job = jobs.emplace_back();
+			job.romPath = rom;
+			job.cycles = 1000000;
+		}
+
+	std::vector<BatchJob> single{ jobs[2] };
+	runBatch(single, 1);
+	runBatch(jobs, 4);
+
+	for (size_t i = 0; i < jobs.size(); i++) {
+		ASSERT_TRUE(jobs[i].isLoaded) << jobs[i].romPath;
+		EXPECT_EQ(jobs[i].cyclesRun, jobs[i % 3].cyclesRun);
+		EXPECT_EQ(jobs[i].serialOutput, jobs[i % 3].serialOutput);
+		EXPECT_EQ(jobs[i].hasMooneyePassed, jobs[i % 3].hasMooneyePassed);
+	}
+
+	EXPECT_TRUE(jobs[0].hasMooneyePassed);
+	EXPECT_TRUE(jobs[1].hasMooneyePassed);
+	EXPECT_EQ(jobs[2].serialOutput, single[0].serialOutput);
+	EXPECT_FALSE(jobs[2].serialOutput.empty());
+}
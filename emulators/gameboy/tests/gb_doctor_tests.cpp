@@ -0,0 +1,59 @@
+#include "../gameboy.hpp"
+#include "../gb_doctor.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+struct GBDoctorTests :
+	public testing::Test
+{
+	std::string filename = (std::filesystem::temp_directory_path() / "gb_doctor_tests.gbdt").string();
+	GBDoctorTrace trace;
+
+	void TearDown() override
+	{
+		trace.close();
+		std::remove(filename.c_str());
+	}
+};
+
+TEST_F(GBDoctorTests, givenRecordsExpectGameboyDoctorLines)
+{
+	ASSERT_TRUE(trace.open(filename.c_str()));
+	trace.record({ 100, 0x01, 0xB0, 0x00, 0x13, 0x00, 0xD8, 0x01, 0x4D, 0xFFFE, 0x0100, { 0x00, 0xC3, 0x37, 0x06 } });
+	trace.record({ 104, 0x01, 0xB0, 0x00, 0x13, 0x00, 0xD8, 0x01, 0x4D, 0xFFFE, 0x0101, { 0xC3, 0x37, 0x06, 0xCD } });
+	trace.record({ 20, 0xFF, 0x00, 0x00, 0x13, 0x00, 0xD8, 0x01, 0x4D, 0xDFFF, 0x0637, { 0xAF, 0x00, 0x00, 0x00 } });
+	trace.close();
+
+	std::ostringstream log;
+	ASSERT_TRUE(convertGBDoctorTrace(filename.c_str(), log));
+	EXPECT_EQ(log.str(),
+		"A:01 F:B0 B:00 C:13 D:00 E:D8 H:01 L:4D SP:FFFE PC:0100 PCMEM:00,C3,37,06\n"
+		"A:01 F:B0 B:00 C:13 D:00 E:D8 H:01 L:4D SP:FFFE PC:0101 PCMEM:C3,37,06,CD\n"
+		"A:FF F:00 B:00 C:13 D:00 E:D8 H:01 L:4D SP:DFFF PC:0637 PCMEM:AF,00,00,00\n");
+}
+
+TEST_F(GBDoctorTests, givenTracedRunExpectLinePerInstruction)
+{
+	Gameboy gb;
+	ASSERT_TRUE(gb.loadCartridge("test_files/gameboy/mooneye/timer/tim00.gb", true));
+	gb.reset();
+
+	ASSERT_TRUE(trace.open(filename.c_str()));
+	gb.setTrace(&trace);
+	u32 instructions = 0;
+	for (u32 cycles = 0; cycles < 20000; instructions++)
+		cycles += gb.runInstruction();
+	trace.close();
+
+	std::ostringstream log;
+	ASSERT_TRUE(convertGBDoctorTrace(filename.c_str(), log));
+	std::string text = log.str();
+	EXPECT_EQ(text.rfind("A:01 F:B0 B:00 C:13 D:00 E:D8 H:01 L:4D SP:FFFE PC:0100 PCMEM:", 0), 0u);
+	EXPECT_EQ((u32)std::count(text.begin(), text.end(), '\n'), instructions);
+}
@@ -0,0 +1,104 @@
+#include "../mbc.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+struct MBCTests :
+	public testing::Test
+{
+	std::vector<u8> ROM;
+	std::vector<u8> RAM;
+	MBC::Banks banks;
+	std::unique_ptr<MBC> mbc;
+
+	// Every ROM bank starts with its number.
+	void create(u8 cartridgeTypeCode, u16 ROMBanks, size_t headerRAMSize)
+	{
+		ROM.assign(ROMBanks * 0x4000, 0);
+		for (u16 bank = 0; bank < ROMBanks; bank++) {
+			ROM[bank * 0x4000] = (u8)bank;
+			ROM[bank * 0x4000 + 1] = (u8)(bank >> 8);
+		}
+		RAM.assign(MBC::getRAMSize(cartridgeTypeCode, headerRAMSize), 0);
+		mbc = MBC::create(cartridgeTypeCode, ROM, RAM, banks);
+		ASSERT_NE(mbc, nullptr);
+	}
+
+	u16 getROMBankN() const { return banks.ROMN[0] | (banks.ROMN[1] << 8); }
+};
+
+TEST_F(MBCTests, givenMBC1ExpectBankZeroRemappedAndUpperBitsApplied)
+{
+	create(0x03, 128, 0x8000);
+	EXPECT_EQ(banks.ROM0[0], 0);
+	EXPECT_EQ(getROMBankN(), 1);
+	EXPECT_EQ(banks.RAM, nullptr);
+
+	mbc->store8(0x2000, 0x00);
+	EXPECT_EQ(getROMBankN(), 1);
+	mbc->store8(0x2000, 0x25); // upper bits are ignored
+	EXPECT_EQ(getROMBankN(), 5);
+	mbc->store8(0x4000, 0x02);
+	EXPECT_EQ(getROMBankN(), 0x45);
+	EXPECT_EQ(banks.ROM0[0], 0);
+
+	mbc->store8(0x0000, 0x0A);
+	mbc->store8(0x6000, 0x01);
+	EXPECT_EQ(banks.ROM0[0], 0x40);
+	EXPECT_EQ(banks.RAM, RAM.data() + 2 * 0x2000);
+}
+
+TEST_F(MBCTests, givenMBC2ExpectHalfByteRAMMirrored)
+{
+	create(0x06, 16, 0);
+	mbc->store8(0x0100, 0x03); // address bit 8 selects ROM bank register
+	EXPECT_EQ(getROMBankN(), 3);
+
+	EXPECT_EQ(mbc->load8ExtRAM(0x0000), 0xFF);
+	mbc->store8(0x0000, 0x0A);
+	mbc->store8ExtRAM(0x0005, 0xAB);
+	EXPECT_EQ(mbc->load8ExtRAM(0x0205), 0xFB);
+	EXPECT_EQ(banks.RAM, nullptr);
+}
+
+TEST_F(MBCTests, givenMBC3ExpectRTCRegistersInPlaceOfRAMBanks)
+{
+	create(0x10, 128, 0x8000);
+	mbc->store8(0x2000, 0x7F);
+	EXPECT_EQ(getROMBankN(), 0x7F);
+
+	mbc->store8(0x0000, 0x0A);
+	mbc->store8(0x4000, 0x03);
+	EXPECT_EQ(banks.RAM, RAM.data() + 3 * 0x2000);
+
+	// halted clock keeps written time
+	mbc->store8(0x4000, 0x0C);
+	EXPECT_EQ(banks.RAM, nullptr);
+	mbc->store8ExtRAM(0, 0x41);
+	mbc->store8(0x4000, 0x0A);
+	mbc->store8ExtRAM(0, 23);
+	mbc->store8(0x4000, 0x08);
+	mbc->store8ExtRAM(0, 0);
+	mbc->store8(0x6000, 0x00);
+	mbc->store8(0x6000, 0x01);
+	EXPECT_EQ(mbc->load8ExtRAM(0), 0);
+	mbc->store8(0x4000, 0x0A);
+	EXPECT_EQ(mbc->load8ExtRAM(0), 23);
+	mbc->store8(0x4000, 0x0C);
+	EXPECT_EQ(mbc->load8ExtRAM(0), 0x41);
+}
+
+TEST_F(MBCTests, givenMBC5ExpectNineBitROMBankAndBankZero)
+{
+	create(0x1B, 512, 0x20000);
+	mbc->store8(0x2000, 0x00);
+	EXPECT_EQ(getROMBankN(), 0);
+	mbc->store8(0x2000, 0x34);
+	mbc->store8(0x3000, 0x01);
+	EXPECT_EQ(getROMBankN(), 0x134);
+
+	mbc->store8(0x0000, 0x0A);
+	mbc->store8(0x4000, 0x0F);
+	EXPECT_EQ(banks.RAM, RAM.data() + 15 * 0x2000);
+}
@@ -0,0 +1,163 @@
+#include "../ppu.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+struct PPUTests :
+	public testing::Test
+{
+	static constexpr u64 TICKS_PER_LINE = 114;
+	static constexpr u64 OAM_SEARCH_TICKS = 20;
+
+	Scheduler scheduler;
+	u8 interruptFlags = 0;
+	PPU ppu{ interruptFlags, scheduler };
+
+	void SetUp() override
+	{
+		ppu.clearVRAM();
+		ppu.reset();
+		ppu.store8(0x7, 0b11100100); // BGP maps colors to themselves
+		for (u16 i = 0; i < 160; i++)
+			ppu.storeOAM8(i, 0);
+
+		// tile 1 is solid color 3, background columns alternate between tiles 0 and 1
+		for (u16 i = 0; i < 16; i++)
+			ppu.storeVRAM8(16 + i, 0xFF);
+		for (u16 i = 0; i < 0x400; i++)
+			ppu.storeVRAM8(0x1800 + i, i % 2);
+	}
+
+	// Runs until VBlank interrupt, onTick is called before every tick.
+	std::vector<u32> runFrame(const std::function<void(u64)>& onTick = nullptr)
+	{
+		u64 start = scheduler.getNow();
+		interruptFlags = 0;
+		while ((interruptFlags & 1) == 0) {
+			if (onTick) onTick(scheduler.getNow() - start);
+			if (ppu.isClockNeeded()) ppu.clock();
+			scheduler.advance(1);
+		}
+
+		auto pixels = ppu.acquireScreenPixels();
+		return { pixels.begin(), pixels.end() };
+	}
+
+	u32 pixel(const std::vector<u32>& frame, u16 x, u16 y) { return frame[y * PPU::LCD_WIDTH + x]; }
+};
+
+TEST_F(PPUTests, givenStaticBackgroundExpectScanlineSameAsPixelFIFO)
+{
+	ppu.setRenderer(PPU::Renderer::PixelFIFO);
+	auto expected = runFrame();
+	ppu.setRenderer(PPU::Renderer::Scanline);
+	runFrame(); // first line of this frame was latched during the previous one
+	auto actual = runFrame();
+
+	EXPECT_NE(pixel(actual, 0, 0), pixel(actual, 8, 0));
+	EXPECT_EQ(expected, actual);
+}
+
+TEST_F(PPUTests, givenSCXWriteDuringPixelTransferExpectChangeFromThatPixel)
+{
+	constexpr u8 ROW = 10;
+	auto frame = runFrame([this](u64 tick) {
+		if (tick == ROW * TICKS_PER_LINE + OAM_SEARCH_TICKS + 24) {
+			ASSERT_EQ(ppu.load8(0x1) & 0b11, 3);
+			ppu.store8(0x3, 8); // lands on pixel 80
+		}
+	});
+
+	u32 color0 = pixel(frame, 0, 0);
+	u32 color3 = pixel(frame, 8, 0);
+	EXPECT_EQ(pixel(frame, 0, ROW), color0);
+	EXPECT_EQ(pixel(frame, 80, ROW - 1), color0);
+	EXPECT_EQ(pixel(frame, 80, ROW), color3);
+	EXPECT_EQ(pixel(frame, 88, ROW), color0);
+	EXPECT_EQ(pixel(frame, 0, ROW + 1), color3);
+}
+
+TEST_F(PPUTests, givenSpritesExpectDrawnOverBackgroundAndBehindWhenPrioritySet)
+{
+	ppu.store8(0x0, 0x93); // OBJEnable
+	ppu.store8(0x8, 0b01000000); // OBP0 maps color 3 to 1
+	// sprite 0 at screen (4, 0) and sprite 1 behind background at (4, 8), both use tile 1
+	const u8 oam[]{ 16, 12, 1, 0, 24, 12, 1, 0x80 };
+	for (u8 i = 0; i < sizeof(oam); i++)
+		ppu.storeOAM8(i, oam[i]);
+
+	runFrame();
+	auto frame = runFrame();
+
+	u32 color0 = pixel(frame, 0, 0);
+	u32 color3 = pixel(frame, 12, 0);
+	u32 spriteColor = pixel(frame, 4, 0);
+	EXPECT_NE(spriteColor, color0);
+	EXPECT_NE(spriteColor, color3);
+	EXPECT_EQ(pixel(frame, 3, 0), color0);
+	EXPECT_EQ(pixel(frame, 11, 0), spriteColor);
+	EXPECT_EQ(pixel(frame, 4, 8), spriteColor); // over background color 0
+	EXPECT_EQ(pixel(frame, 8, 8), color3); // hidden by other background colors
+}
+
+TEST_F(PPUTests, givenTileDataWriteExpectOnlyThatRowRedrawn)
+{
+	runFrame();
+	ppu.storeVRAM8(16, 0x0F); // low bitplane of tile 1 row 0, left half becomes color 2
+	auto frame = runFrame();
+
+	u32 color3 = pixel(frame, 12, 0);
+	EXPECT_NE(pixel(frame, 8, 0), color3);
+	EXPECT_NE(pixel(frame, 8, 0), pixel(frame, 0, 0));
+	EXPECT_EQ(pixel(frame, 8, 1), color3);
+}
+
+TEST_F(PPUTests, givenMoreThanTenSpritesOnLineExpectFirstTenInOAMOrder)
+{
+	ppu.store8(0x0, 0x93); // OBJEnable
+	ppu.store8(0x8, 0b01000000); // OBP0 maps color 3 to 1
+	// sprites 0-9 at screen x 8-87, sprite 10 at x 0 is left of all of them but over the limit
+	for (u8 i = 0; i < 11; i++) {
+		ppu.storeOAM8(i * 4 + 0, 16);
+		ppu.storeOAM8(i * 4 + 1, i < 10 ? 16 + i * 8 : 8);
+		ppu.storeOAM8(i * 4 + 2, 1);
+	}
+
+	runFrame();
+	auto frame = runFrame();
+
+	u32 spriteColor = pixel(frame, 8, 0);
+	EXPECT_EQ(pixel(frame, 0, 0), pixel(frame, 0, 8));
+	EXPECT_EQ(pixel(frame, 87, 0), spriteColor);
+
+	// moved below the others, now it's alone on its lines
+	ppu.storeOAM8(10 * 4, 32);
+	frame = runFrame();
+	EXPECT_EQ(pixel(frame, 0, 0), pixel(frame, 0, 8));
+	EXPECT_EQ(pixel(frame, 0, 16), spriteColor);
+}
+
+TEST_F(PPUTests, givenDMAExpectOAMLockedAndThenCopiedFromPointerOrCallback)
+{
+	u8 memory[0x100];
+	for (u16 i = 0; i < 0x100; i++)
+		memory[i] = (u8)(i ^ 0x5A);
+	u16 readCount = 0;
+	ppu.mapReadExternalMemoryCallback([&](u16 address) { readCount++; return memory[address & 0xFF]; });
+
+	for (bool hasPointer : { true, false }) {
+		ppu.mapExternalMemoryPointerCallback([&](u16) { return hasPointer ? memory : nullptr; });
+		readCount = 0;
+		ppu.store8(0x6, 0xC0);
+		scheduler.advance(3);
+		EXPECT_EQ(ppu.loadOAM8(0), 0xFF);
+
+		scheduler.advance(159);
+		EXPECT_EQ(ppu.loadOAM8(0), 0xFF);
+		scheduler.advance(1);
+		for (u16 i = 0; i < 160; i++)
+			ASSERT_EQ(ppu.loadOAM8(i), memory[i]);
+		EXPECT_EQ(readCount, hasPointer ? 0 : 160);
+	}
+}
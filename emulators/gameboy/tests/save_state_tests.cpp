@@ -0,0 +1,46 @@
+#include "../gameboy.hpp"
+
+#include <gtest/gtest.h>
+
+struct SaveStateTests :
+	public testing::Test
+{
+	Gameboy gb;
+
+	void SetUp() override
+	{
+		ASSERT_TRUE(gb.loadCartridge("test_files/gameboy/mooneye/timer/tim00.gb", true));
+		gb.reset();
+	}
+};
+
+TEST_F(SaveStateTests, givenLoadedStateExpectSameExecution)
+{
+	std::vector<u8> snapshot, expected, actual;
+	gb.runCycles(50000);
+	gb.saveState(snapshot);
+
+	gb.runCycles(30000);
+	gb.saveState(expected);
+
+	ASSERT_TRUE(gb.loadState(snapshot));
+	gb.runCycles(30000);
+	gb.saveState(actual);
+
+	EXPECT_EQ(expected, actual);
+}
+
+TEST_F(SaveStateTests, givenBrokenStateExpectLoadFailure)
+{
+	std::vector<u8> state;
+	gb.saveState(state);
+
+	std::vector<u8> truncated{ state.begin(), state.end() - 1 };
+	EXPECT_FALSE(gb.loadState(truncated));
+
+	std::vector<u8> otherVersion = state;
+	otherVersion[8]++;
+	EXPECT_FALSE(gb.loadState(otherVersion));
+
+	EXPECT_TRUE(gb.loadState(state));
+}
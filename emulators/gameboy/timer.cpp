@@ -1,7 +1,18 @@
 #include "timer.hpp"
+#include "shared/source/save_state.hpp"
 
 #include <cassert>
 
+Timer::Timer(u8& interruptFlagsRef, Scheduler& scheduler) :
+	m_interruptFlagsRef{ interruptFlagsRef },
+	m_schedulerRef{ scheduler }
+{
+	m_overflowEvent = m_schedulerRef.registerEvent([this]() {
+		sync();
+		scheduleOverflow();
+	});
+}
+
 void Timer::reset()
 {
 	constexpr u16 DIVIDER_AFTER_BOOT = 0xABD0;
@@ -15,6 +26,42 @@ void Timer::reset()
 
 	m_overflow = false;
 	m_wasCounterWritten = false;
+
+	m_lastSync = m_schedulerRef.getNow();
+	scheduleOverflow();
+}
+
+void Timer::saveState(StateWriter& writer) const
+{
+	writer.write(m_prevTriggerBit);
+	writer.write(m_divider);
+	writer.write(m_counter);
+	writer.write(m_modulo);
+	writer.write(m_control.byte);
+	writer.write(m_overflow);
+	writer.write(m_wasCounterWritten);
+	writer.write(m_lastSync);
+}
+
+void Timer::loadState(StateReader& reader)
+{
+	reader.read(m_prevTriggerBit);
+	reader.read(m_divider);
+	reader.read(m_counter);
+	reader.read(m_modulo);
+	reader.read(m_control.byte);
+	reader.read(m_overflow);
+	reader.read(m_wasCounterWritten);
+	reader.read(m_lastSync);
+}
+
+void Timer::sync()
+{
+	u64 now = m_schedulerRef.getNow();
+	if (now > m_lastSync) {
+		fastForward(now - m_lastSync);
+		m_lastSync = now;
+	}
 }
 
 void Timer::clock()
@@ -30,16 +77,7 @@ void Timer::clock()
 
 	if (m_wasCounterWritten) m_wasCounterWritten = false;
 
-	u16 bit = 1;
-	switch (m_control.clockSelect)
-	{
-	case 0: bit = 9; break;
-	case 1: bit = 3; break;
-	case 2: bit = 5; break;
-	case 3: bit = 7; break;
-	}
-
-	u8 triggerBit = ((m_divider >> bit) & 1) & m_control.enable;
+	u8 triggerBit = ((m_divider >> getTriggerBit()) & 1) & m_control.enable;
 	bool shouldIncrement = m_prevTriggerBit & ~triggerBit;
 	if (shouldIncrement)
 	{
@@ -53,8 +91,89 @@ void Timer::clock()
 	m_prevTriggerBit = triggerBit;
 }
 
-u8 Timer::load8(u16 address) const
+void Timer::fastForward(u64 ticks)
+{
+	while (ticks > 0) {
+		// Ticks right after register write or overflow can glitch, run them exactly.
+		u8 triggerBit = ((m_divider >> getTriggerBit()) & 1) & m_control.enable;
+		if (m_overflow || m_wasCounterWritten || m_prevTriggerBit != triggerBit) {
+			clock();
+			ticks--;
+			continue;
+		}
+
+		if (!m_control.enable) {
+			m_divider += (u16)(ticks * 4);
+			return;
+		}
+
+		// Counter increments on every falling edge of selected divider bit.
+		u32 period = 1u << (getTriggerBit() + 1);
+		u64 ticksPerIncrement = period / 4;
+		u64 ticksToIncrement = (period - (m_divider & (period - 1))) / 4;
+		u64 ticksToOverflow = ticksToIncrement + (255u - m_counter) * ticksPerIncrement;
+
+		u64 skip = ticks < ticksToOverflow ? ticks : ticksToOverflow - 1;
+		if (skip >= ticksToIncrement)
+			m_counter += (u8)(1 + (skip - ticksToIncrement) / ticksPerIncrement);
+		m_divider += (u16)(skip * 4);
+		m_prevTriggerBit = (m_divider >> getTriggerBit()) & 1;
+		ticks -= skip;
+
+		// Overflowing tick is left for clock().
+		if (ticks > 0) {
+			clock();
+			ticks--;
+		}
+	}
+}
+
+void Timer::scheduleOverflow()
+{
+	// Interrupt is raised one tick after counter overflows.
+	if (m_overflow) {
+		m_schedulerRef.schedule(m_overflowEvent, m_lastSync + 1);
+		return;
+	}
+
+	u8 counter = m_counter;
+	u16 divider = m_divider + 4;
+	u8 triggerBit = ((divider >> getTriggerBit()) & 1) & m_control.enable;
+	if (m_prevTriggerBit & ~triggerBit) {
+		if (++counter == 0) {
+			m_schedulerRef.schedule(m_overflowEvent, m_lastSync + 2);
+			return;
+		}
+	}
+
+	if (!m_control.enable) {
+		m_schedulerRef.cancel(m_overflowEvent);
+		return;
+	}
+
+	u32 period = 1u << (getTriggerBit() + 1);
+	u64 ticksToIncrement = (period - (divider & (period - 1))) / 4;
+	u64 ticksToOverflow = ticksToIncrement + (255u - counter) * (period / 4);
+	m_schedulerRef.schedule(m_overflowEvent, m_lastSync + 1 + ticksToOverflow + 1);
+}
+
+u16 Timer::getTriggerBit() const
 {
+	switch (m_control.clockSelect)
+	{
+	case 0: return 9;
+	case 1: return 3;
+	case 2: return 5;
+	case 3: return 7;
+	}
+
+	return 1;
+}
+
+u8 Timer::load8(u16 address)
+{
+	sync();
+
 	switch (address)
 	{
 	case 0: return m_divider >> 8;
@@ -69,16 +188,21 @@ u8 Timer::load8(u16 address) const
 
 void Timer::store8(u16 address, u8 data)
 {
+	sync();
+
 	switch (address)
 	{
-	case 0: m_divider = 0; return;
-	case 1: m_counter = data; m_wasCounterWritten = true; return;
-	case 2: m_modulo = data; return;
+	case 0: m_divider = 0; break;
+	case 1: m_counter = data; m_wasCounterWritten = true; break;
+	case 2: m_modulo = data; break;
 	case 3:
 		m_control.byte &= 0xF8;
 		m_control.byte |= data & 0x07;
+		break;
+	default:
+		assert(false);
 		return;
 	}
 
-	assert(false);
+	scheduleOverflow();
 }
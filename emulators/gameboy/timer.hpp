@@ -1,20 +1,34 @@
 #pragma once
-#include "shared/source/types.hpp"
+#include "shared/source/scheduler.hpp"
+
+class StateWriter;
+class StateReader;
 
 class Timer
 {
 public:
-	explicit Timer(u8& interruptFlagsRef) : m_interruptFlagsRef{ interruptFlagsRef } {}
+	Timer(u8& interruptFlagsRef, Scheduler& scheduler);
 
 	void reset();
-	void clock();
 
-	u8 load8(u16 address) const;
+	u8 load8(u16 address);
 	void store8(u16 address, u8 data);
 
+	// Overflow event is part of the scheduler state.
+	void saveState(StateWriter& writer) const;
+	void loadState(StateReader& reader);
+
 	Timer(const Timer&) = delete;
 	Timer& operator=(const Timer&) = delete;
 private:
+	// Timer is not clocked, it catches up with the scheduler on register access
+	// and when the overflow event fires.
+	void sync();
+	void clock();
+	void fastForward(u64 ticks);
+	void scheduleOverflow();
+	u16 getTriggerBit() const;
+
 	u8 m_prevTriggerBit;
 	u16 m_divider;
 	u8 m_counter;
@@ -32,4 +46,8 @@ private:
 	u8& m_interruptFlagsRef;
 	bool m_overflow;
 	bool m_wasCounterWritten;
+
+	Scheduler& m_schedulerRef;
+	Scheduler::EventID m_overflowEvent;
+	u64 m_lastSync;
 };
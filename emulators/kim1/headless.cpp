@@ -0,0 +1,35 @@
+#include "kim1.hpp"
+
+#include "shared/source/headless_application.hpp"
+
+#include <memory>
+
+class KIM1Headless :
+    public HeadlessApplication
+{
+public:
+    explicit KIM1Headless(KIM1& kim1) :
+        HeadlessApplication{ {
+                .name = "kim1",
+                .screenWidth = KIM1::SCREEN_WIDTH,
+                .screenHeight = KIM1::SCREEN_HEIGHT,
+                .cyclesPerFrame = 16666,
+                .clockFrequency = 1000000,
+                .needsROM = false
+        } },
+        m_kim1{ kim1 }
+    {}
+private:
+    void setCallProfiler(CallProfiler* profiler) override { m_kim1.setCallProfiler(profiler); }
+    u32 runCycles(u32 budget) override { return m_kim1.runCycles(budget); }
+    std::span<const u32> acquireScreenPixels() override { return m_kim1.getScreenPixels(); }
+
+    KIM1& m_kim1;
+};
+
+int main(int argc, char* argv[])
+{
+    std::unique_ptr<KIM1> kim1 = std::make_unique<KIM1>();
+    KIM1Headless app{ *kim1.get() };
+    return app.run(argc, argv);
+}
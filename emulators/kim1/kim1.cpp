@@ -1,30 +1,35 @@
 #include "kim1.hpp"
+#include "kim1_firmware.hpp"
 #include "shared/source/address_range.hpp"
-#include "shared/source/file_io.hpp"
 
 #include <cassert>
-#include <iostream>
 
 static constexpr AddressRange16 RAM_RANGE{      0x0000, 0x03FF };
 
+static constexpr AddressRange16 IO_RANGE{       0x1700, 0x17FF };
 static constexpr AddressRange16 RRIOT1_RANGE{   0x1700, 0x173F };
 static constexpr AddressRange16 RRIOT2_RANGE{   0x1740, 0x177F };
 static constexpr AddressRange16 RAM_HIGH_RANGE{ 0x1780, 0x17FF };
 
-static constexpr AddressRange16 FIRMWARE_RANGE{ 0x1800, 0x1FFF };
+static constexpr AddressRange16 FIRMWARE_LOW_RANGE{  0x1800, 0x1BFF };
+static constexpr AddressRange16 FIRMWARE_HIGH_RANGE{ 0x1C00, 0x1FFF };
 
 KIM1::KIM1()
 {
-    size_t size = 0x400;
-    if (!readFile("rom/kim1/firmware_1800-1BFF.bin", (char*)m_FIRMWARE, size, true))
-        std::cerr << "Could not read firmware_1800-1BFF.bin ROM file!\n";
-
-    size = 0x400;
-    if (!readFile("rom/kim1/firmware_1C00-1FFF.bin", (char*)(m_FIRMWARE + 0x400), size, true))
-        std::cerr << "Could not read firmware_1C00-1FFF.bin ROM file!\n";
-
-    m_cpu.mapReadMemoryCallback([this](u16 address) { return memoryRead(address); });
-    m_cpu.mapWriteMemoryCallback([this](u16 address, u8 data) { return memoryWrite(address, data); });
+    m_FIRMWARE_LOW.load(firmware::kim1_1800, "rom/kim1/firmware_1800-1BFF.bin", 0x400);
+    m_FIRMWARE_HIGH.load(firmware::kim1_1C00, "rom/kim1/firmware_1C00-1FFF.bin", 0x400);
+
+    // Only 13 address lines are decoded, so the 8KB map is mirrored over the whole space.
+    for (u16 mirror = 0; mirror < 8; mirror++) {
+        u16 base = mirror * 0x2000;
+        m_bus.mapMemory({ u16(base + RAM_RANGE.start), u16(base + RAM_RANGE.end) }, m_RAM);
+        m_bus.mapReadCallback({ u16(base + IO_RANGE.start), u16(base + IO_RANGE.end) },
+            [this](u16 address) { return loadIO8(address & 0x1FFF); });
+        m_bus.mapWriteCallback({ u16(base + IO_RANGE.start), u16(base + IO_RANGE.end) },
+            [this](u16 address, u8 data) { storeIO8(address & 0x1FFF, data); });
+        m_bus.mapReadMemory({ u16(base + FIRMWARE_LOW_RANGE.start), u16(base + FIRMWARE_LOW_RANGE.end) }, m_FIRMWARE_LOW.getData());
+        m_bus.mapReadMemory({ u16(base + FIRMWARE_HIGH_RANGE.start), u16(base + FIRMWARE_HIGH_RANGE.end) }, m_FIRMWARE_HIGH.getData());
+    }
 
     m_cpu.reset();
 }
@@ -34,14 +39,16 @@ void KIM1::clock()
     m_cpu.clock();
 }
 
-u8 KIM1::memoryRead(u16 address) const
+u32 KIM1::runCycles(u32 budget)
 {
-    address &= 0x1FFF;
+    m_bus.syncWatchpoints();
+    return m_cpu.runCycles(budget);
+}
 
+u8 KIM1::loadIO8(u16 address) const
+{
     u16 offset;
 
-    if (RAM_RANGE.contains(address, offset)) return m_RAM[offset];
-
     if (RRIOT2_RANGE.contains(address, offset)) {
         switch (offset)
         {
@@ -53,23 +60,14 @@ u8 KIM1::memoryRead(u16 address) const
 
     if (RAM_HIGH_RANGE.contains(address, offset)) return m_RAM_HIGH[offset];
 
-    if (FIRMWARE_RANGE.contains(address, offset)) return m_FIRMWARE[offset];
-
     assert(false);
     return 0;
 }
 
-void KIM1::memoryWrite(u16 address, u8 data)
+void KIM1::storeIO8(u16 address, u8 data)
 {
-    address &= 0x1FFF;
-
     u16 offset;
 
-    if (RAM_RANGE.contains(address, offset)) {
-        m_RAM[offset] = data;
-        return;
-    }
-
     if (RRIOT1_RANGE.contains(address, offset)) {
         assert(false);
         return;
@@ -1,6 +1,7 @@
 #include "kim1.hpp"
 
 #include "shared/source/application.hpp"
+#include "shared/source/frame_pacer.hpp"
 
 #include <thread>
 
@@ -23,19 +24,23 @@ public:
         } }
     {}
 private:
-    std::span<const unsigned int> getScreenPixels() const override { return {}; }
+    ScreenFrame acquireScreenFrame() override { return { {}, 0 }; }
 };
 
+static constexpr u32 CYCLES_PER_FRAME = 16666; // 1MHz / 60Hz
+
 int main()
 {
     KIM1App app;
     std::unique_ptr<KIM1> kim1 = std::make_unique<KIM1>();
+    FramePacer pacer{ 60.0 };
 
     std::thread emuThread{
         [&]() {
+            pacer.reset();
             while (app.isRunning()) {
-                std::this_thread::sleep_for(std::chrono::nanoseconds{ 32 }); // TODO: temp
-                kim1->clock();
+                kim1->runCycles(CYCLES_PER_FRAME);
+                pacer.waitForNextFrame();
             }
         }
     };
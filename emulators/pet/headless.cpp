@@ -0,0 +1,35 @@
+#include "pet.hpp"
+
+#include "shared/source/headless_application.hpp"
+
+#include <memory>
+
+class PETHeadless :
+    public HeadlessApplication
+{
+public:
+    explicit PETHeadless(PET& pet) :
+        HeadlessApplication{ {
+                .name = "pet",
+                .screenWidth = PET::SCREEN_WIDTH,
+                .screenHeight = PET::SCREEN_HEIGHT,
+                .cyclesPerFrame = 16666,
+                .clockFrequency = 1000000,
+                .needsROM = false
+        } },
+        m_pet{ pet }
+    {}
+private:
+    void setCallProfiler(CallProfiler* profiler) override { m_pet.setCallProfiler(profiler); }
+    u32 runCycles(u32 budget) override { return m_pet.runCycles(budget); }
+    std::span<const u32> acquireScreenPixels() override { return m_pet.acquireScreenPixels(); }
+
+    PET& m_pet;
+};
+
+int main(int argc, char* argv[])
+{
+    std::unique_ptr<PET> pet = std::make_unique<PET>();
+    PETHeadless app{ *pet.get() };
+    return app.run(argc, argv);
+}
@@ -1,18 +1,27 @@
 #include "pet.hpp"
 
 #include "shared/source/application.hpp"
+#include "shared/source/call_profiler.hpp"
+#include "shared/source/frame_pacer.hpp"
+#include "shared/source/pc_profiler.hpp"
+#include "shared/source/rewind_buffer.hpp"
+#include "shared/source/imgui/profiler_view.hpp"
 
 #include <GLFW/glfw3.h> // TODO: abstract this
 #include <imgui.h>
 
-#include <chrono>
 #include <thread>
+#include <vector>
+
+static constexpr u32 CYCLES_PER_FRAME = 16666; // 1MHz / 60Hz
+static constexpr size_t REWIND_FRAMES = 60 * 60;
+static constexpr size_t REWIND_BYTES = 16 * 1024 * 1024;
 
 class PETApp :
     public Application
 {
 public:
-    explicit PETApp(PET& pet) :
+    PETApp(PET& pet, FramePacer& pacer) :
         Application{ {
                 .windowTitle = "Commodore PET Emulator by Kostu96",
                 .rendererWidth = PET::SCREEN_WIDTH,
@@ -21,10 +30,22 @@ public:
                 .border = 2,
                 .hasMenuBar = true
         } },
-        m_pet{ pet }
-    {}
+        m_pet{ pet },
+        m_pacer{ pacer },
+        m_profilerView{ 4 }
+    {
+        m_pet.setProfiler(&m_profiler);
+        m_pet.setCallProfiler(&m_callProfiler);
+        m_profilerView.profiler = &m_profiler;
+        m_profilerView.callProfiler = &m_callProfiler;
+    }
 private:
-    std::span<const unsigned int> getScreenPixels() const override { return m_pet.getScreenPixels(); }
+    ScreenFrame acquireScreenFrame() override {
+        auto pixels = m_pet.acquireScreenPixels();
+        return { pixels, m_pet.getScreenSequence() };
+    }
+
+    bool supportsRewind() const override { return true; }
 
     void onImGUIRender() override {
         ImGui::BeginMainMenuBar();
@@ -45,30 +66,39 @@ private:
         }
         if (ImGui::BeginMenu("Settings"))
         {
-            /* if (ImGui::BeginMenu("Emualtion Speed"))
-             {
-                 if (ImGui::MenuItem("50%", nullptr, &emuSpeed50, !emuSpeed50)) {
-                     emuSpeed100 = false;
-                     emuSpeed150 = false;
-                     tickTime = std::chrono::nanoseconds(2000);
-                 }
-                 if (ImGui::MenuItem("100%", nullptr, &emuSpeed100, !emuSpeed100)) {
-                     emuSpeed50 = false;
-                     emuSpeed150 = false;
-                     tickTime = std::chrono::nanoseconds(1000);
-                 }
-                 if (ImGui::MenuItem("150%", nullptr, &emuSpeed150, !emuSpeed150)) {
-                     emuSpeed50 = false;
-                     emuSpeed100 = false;
-                     tickTime = std::chrono::nanoseconds(667);
-                 }
-
-                 ImGui::EndMenu();
-             }*/
+            if (ImGui::BeginMenu("Emulation Speed"))
+            {
+                u32 speed = m_pacer.getSpeed();
+                if (ImGui::MenuItem("50%", nullptr, speed == 50, speed != 50)) m_pacer.setSpeed(50);
+                if (ImGui::MenuItem("100%", nullptr, speed == 100, speed != 100)) m_pacer.setSpeed(100);
+                if (ImGui::MenuItem("150%", nullptr, speed == 150, speed != 150)) m_pacer.setSpeed(150);
+                if (ImGui::MenuItem("Unlimited", nullptr, speed == FramePacer::UNLIMITED_SPEED, speed != FramePacer::UNLIMITED_SPEED))
+                    m_pacer.setSpeed(FramePacer::UNLIMITED_SPEED);
+
+                ImGui::EndMenu();
+            }
+            if (ImGui::BeginMenu("Frame Timing"))
+            {
+                auto stats = m_pacer.getStats();
+                ImGui::Text("Frames: %llu (late: %llu, resyncs: %llu)",
+                    (unsigned long long)stats.frames, (unsigned long long)stats.lateFrames, (unsigned long long)stats.resyncs);
+                ImGui::Text("Drift: %lld us (avg: %lld us, max: %lld us)",
+                    (long long)stats.lastDriftUs, (long long)stats.averageDriftUs, (long long)stats.maxDriftUs);
+                if (ImGui::MenuItem("Reset stats")) m_pacer.resetStats();
+
+                ImGui::EndMenu();
+            }
 
             ImGui::EndMenu();
         }
+        if (ImGui::BeginMenu("Debug"))
+        {
+            ImGui::MenuItem("Profiler", nullptr, &m_profilerView.open);
+            ImGui::EndMenu();
+        }
         ImGui::EndMainMenuBar();
+
+        m_profilerView.updateWindow();
     }
 
     void onKeyCallback(int key, int action, int mods) override {
@@ -80,27 +110,35 @@ private:
     }
 
     PET& m_pet;
+    FramePacer& m_pacer;
+    PCProfiler m_profiler{ 16 };
+    CallProfiler m_callProfiler;
+    imgui::ProfilerView m_profilerView;
 };
 
 int main()
 {
     std::unique_ptr<PET> pet = std::make_unique<PET>();
-    PETApp app{ *pet.get() };
+    FramePacer pacer{ 60.0 };
+    PETApp app{ *pet.get(), pacer };
 
-    auto tickTime = std::chrono::nanoseconds(1000);
     std::thread emuThread{
         [&]() {
-            constexpr auto sleepTime = std::chrono::milliseconds(8);
-            s64 ticks = 0;
-            auto t1 = std::chrono::high_resolution_clock().now();
+            RewindBuffer rewind{ REWIND_FRAMES, REWIND_BYTES };
+            std::vector<u8> state;
+            pacer.reset();
             while (app.isRunning()) {
-                auto elapsedTime = std::chrono::high_resolution_clock().now() - t1;
-                auto emulatedTime = ticks * tickTime;
-                if (emulatedTime.count() - elapsedTime.count() > sleepTime.count())
-                    std::this_thread::sleep_for(sleepTime);
-                
-                pet->clock();
-                ticks++;
+                if (app.isRewinding()) {
+                    // States are taken at frame start, running the frame again redraws it.
+                    if (rewind.pop(state) && pet->loadState(state))
+                        pet->runCycles(CYCLES_PER_FRAME);
+                }
+                else {
+                    pet->saveState(state);
+                    rewind.push(state);
+                    pet->runCycles(CYCLES_PER_FRAME);
+                }
+                pacer.waitForNextFrame();
             }
         }
     };
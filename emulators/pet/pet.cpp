@@ -1,9 +1,10 @@
 #include "pet.hpp"
+#include "pet_firmware.hpp"
 #include "shared/source/address_range.hpp"
-#include "shared/source/file_io.hpp"
+#include "shared/source/save_state.hpp"
 
+#include <algorithm>
 #include <cassert>
-#include <iostream>
 
 static constexpr AddressRange16 RAM_RANGE{           0x0000, PET::RAM_SIZE - 1 };
 static constexpr AddressRange16 RAM_EXPANSION_RANGE{ PET::RAM_SIZE, 0x7FFF };
@@ -11,46 +12,43 @@ static constexpr AddressRange16 SCREEN_RANGE{        0x8000, 0x8FFF };
 
 static constexpr AddressRange16 BASIC_RANGE{         0xE000 - PET::BASIC_SIZE, 0xDFFF };
 static constexpr AddressRange16 EDITOR_RANGE{        0xE000, 0xE7FF };
+static constexpr AddressRange16 IO_RANGE{            0xE800, 0xE8FF };
 static constexpr AddressRange16 PIA1_RANGE{          0xE810, 0xE81F };
 static constexpr AddressRange16 PIA2_RANGE{          0xE820, 0xE82F };
 static constexpr AddressRange16 VIA_RANGE{           0xE840, 0xE84F };
 static constexpr AddressRange16 CRTC_RANGE{          0xE880, 0xE88F };
 static constexpr AddressRange16 KERNAL_RANGE{        0xF000, 0xFFFF };
 
+static constexpr u16 SYSTEM_TICKS = 16666; // 1MHz / 16666 = 60Hz
+
+static constexpr u32 STATE_ID = makeStateID("PET ");
+static constexpr u32 STATE_VERSION = 1;
+
 PET::PET()
 {
 #if BASIC_VER4
-    static constexpr const char* basicPath = "rom/pet/basic4.bin";
+    m_BASIC.load(firmware::pet_basic4, "rom/pet/basic4.bin", PET::BASIC_SIZE);
 #if PETTEST
-    static constexpr const char* editorPath = "rom/tests/PETTESTE2KV04.bin";
+    m_EDITOR.load({}, "rom/tests/PETTESTE2KV04.bin", 0x800);
 #else
-    static constexpr const char* editorPath = "rom/pet/editor4n.bin";
+    m_EDITOR.load(firmware::pet_editor4n, "rom/pet/editor4n.bin", 0x800);
 #endif
-    static constexpr const char* kernalPath = "rom/pet/kernal4.bin";
+    m_KERNAL.load(firmware::pet_kernal4, "rom/pet/kernal4.bin", 0x1000);
 #else
-    static constexpr const char* basicPath = "rom/pet/basic2.bin";
-    static constexpr const char* editorPath = "rom/pet/editor2n.bin";
-    static constexpr const char* kernalPath = "rom/pet/kernal2.bin";
+    m_BASIC.load(firmware::pet_basic2, "rom/pet/basic2.bin", PET::BASIC_SIZE);
+    m_EDITOR.load(firmware::pet_editor2n, "rom/pet/editor2n.bin", 0x800);
+    m_KERNAL.load(firmware::pet_kernal2, "rom/pet/kernal2.bin", 0x1000);
 #endif
+    m_characters.load(firmware::pet_characters2, "rom/pet/characters2.bin", 0x800);
 
-    size_t size = PET::BASIC_SIZE;
-    if (!readFile(basicPath, (char*)m_BASIC, size, true))
-        std::cerr << "Could not read EDITOR ROM file!\n";
-
-    size = 0x800;
-    if (!readFile(editorPath, (char*)m_EDITOR, size, true))
-        std::cerr << "Could not read EDITOR ROM file!\n";
-
-    size = 0x1000;
-    if (!readFile(kernalPath, (char*)m_KERNAL, size, true))
-        std::cerr << "Could not read KERNAL ROM file!\n";
-    
-    size = 0x800;
-    if (!readFile("rom/pet/characters2.bin", (char*)m_characters, size, true))
-        std::cerr << "Could not read characters ROM file!\n";
-
-    m_cpu.mapReadMemoryCallback([this](u16 address) { return memoryRead(address); });
-    m_cpu.mapWriteMemoryCallback([this](u16 address, u8 data) { memoryWrite(address, data); });
+    m_bus.mapMemory(RAM_RANGE, m_RAM);
+    m_bus.mapOpenBus(RAM_EXPANSION_RANGE);
+    m_bus.mapMemory(SCREEN_RANGE, m_SCREEN, 0x3FF);
+    m_bus.mapReadMemory(BASIC_RANGE, m_BASIC.getData());
+    m_bus.mapReadMemory(EDITOR_RANGE, m_EDITOR.getData());
+    m_bus.mapReadCallback(IO_RANGE, [this](u16 address) { return loadIO8(address); });
+    m_bus.mapWriteCallback(IO_RANGE, [this](u16 address, u8 data) { storeIO8(address, data); });
+    m_bus.mapReadMemory(KERNAL_RANGE, m_KERNAL.getData());
 
     m_pia1.mapIRQBCallback([this](bool state) { m_cpu.setIRQ(state); });
     m_pia1.mapPortAOutputCallback([this](u8 data) { m_keyRow = data; });
@@ -59,29 +57,81 @@ PET::PET()
     for (size_t i = 0; i < 10; i++)
         m_keyRows[i] = 0xFF;
 
+    m_systemTickEvent = m_scheduler.registerEvent([this]() {
+        renderScreen();
+        m_frames.publish();
+        m_pia1.CB1();
+        m_scheduler.scheduleIn(m_systemTickEvent, SYSTEM_TICKS);
+    });
+
     m_cpu.reset();
+    m_scheduler.scheduleIn(m_systemTickEvent, SYSTEM_TICKS);
 }
 
 void PET::clock()
 {
-    constexpr u16 SYSTEM_TICKS = 16666; // 1MHz / 16666 = 60Hz
+    m_cpu.clock();
+    m_scheduler.advance(1);
+}
 
-    static u16 counter = 0;
+u32 PET::runCycles(u32 budget)
+{
+    m_bus.syncWatchpoints();
+
+    u32 cycles = 0;
+    while (cycles < budget) {
+        u32 slice = (u32)std::min<u64>(budget - cycles, m_scheduler.getCyclesUntilNextEvent());
+        u32 sliceCycles = m_cpu.runCycles(slice);
+        m_scheduler.advance(sliceCycles);
+        cycles += sliceCycles;
+
+        // CPU stopped at a breakpoint.
+        if (sliceCycles < slice)
+            break;
+    }
 
-    counter++;
+    return cycles;
+}
 
-    m_cpu.clock();
+void PET::saveState(std::vector<u8>& state) const
+{
+    StateWriter writer{ state, STATE_ID, STATE_VERSION };
+    writer.writeBytes(m_RAM, sizeof(m_RAM));
+    writer.writeBytes(m_SCREEN, sizeof(m_SCREEN));
+    m_cpu.saveState(writer);
+    m_pia1.saveState(writer);
+    m_pia2.saveState(writer);
+    m_via.saveState(writer);
+    writer.write(m_keyRow);
+    writer.writeBytes(m_keyRows, sizeof(m_keyRows));
+    m_scheduler.saveState(writer);
+}
 
-    if (counter == SYSTEM_TICKS) {
-        counter = 0;
-        m_pia1.CB1();
-    }
+bool PET::loadState(std::span<const u8> state)
+{
+    StateReader reader{ state, STATE_ID, STATE_VERSION };
+    if (!reader.isValid())
+        return false;
+
+    reader.readBytes(m_RAM, sizeof(m_RAM));
+    reader.readBytes(m_SCREEN, sizeof(m_SCREEN));
+    m_cpu.loadState(reader);
+    m_pia1.loadState(reader);
+    m_pia2.loadState(reader);
+    m_via.loadState(reader);
+    reader.read(m_keyRow);
+    reader.readBytes(m_keyRows, sizeof(m_keyRows));
+    m_scheduler.loadState(reader);
+
+    // Screen is otherwise redrawn only on the next system tick.
+    renderScreen();
+    m_frames.publish();
+
+    return reader.isValid() && reader.isAtEnd();
 }
 
 void PET::updateKeysFromEvent(int key, bool press, bool shift)
 {
-    static bool shiftFlag = false;
-
     if (!press) {
         for (size_t i = 0; i < 10; i++)
             m_keyRows[i] = 0xFF;
@@ -101,9 +151,9 @@ void PET::updateKeysFromEvent(int key, bool press, bool shift)
     }
 
     if (shift) {
-        shiftFlag = !shiftFlag;
+        m_shiftFlag = !m_shiftFlag;
     }
-    if (shiftFlag) m_keyRows[8] = 0xFE; // left shift
+    if (m_shiftFlag) m_keyRows[8] = 0xFE; // left shift
 }
 
 void PET::updateKeysFromCodepoint(int codepoint)
@@ -179,46 +229,48 @@ void PET::updateKeysFromCodepoint(int codepoint)
     }
 }
 
-u8 PET::memoryRead(u16 address) const
+u8 PET::loadIO8(u16 address) const
 {
     u16 offset;
 
-    if (RAM_RANGE.contains(address, offset)) return m_RAM[offset];
-
-    if (RAM_EXPANSION_RANGE.contains(address, offset)) return 0xFF;
-
-    if (SCREEN_RANGE.contains(address, offset)) return m_SCREEN[offset];
-
-    if (BASIC_RANGE.contains(address, offset)) return m_BASIC[offset];
-
-    if (EDITOR_RANGE.contains(address, offset)) return m_EDITOR[offset];
-
     if (PIA1_RANGE.contains(address, offset)) return m_pia1.load8(offset);
 
     if (VIA_RANGE.contains(address, offset)) return m_via.load8(offset);
 
-    if (KERNAL_RANGE.contains(address, offset)) return m_KERNAL[offset];
-
     assert(false);
     return 0;
 }
 
-void PET::memoryWrite(u16 address, u8 data)
+void PET::storeIO8(u16 address, u8 data)
 {
     u16 offset;
 
-    if (RAM_RANGE.contains(address, offset)) {
-        m_RAM[offset] = data;
+    if (PIA1_RANGE.contains(address, offset)) {
+        m_pia1.store8(offset, data);
         return;
     }
 
-    if (RAM_EXPANSION_RANGE.contains(address, offset)) return;
+    if (PIA2_RANGE.contains(address, offset)) {
+        m_pia2.store8(offset, data);
+        return;
+    }
 
-    if (SCREEN_RANGE.contains(address, offset)) {
-        offset &= 0x3FF;
-        m_SCREEN[offset] = data;
+    if (VIA_RANGE.contains(address, offset)) {
+        m_via.store8(offset, data);
+        return;
+    }
+
+    if (CRTC_RANGE.contains(address, offset)) return;
+
+    assert(false);
+}
 
-        if (offset > 999) return;
+void PET::renderScreen()
+{
+    u32* pixels = m_frames.getWriteBuffer().data();
+    for (u16 offset = 0; offset < TEXTMODE_WIDTH * TEXTMODE_HEIGHT; offset++)
+    {
+        u8 data = m_SCREEN[offset];
 
         // data bits 0-6 are used as address bits 3-9
         // data bit 7 is used as a signal to characted inverter
@@ -229,39 +281,18 @@ void PET::memoryWrite(u16 address, u8 data)
 
         u16 pixelX = (offset % TEXTMODE_WIDTH) * 8;
         u16 pixelY = (offset / TEXTMODE_WIDTH) * 8;
-        u16 pixelOffset = pixelY * SCREEN_WIDTH + pixelX;
+        u32 pixelOffset = pixelY * SCREEN_WIDTH + pixelX;
         for (u16 i = 0; i < 8; i++)
         {
-            u8 charData = m_characters[charDataOffset++];
+            u8 charData = m_characters.getData()[charDataOffset++];
             for (s16 j = 7; j >= 0; j--)
             {
                 if (data & 0x80)
-                    m_screenPixels[pixelOffset + (7 - j)] = (charData >> j) & 1 ? 0xFF000000 : 0xFF50E050;
+                    pixels[pixelOffset + (7 - j)] = (charData >> j) & 1 ? 0xFF000000 : 0xFF50E050;
                 else
-                    m_screenPixels[pixelOffset + (7 - j)] = (charData >> j) & 1 ? 0xFF50E050 : 0xFF000000;
+                    pixels[pixelOffset + (7 - j)] = (charData >> j) & 1 ? 0xFF50E050 : 0xFF000000;
             }
             pixelOffset += 8 * TEXTMODE_WIDTH;
         }
-
-        return;
     }
-
-    if (PIA1_RANGE.contains(address, offset)) {
-        m_pia1.store8(offset, data);
-        return;
-    }
-
-    if (PIA2_RANGE.contains(address, offset)) {
-        m_pia2.store8(offset, data);
-        return;
-    }
-
-    if (VIA_RANGE.contains(address, offset)) {
-        m_via.store8(offset, data);
-        return;
-    }
-
-    if (CRTC_RANGE.contains(address, offset)) return;
-
-    assert(false);
 }
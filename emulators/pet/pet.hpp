@@ -1,10 +1,14 @@
 #pragma once
 #include "shared/source/devices/cpu6502/cpu6502.hpp"
+#include "shared/source/firmware.hpp"
+#include "shared/source/memory_bus.hpp"
+#include "shared/source/scheduler.hpp"
+#include "shared/source/triple_buffer.hpp"
 #include "pia6520.hpp"
 #include "via6522.hpp"
 
-#include <array>
 #include <span>
+#include <vector>
 
 #define BASIC_VER4 0
 #define PETTEST 0
@@ -26,27 +30,43 @@ public:
     PET();
 
     void clock();
+    u32 runCycles(u32 budget);
+    void setBreakpoints(Breakpoints* breakpoints) { m_cpu.setBreakpoints(breakpoints); m_bus.setBreakpoints(breakpoints); }
+    void setProfiler(PCProfiler* profiler) { m_cpu.setProfiler(profiler); }
+    void setCallProfiler(CallProfiler* profiler) { m_cpu.setCallProfiler(profiler); }
 
-    std::span<const u32> getScreenPixels() const { return m_screenPixels; }
+    // ROMs are not part of the state. Machine has to be reset when loading fails.
+    void saveState(std::vector<u8>& state) const;
+    bool loadState(std::span<const u8> state);
+
+    // Screen is rendered and published at 60Hz, these can be called from other thread.
+    std::span<const u32> acquireScreenPixels() { return m_frames.acquire(); }
+    u64 getScreenSequence() const { return m_frames.getSequence(); }
     void updateKeysFromEvent(int key, bool press, bool shift);
     void updateKeysFromCodepoint(int codepoint);
 private:
-    u8 memoryRead(u16 address) const;
-    void memoryWrite(u16 address, u8 data);
+    u8 loadIO8(u16 address) const;
+    void storeIO8(u16 address, u8 data);
+    void renderScreen();
+
+    MemoryBus16 m_bus;
+    Scheduler m_scheduler;
+    Scheduler::EventID m_systemTickEvent;
 
     u8 m_RAM[RAM_SIZE];
-    u8 m_SCREEN[0x400];
-    u8 m_BASIC[BASIC_SIZE];
-    u8 m_EDITOR[0x800];
-    u8 m_KERNAL[0x1000];
-    u8 m_characters[0x800];
+    u8 m_SCREEN[0x400]{};
+    Firmware m_BASIC;
+    Firmware m_EDITOR;
+    Firmware m_KERNAL;
+    Firmware m_characters;
 
-    CPU6502 m_cpu{};
+    CPU6502Core<MemoryBus16> m_cpu{ m_bus };
     PIA6520 m_pia1{};
     PIA6520 m_pia2{};
     VIA6522 m_via{};
 
-    std::array<u32, SCREEN_WIDTH * SCREEN_HEIGHT> m_screenPixels;
+    TripleBuffer<std::vector<u32>> m_frames{ std::vector<u32>(SCREEN_WIDTH * SCREEN_HEIGHT, 0xFF000000) };
     u8 m_keyRow = 0;
     u8 m_keyRows[10];
+    bool m_shiftFlag = false; // host input, not part of the state
 };
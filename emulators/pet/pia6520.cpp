@@ -1,4 +1,5 @@
 #include "pia6520.hpp"
+#include "shared/source/save_state.hpp"
 
 #include <cassert>
 
@@ -54,3 +55,23 @@ void PIA6520::CB1()
         m_IRQB(true);
     }
 }
+
+void PIA6520::saveState(StateWriter& writer) const
+{
+    writer.write(m_PRA);
+    writer.write(m_DDRA);
+    writer.write(m_CRA.byte);
+    writer.write(m_PRB);
+    writer.write(m_DDRB);
+    writer.write(m_CRB.byte);
+}
+
+void PIA6520::loadState(StateReader& reader)
+{
+    reader.read(m_PRA);
+    reader.read(m_DDRA);
+    reader.read(m_CRA.byte);
+    reader.read(m_PRB);
+    reader.read(m_DDRB);
+    reader.read(m_CRB.byte);
+}
@@ -3,6 +3,9 @@
 
 #include <functional>
 
+class StateWriter;
+class StateReader;
+
 class PIA6520
 {
 public:
@@ -19,6 +22,9 @@ public:
 
     void CB1();
 
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
     PIA6520() = default;
 private:
     union Control
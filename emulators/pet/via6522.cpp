@@ -1,4 +1,5 @@
 #include "via6522.hpp"
+#include "shared/source/save_state.hpp"
 
 #include <cassert>
 
@@ -34,3 +35,21 @@ void VIA6522::store8(u16 address, u8 data)
     }
     assert(false);
 }
+
+void VIA6522::saveState(StateWriter& writer) const
+{
+    writer.write(m_PRB);
+    writer.write(m_DDRB);
+    writer.write(m_timer1H);
+    writer.write(m_PCR);
+    writer.write(m_IER);
+}
+
+void VIA6522::loadState(StateReader& reader)
+{
+    reader.read(m_PRB);
+    reader.read(m_DDRB);
+    reader.read(m_timer1H);
+    reader.read(m_PCR);
+    reader.read(m_IER);
+}
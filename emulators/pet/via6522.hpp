@@ -1,6 +1,9 @@
 #pragma once
 #include "shared/source/types.hpp"
 
+class StateWriter;
+class StateReader;
+
 class VIA6522
 {
 public:
@@ -8,6 +11,9 @@ public:
 
     u8 load8(u16 address) const;
     void store8(u16 address, u8 data);
+
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
 private:
     u8 m_PRB; // Port B
 
@@ -1,4 +1,6 @@
 #include "cpu.hpp"
+#include "shared/source/call_profiler.hpp"
+#include "shared/source/save_state.hpp"
 
 #include <cassert>
 
@@ -16,6 +18,32 @@ namespace PSX {
         m_isBranchDelaySlot = false;
     }
 
+    void CPU::saveState(StateWriter& writer) const
+    {
+        writer.writeBytes(m_cpuStatus.regs, sizeof(m_cpuStatus.regs));
+        writer.writeBytes(m_cop0Status.regs, sizeof(m_cop0Status.regs));
+        writer.write(m_pendingLoad.regIndex.i);
+        writer.write(m_pendingLoad.value);
+        writer.writeBytes(m_helperCPURegs, sizeof(m_helperCPURegs));
+        writer.write(m_currentPC);
+        writer.write(m_nextPC);
+        writer.write(m_isBranch);
+        writer.write(m_isBranchDelaySlot);
+    }
+
+    void CPU::loadState(StateReader& reader)
+    {
+        reader.readBytes(m_cpuStatus.regs, sizeof(m_cpuStatus.regs));
+        reader.readBytes(m_cop0Status.regs, sizeof(m_cop0Status.regs));
+        reader.read(m_pendingLoad.regIndex.i);
+        reader.read(m_pendingLoad.value);
+        reader.readBytes(m_helperCPURegs, sizeof(m_helperCPURegs));
+        reader.read(m_currentPC);
+        reader.read(m_nextPC);
+        reader.read(m_isBranch);
+        reader.read(m_isBranchDelaySlot);
+    }
+
     void CPU::clock()
     {
         m_currentPC = m_cpuStatus.PC;
@@ -245,12 +273,14 @@ namespace PSX {
     {
         setReg(RegIndex{ 31 }, m_nextPC);
         op_J(immediate);
+        if (m_callProfiler) m_callProfiler->call(m_nextPC);
     }
 
     void CPU::op_JR(RegIndex s)
     {
         m_nextPC = getReg(s);
         m_isBranch = true;
+        if (m_callProfiler && s.i == 31) m_callProfiler->ret();
     }
 
     void CPU::op_JALR(RegIndex d, RegIndex s)
@@ -258,6 +288,7 @@ namespace PSX {
         setReg(d, m_nextPC);
         m_nextPC = getReg(s);
         m_isBranch = true;
+        if (m_callProfiler) m_callProfiler->call(m_nextPC);
     }
 
     void CPU::op_ADD(RegIndex d, RegIndex s, u32 rhs)
@@ -3,6 +3,10 @@
 
 #include <functional>
 
+class CallProfiler;
+class StateWriter;
+class StateReader;
+
 namespace PSX {
 
     struct RegIndex
@@ -108,6 +112,12 @@ namespace PSX {
         void overrideCPURegister(size_t index, u32 value);
         void overrideCOP0Register(size_t index, u32 value) { m_cop0Status.regs[index] = value; }
 
+        // Reports JAL, JALR and JR ra, nullptr stops reporting. Exceptions are not treated as calls.
+        void setCallProfiler(CallProfiler* profiler) { m_callProfiler = profiler; }
+
+        void saveState(StateWriter& writer) const;
+        void loadState(StateReader& reader);
+
         CPU();
         CPU(CPU&) = delete;
         CPU& operator=(CPU&) = delete;
@@ -183,6 +193,7 @@ namespace PSX {
         u32 m_nextPC;
         bool m_isBranch;
         bool m_isBranchDelaySlot;
+        CallProfiler* m_callProfiler = nullptr;
     };
 
 } // namespace PSX
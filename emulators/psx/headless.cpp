@@ -0,0 +1,38 @@
+#include "psx.hpp"
+
+#include "shared/source/headless_application.hpp"
+
+#include <memory>
+
+// Emulator is clocked once per instruction, so cycles reported here are instructions.
+class PSXHeadless :
+    public HeadlessApplication
+{
+public:
+    explicit PSXHeadless(PSX::Emulator& psx) :
+        HeadlessApplication{ {
+                .name = "psx",
+                .screenWidth = PSX::SCREEN_WIDTH,
+                .screenHeight = PSX::SCREEN_HEIGHT,
+                .cyclesPerFrame = 33868800 / 60,
+                .clockFrequency = 33868800,
+                .needsROM = false,
+                .addressWidth = 8
+        } },
+        m_psx{ psx }
+    {}
+private:
+    void setCallProfiler(CallProfiler* profiler) override { m_psx.setCallProfiler(profiler); }
+    u32 runCycles(u32 budget) override {
+        return m_psx.runCycles(budget);
+    }
+
+    PSX::Emulator& m_psx;
+};
+
+int main(int argc, char* argv[])
+{
+    std::unique_ptr<PSX::Emulator> psx = std::make_unique<PSX::Emulator>();
+    PSXHeadless app{ *psx.get() };
+    return app.run(argc, argv);
+}
@@ -1,10 +1,16 @@
 #include "psx.hpp"
+#include "disasm.hpp"
 
 #include "shared/source/application.hpp"
-#include "shared/source/disassembly_line.hpp"
+#include "shared/source/breakpoints.hpp"
+#include "shared/source/call_profiler.hpp"
+#include "shared/source/disassembly_index.hpp"
+#include "shared/source/frame_pacer.hpp"
 #include "shared/source/imgui/debug_view.hpp"
 #include "shared/source/imgui/disassembly_view.hpp"
 #include "shared/source/imgui/memory_view.hpp"
+#include "shared/source/imgui/profiler_view.hpp"
+#include "shared/source/pc_profiler.hpp"
 
 #include <imgui.h>
 #include <thread>
@@ -13,7 +19,7 @@ class PSXApp :
     public Application
 {
 public:
-    PSXApp(PSX::Emulator& psx, Disassembly& disassembly) :
+    explicit PSXApp(PSX::Emulator& psx) :
         Application{ {
                 .windowTitle = "PSX Emulator by Kostu96",
                 .rendererWidth = PSX::SCREEN_WIDTH,
@@ -24,8 +30,8 @@ public:
         } },
         m_psx{ psx },
         m_debugView{ m_isPaused },
-        m_disassembly{ disassembly },
-        m_disasmView{ m_disassembly, 8 },
+        m_disasmView{ 0x00000000, 0xFFFFFFFF, 8, 4, 4 },
+        m_profilerView{ 8 },
         dummyPixelData{ new unsigned int[PSX::SCREEN_WIDTH * PSX::SCREEN_HEIGHT] }
     {
         m_debugView.stepCallback = [&]() {
@@ -57,9 +63,39 @@ public:
         };
 
         m_memoryView.read8 = [this](unsigned int address) -> unsigned char { return m_psx.memoryRead8(address); };
+
+        // Only executed addresses are listed, reading whole address space would hit unmapped regions.
+        m_disasmView.index = &m_disasmIndex;
+        m_disasmView.read8 = [this](u32 address) { return m_psx.memoryRead8(address); };
+        m_disasmView.decode = [](u32 address, const u8* bytes, DisassemblyLine& line) -> u32 {
+            u32 word = (u32)bytes[3] << 24 | (u32)bytes[2] << 16 | (u32)bytes[1] << 8 | bytes[0];
+            PSX::disasm(address, word, line);
+            return 4;
+        };
+
+        m_breakpoints.mapReadRegisterCallback({
+                "R00", "R01", "R02", "R03", "R04", "R05", "R06", "R07", "R08", "R09", "R10", "R11", "R12", "R13", "R14", "R15",
+                "R16", "R17", "R18", "R19", "R20", "R21", "R22", "R23", "R24", "R25", "R26", "R27", "R28", "R29", "R30", "R31",
+                "HI", "LO"
+            }, [this](u32 index) -> u32 {
+                const auto& cpuStatus = m_psx.getCPU().getCPUStatus();
+                if (index == 32) return cpuStatus.HI;
+                if (index == 33) return cpuStatus.LO;
+                return cpuStatus.regs[index];
+            });
+        m_psx.setBreakpoints(&m_breakpoints);
+        m_debugView.breakpoints = &m_breakpoints;
+        m_debugView.addressWidth = 8;
+
+        m_psx.setProfiler(&m_profiler);
+        m_psx.setCallProfiler(&m_callProfiler);
+        m_profilerView.profiler = &m_profiler;
+        m_profilerView.callProfiler = &m_callProfiler;
     }
+
+    bool isPaused() const { return m_isPaused; }
 private:
-    std::span<const unsigned int> getScreenPixels() const override { return { dummyPixelData.get(), PSX::SCREEN_WIDTH * PSX::SCREEN_HEIGHT}; }
+    ScreenFrame acquireScreenFrame() override { return { { dummyPixelData.get(), PSX::SCREEN_WIDTH * PSX::SCREEN_HEIGHT }, 0 }; }
 
     void onImGUIRender() override {
         ImGui::BeginMainMenuBar();
@@ -80,37 +116,50 @@ private:
             ImGui::MenuItem("Debug Control&Status", nullptr, &m_debugView.open);
             ImGui::MenuItem("Disassembly", nullptr, &m_disasmView.open);
             ImGui::MenuItem("Memory", nullptr, &m_memoryView.open);
+            ImGui::MenuItem("Profiler", nullptr, &m_profilerView.open);
             ImGui::EndMenu();
         }
         ImGui::EndMainMenuBar();
 
+        // PCs are recorded only while listing is visible, closed window costs emulation nothing.
+        m_psx.setDisassemblyIndex(m_disasmView.open ? &m_disasmIndex : nullptr);
+
         m_debugView.updateWindow();
         m_disasmView.updateWindow(m_psx.getCPU().getCPUStatus().PC);
         m_memoryView.updateWindow();
+        m_profilerView.updateWindow();
     }
 
     PSX::Emulator& m_psx;
-    Disassembly& m_disassembly;
+    Breakpoints m_breakpoints{ 32, 2 };
+    DisassemblyIndex m_disasmIndex{ 30, 2 }; // word aligned 32-bit addresses
     imgui::DebugView m_debugView;
     imgui::DisassemblyView m_disasmView;
     imgui::MemoryView m_memoryView;
+    PCProfiler m_profiler{ 32, 2 };
+    CallProfiler m_callProfiler;
+    imgui::ProfilerView m_profilerView;
     bool m_autostart = false;
     bool m_isPaused = false;
 
     std::unique_ptr<unsigned int> dummyPixelData;
 };
 
+static constexpr u32 CYCLES_PER_FRAME = 33868800 / 60;
+
 int main()
 {
-    Disassembly disassembly;
-    std::unique_ptr<PSX::Emulator> psx = std::make_unique<PSX::Emulator>(disassembly);
-    PSXApp app{ *psx.get(), disassembly }; // TODO: toooo much spagetti
+    std::unique_ptr<PSX::Emulator> psx = std::make_unique<PSX::Emulator>();
+    FramePacer pacer{ 60.0 };
+    PSXApp app{ *psx.get() };
 
     std::thread emuThread{
         [&]() {
+            pacer.reset();
             while (app.isRunning()) {
-                //std::this_thread::sleep_for(std::chrono::nanoseconds{ 32 }); // TODO: temp
-                psx->clock();
+                if (!app.isPaused())
+                    psx->runCycles(CYCLES_PER_FRAME);
+                pacer.waitForNextFrame();
             }
         }
     };
@@ -1,9 +1,10 @@
 #include "psx.hpp"
-#include "disasm.hpp"
+#include "psx_firmware.hpp"
 
 #include "shared/source/address_range.hpp"
-#include "shared/source/disassembly_line.hpp"
-#include "shared/source/file_io.hpp"
+#include "shared/source/disassembly_index.hpp"
+#include "shared/source/instrumentation.hpp"
+#include "shared/source/save_state.hpp"
 
 #include <cassert>
 #include <iostream>
@@ -54,6 +55,9 @@ namespace PSX {
 
     static constexpr AddressRange32 CACHE_CTRL_RANGE{ 0xFFFE0130, 0xFFFE0133 };
 
+    static constexpr u32 STATE_ID = makeStateID("PSX ");
+    static constexpr u32 STATE_VERSION = 1;
+
     void Emulator::reset()
     {
         m_CPU.reset();
@@ -69,30 +73,66 @@ namespace PSX {
                 it->second();
         }
 
-        DisassemblyLine line;
-        disasm(PC, memoryRead32(PC), line);
-
-        auto i = m_disasm.begin();
-        for (; i != m_disasm.end(); i++)
-            if (i->address >= line.address)
-                break;
+        if (DisassemblyIndex* index = m_disasmIndex.load(std::memory_order_acquire))
+            index->record(PC);
 
-        if (m_disasm.empty() || i == m_disasm.end()) {
-            m_disasm.push_back(line);
-        }
-        else if (line.address == i->address) *i = line;
-        else m_disasm.insert(i, line);
-        
         m_CPU.clock();
     }
 
-    Emulator::Emulator(Disassembly& disasm) :
-        m_disasm{ disasm }
+    u32 Emulator::runCycles(u32 budget)
+    {
+        if ((m_breakpoints && m_breakpoints->isArmed()) || (m_profiler && m_profiler->isEnabled()) ||
+            (m_callProfiler && m_callProfiler->isEnabled()))
+            return runCyclesInstrumented(budget);
+
+        for (u32 i = 0; i < budget; i++)
+            clock();
+
+        return budget;
+    }
+
+    u32 Emulator::runCyclesInstrumented(u32 budget)
+    {
+        Instrumentation instrumentation{ m_breakpoints, m_profiler, m_callProfiler };
+        m_CPU.setCallProfiler(instrumentation.callProfiler);
+        u32 cycles = instrumentation.run(budget,
+            [this]() { return m_CPU.getCPUStatus().PC; },
+            []() { return true; },
+            [this]() { clock(); return 1u; });
+        m_CPU.setCallProfiler(nullptr);
+        return cycles;
+    }
+
+    void Emulator::saveState(std::vector<u8>& state) const
+    {
+        StateWriter writer{ state, STATE_ID, STATE_VERSION };
+        writer.writeBytes(m_RAM, RAM_SIZE);
+        m_CPU.saveState(writer);
+    }
+
+    bool Emulator::loadState(std::span<const u8> state)
+    {
+        StateReader reader{ state, STATE_ID, STATE_VERSION };
+        if (!reader.isValid())
+            return false;
+
+        reader.readBytes(m_RAM, RAM_SIZE);
+        m_CPU.loadState(reader);
+
+        return reader.isValid() && reader.isAtEnd();
+    }
+
+    Emulator::Emulator()
     {
-        size_t size = BIOS_SIZE;
-        if (!readFile("rom/psx/SCPH-1001.bin", (char*)m_BIOS, size, true)) {
+        if (firmware::psx_bios.size() >= BIOS_SIZE)
+            m_BIOS = firmware::psx_bios.data();
+        else if (m_BIOSFile.open("rom/psx/SCPH-1001.bin", MappedFile::Mode::ReadOnly, BIOS_SIZE))
+            m_BIOS = m_BIOSFile.getData();
+        else {
             std::cerr << "Could not read BIOS ROM file!\n";
             assert(false);
+            m_missingBIOS = std::make_unique<u8[]>(BIOS_SIZE);
+            m_BIOS = m_missingBIOS.get();
         }
 
         m_BIOSPatches.emplace(0xBFC02B60, [this]() {
@@ -103,7 +143,8 @@ namespace PSX {
                 << "  len: " << std::hex << status.regs[6] << '\n';
 
             bool isMemcpyValid = true;
-            u8* dstPtr = nullptr, * srcPtr = nullptr;
+            u8* dstPtr = nullptr;
+            const u8* srcPtr = nullptr;
             u32 dstAddress = maskRegion(status.regs[4]);
             u32 dstOffset;
             if (RAM_RANGE.contains(dstAddress, dstOffset)) {
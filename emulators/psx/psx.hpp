@@ -1,6 +1,18 @@
 #pragma once
-#include "shared/source/imgui/disassembly_view.hpp" // TODO: to much spagetti
 #include "cpu.hpp"
+#include "shared/source/mapped_file.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+class Breakpoints;
+class CallProfiler;
+class DisassemblyIndex;
+class PCProfiler;
 
 namespace PSX {
 
@@ -14,12 +26,28 @@ namespace PSX {
 	public:
 		void reset();
 		void clock();
+		// Emulator is clocked once per instruction, so budget is in instructions.
+		u32 runCycles(u32 budget);
+
+		// BIOS is not part of the state. Machine has to be reset when loading fails.
+		void saveState(std::vector<u8>& state) const;
+		bool loadState(std::span<const u8> state);
 
 		const CPU& getCPU() const { return m_CPU; }
 
-		explicit Emulator(Disassembly& disasm); // TODO: to much spagetti
+		// Executed PCs are recorded only while an index is set, nullptr detaches it.
+		void setDisassemblyIndex(DisassemblyIndex* index) { m_disasmIndex.store(index, std::memory_order_release); }
+		// While breakpoints are armed runCycles() stops at hits. There are no watchpoints, PSX has no page table.
+		void setBreakpoints(Breakpoints* breakpoints) { m_breakpoints = breakpoints; }
+		// While profiler is enabled runCycles() records every instruction in it, each counted as one cycle.
+		void setProfiler(PCProfiler* profiler) { m_profiler = profiler; }
+		// While call profiler is enabled runCycles() reports calls and returns to it.
+		void setCallProfiler(CallProfiler* profiler) { m_callProfiler = profiler; }
+
+		Emulator();
 		u8 memoryRead8(u32 address) const;
 	private:
+		u32 runCyclesInstrumented(u32 budget);
 		u16 memoryRead16(u32 address) const;
 		u32 memoryRead32(u32 address) const;
 		void memoryWrite8(u32 address, u8 data);
@@ -27,13 +55,18 @@ namespace PSX {
 		void memoryWrite32(u32 address, u32 data);
 
 		u8 m_RAM[RAM_SIZE];
-		u8 m_BIOS[BIOS_SIZE];
+		MappedFile m_BIOSFile;
+		std::unique_ptr<u8[]> m_missingBIOS; // zeros when BIOS file couldn't be mapped
+		const u8* m_BIOS = nullptr;
 		CPU m_CPU;
 
 		bool m_enableBIOSPatches = true;
 		std::unordered_map<u32, std::function<void()>> m_BIOSPatches;
 
-		Disassembly& m_disasm;
+		std::atomic<DisassemblyIndex*> m_disasmIndex = nullptr;
+		Breakpoints* m_breakpoints = nullptr;
+		PCProfiler* m_profiler = nullptr;
+		CallProfiler* m_callProfiler = nullptr;
 	};
 
 } // namespace PSX
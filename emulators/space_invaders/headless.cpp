@@ -0,0 +1,35 @@
+#include "invaders.hpp"
+
+#include "shared/source/headless_application.hpp"
+
+#include <memory>
+
+class InvadersHeadless :
+    public HeadlessApplication
+{
+public:
+    explicit InvadersHeadless(Invaders& invaders) :
+        HeadlessApplication{ {
+                .name = "space_invaders",
+                .screenWidth = SCREEN_WIDTH,
+                .screenHeight = SCREEN_HEIGHT,
+                .cyclesPerFrame = 1000000 / 60,
+                .clockFrequency = 1000000,
+                .needsROM = false
+        } },
+        m_invaders{ invaders }
+    {}
+private:
+    void setCallProfiler(CallProfiler* profiler) override { m_invaders.setCallProfiler(profiler); }
+    u32 runCycles(u32 budget) override { return m_invaders.runCycles(budget); }
+    std::span<const u32> acquireScreenPixels() override { return m_invaders.getVideo().acquireScreenPixels(); }
+
+    Invaders& m_invaders;
+};
+
+int main(int argc, char* argv[])
+{
+    std::unique_ptr<Invaders> invaders = std::make_unique<Invaders>();
+    InvadersHeadless app{ *invaders.get() };
+    return app.run(argc, argv);
+}
@@ -1,7 +1,9 @@
 #include "invaders.hpp"
 #include "shared/source/address_range.hpp"
 #include "shared/source/file_io.hpp"
+#include "shared/source/save_state.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cstring>
@@ -9,27 +11,70 @@
 static const AddressRange16 ROM_RANGE{ 0x0000, 0x1FFF };
 static const AddressRange16 RAM_RANGE{ 0x2000, 0x4000 };
 
+static constexpr u32 STATE_ID = makeStateID("INVD");
+static constexpr u32 STATE_VERSION = 1;
+
 void Invaders::reset()
 {
     m_cpu.reset();
+    m_scheduler.reset();
+    m_video.reset();
     runUntilNextInstruction();
 }
 
 void Invaders::clock()
 {
     m_cpu.clock();
-    m_video.clock();
+    m_scheduler.advance(1);
+}
+
+u32 Invaders::runCycles(u32 budget)
+{
+    u32 cycles = 0;
+    while (cycles < budget) {
+        u32 slice = (u32)std::min<u64>(budget - cycles, m_scheduler.getCyclesUntilNextEvent());
+        u32 sliceCycles = m_cpu.runCycles(slice);
+        m_scheduler.advance(sliceCycles);
+        cycles += sliceCycles;
+
+        // CPU stopped at a breakpoint.
+        if (sliceCycles < slice)
+            break;
+    }
+
+    return cycles;
 }
 
 void Invaders::runUntilNextInstruction()
 {
-    do {
-        clock();
-    } while (m_cpu.getCyclesLeft() > 0);
+    runCycles(1);
+}
+
+void Invaders::saveState(std::vector<u8>& state) const
+{
+    StateWriter writer{ state, STATE_ID, STATE_VERSION };
+    writer.writeBytes(m_RAM, sizeof(m_RAM));
+    m_cpu.saveState(writer);
+    m_io.saveState(writer);
+    m_scheduler.saveState(writer);
+}
+
+bool Invaders::loadState(std::span<const u8> state)
+{
+    StateReader reader{ state, STATE_ID, STATE_VERSION };
+    if (!reader.isValid())
+        return false;
+
+    reader.readBytes(m_RAM, sizeof(m_RAM));
+    m_cpu.loadState(reader);
+    m_io.loadState(reader);
+    m_scheduler.loadState(reader);
+
+    return reader.isValid() && reader.isAtEnd();
 }
 
 Invaders::Invaders() :
-    m_video{ m_cpu, m_VRAM }
+    m_video{ m_cpu, m_scheduler, m_VRAM }
 {
     constexpr size_t ROM_SIZE = 0x800;
     size_t offset = 0;
@@ -1,17 +1,32 @@
 #pragma once
 #include "shared/source/devices/cpu8080/cpu8080.hpp"
+#include "shared/source/scheduler.hpp"
 #include "video.hpp"
 #include "io.hpp"
 
+#include <span>
+#include <vector>
+
 class Invaders
 {
 public:
     void reset();
     void clock();
+    u32 runCycles(u32 budget);
     void runUntilNextInstruction();
+    void setBreakpoints(Breakpoints* breakpoints) { m_cpu.setBreakpoints(breakpoints); }
+    void setProfiler(PCProfiler* profiler) { m_cpu.setProfiler(profiler); }
+    void setCallProfiler(CallProfiler* profiler) { m_cpu.setCallProfiler(profiler); }
+    void mapTraceCallback(CPU8080::TraceCallback callback) { m_cpu.mapTraceCallback(callback); }
+    void setTraceEnabled(bool enabled) { m_cpu.setTraceEnabled(enabled); }
+
+    // ROM is not part of the state. Machine has to be reset when loading fails.
+    void saveState(std::vector<u8>& state) const;
+    bool loadState(std::span<const u8> state);
 
     const CPU8080& getCPU() const { return m_cpu; }
     const Video& getVideo() const { return m_video; }
+    Video& getVideo() { return m_video; }
     u8 memoryRead(u16 address) const;
 
     Invaders();
@@ -21,6 +36,7 @@ private:
     void memoryWrite(u16 address, u8 data);
 
     CPU8080 m_cpu;
+    Scheduler m_scheduler;
     u8 m_ROM[0x2000];
     u8 m_RAM[0x2000];
     u8* m_VRAM = m_RAM + 0x400;
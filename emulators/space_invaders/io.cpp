@@ -1,4 +1,5 @@
 #include "io.hpp"
+#include "shared/source/save_state.hpp"
 
 #include <cassert>
 #include <cstdio>
@@ -37,3 +38,17 @@ void IO::write8(u8 port, u8 data)
 
     assert(false && "Unhandled io write!");
 }
+
+void IO::saveState(StateWriter& writer) const
+{
+    writer.write(m_shiftAmount);
+    writer.write(m_shiftRegister);
+}
+
+void IO::loadState(StateReader& reader)
+{
+    u8 shiftAmount;
+    reader.read(shiftAmount);
+    m_shiftAmount = shiftAmount;
+    reader.read(m_shiftRegister);
+}
@@ -1,6 +1,9 @@
 #pragma once
 #include "shared/source/types.hpp"
 
+class StateWriter;
+class StateReader;
+
 class IO
 {
 public:
@@ -11,6 +14,9 @@ public:
 
     u8 read8(u8 port) const;
     void write8(u8 port, u8 data);
+
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
 private:
     u8 m_shiftAmount : 3;
     u16 m_shiftRegister;
@@ -1,9 +1,15 @@
 #include "invaders.hpp"
 
 #include "shared/source/application.hpp"
+#include "shared/source/breakpoints.hpp"
+#include "shared/source/call_profiler.hpp"
+#include "shared/source/frame_pacer.hpp"
 #include "shared/source/imgui/debug_view.hpp"
 #include "shared/source/imgui/disassembly_view.hpp"
+#include "shared/source/imgui/profiler_view.hpp"
 #include "shared/source/disassembly_line.hpp"
+#include "shared/source/pc_profiler.hpp"
+#include "shared/source/spsc_ring.hpp"
 #include "shared/source/devices/cpu8080/disasm8080.hpp"
 
 #include <imgui.h>
@@ -24,13 +30,31 @@ public:
         } },
         m_invaders{ invaders },
         m_debugView{ m_isPaused },
-        m_disassemblyView{ m_disassembly, 4 }  {
+        m_disassemblyView{ 0x0000, 0x3FFF, 4, 1, 3 },
+        m_profilerView{ 4 },
+        m_traceRing{ TRACE_RING_CAPACITY }  {
+
+        m_breakpoints.mapReadRegisterCallback({ "A", "B", "C", "D", "E", "H", "L", "SP" }, [this](u32 index) -> u32 {
+            const auto& state = m_invaders.getCPU().getState();
+            const u32 values[] = { state.A, state.B, state.C, state.D, state.E, state.H, state.L, state.SP };
+            return values[index];
+        });
+        m_invaders.setBreakpoints(&m_breakpoints);
+        m_debugView.breakpoints = &m_breakpoints;
+        m_invaders.setProfiler(&m_profiler);
+        m_invaders.setCallProfiler(&m_callProfiler);
+        m_invaders.mapTraceCallback([this](u16 pc) { recordInstruction(pc); });
+        m_profilerView.profiler = &m_profiler;
+        m_profilerView.callProfiler = &m_callProfiler;
         
+        m_disassemblyView.read8 = [this](u32 address) { return m_invaders.memoryRead((u16)address); };
+        m_disassemblyView.decode = [](u32, const u8* bytes, DisassemblyLine& line) -> u32 {
+            return disasmIntruction(bytes[0], bytes[1], bytes[2], line);
+        };
+
         m_debugView.stepCallback = [&]() {
-            if (m_isPaused) {
+            if (m_isPaused)
                 m_invaders.runUntilNextInstruction();
-                updateDisassembly();
-            }
         };
 
         m_debugView.cpuStatusCallback = [&]() {
@@ -45,44 +69,45 @@ public:
             ImGui::Text("DE: %04X", cpuStatus.DE); ImGui::SameLine();
             ImGui::Text("HL: %04X", cpuStatus.HL);
 
+            // Records are formatted only here, while the window is open, newest first.
             ImGui::SeparatorText("Instruction Trace");
-            for (size_t i = 0; i < INSTRUCTION_TRACE_CAPACITY; i++) {
-                ImGui::Text("0x%04X: %.*s", m_intructionTrace[i].address, DisassemblyLine::BUFFER_SIZE, m_intructionTrace[i].buffer);
+            for (size_t i = 0; i < std::min(m_traceCount, INSTRUCTION_TRACE_CAPACITY); i++) {
+                const TraceRecord& record = m_instructionTrace[(m_traceCount - 1 - i) % INSTRUCTION_TRACE_CAPACITY];
+                DisassemblyLine line;
+                disasmIntruction(record.bytes[0], record.bytes[1], record.bytes[2], line);
+                ImGui::Text("0x%04X: %.*s", record.address, DisassemblyLine::BUFFER_SIZE, line.buffer);
             }
         };
-
-        updateDisassembly();
     }
 
-    void updateDisassembly() {
-        u16 pc = m_invaders.getCPU().getState().PC;
-        u8 opcode = m_invaders.memoryRead(pc);
-        u8 byte1 = m_invaders.memoryRead(pc + 1);
-        u8 byte2 = m_invaders.memoryRead(pc + 2);
-        DisassemblyLine line;
-        disasmIntruction(opcode, byte1, byte2, line);
-        line.address = pc;
-
-        for (size_t i = INSTRUCTION_TRACE_CAPACITY - 1; i > 0; i--) {
-            m_intructionTrace[i] = m_intructionTrace[i - 1];
-        }
-        m_intructionTrace[0] = line;
+    bool isPaused() const { return m_isPaused; }
+private:
+    struct TraceRecord
+    {
+        u16 address;
+        u8 bytes[3];
+    };
 
-        auto i = m_disassembly.begin();
-        for (; i != m_disassembly.end(); i++)
-            if (i->address >= line.address)
-                break;
+    // Called by the thread that runs emulation for every instruction while Debug window is open,
+    // only raw bytes are captured.
+    void recordInstruction(u16 pc) {
+        TraceRecord record;
+        record.address = pc;
+        for (u16 i = 0; i < 3; i++)
+            record.bytes[i] = m_invaders.memoryRead(record.address + i);
+        m_traceRing.push(record);
+    }
 
-        if (m_disassembly.empty() || i == m_disassembly.end()) {
-            m_disassembly.push_back(line);
-        }
-        else if (line.address == i->address) *i = line;
-        else m_disassembly.insert(i, line);
+    void drainInstructionTrace() {
+        TraceRecord record;
+        while (m_traceRing.pop(record))
+            m_instructionTrace[m_traceCount++ % INSTRUCTION_TRACE_CAPACITY] = record;
     }
 
-    bool isPaused() const { return m_isPaused; }
-private:
-    std::span<const unsigned int> getScreenPixels() const override { return m_invaders.getVideo().getScreenPixels(); }
+    ScreenFrame acquireScreenFrame() override {
+        auto pixels = m_invaders.getVideo().acquireScreenPixels();
+        return { pixels, m_invaders.getVideo().getScreenSequence() };
+    }
 
     void onImGUIRender() override {
         ImGui::BeginMainMenuBar();
@@ -101,38 +126,49 @@ private:
         {
             ImGui::MenuItem("Debug Control&Status", nullptr, &m_debugView.open);
             ImGui::MenuItem("Disassembly", nullptr, &m_disassemblyView.open);
+            ImGui::MenuItem("Profiler", nullptr, &m_profilerView.open);
             ImGui::EndMenu();
         }
         ImGui::EndMainMenuBar();
 
+        m_invaders.setTraceEnabled(m_debugView.open);
+        drainInstructionTrace();
+
         m_debugView.updateWindow();
         m_disassemblyView.updateWindow(m_invaders.getCPU().getState().PC);
+        m_profilerView.updateWindow();
     }
 
-    Disassembly m_disassembly; // TODO(Kostu): move this inside DisassemblyView
     Invaders& m_invaders;
+    Breakpoints m_breakpoints{ 16 };
     bool m_isPaused = false;
     imgui::DebugView m_debugView;
     imgui::DisassemblyView m_disassemblyView;
+    PCProfiler m_profiler{ 16 };
+    CallProfiler m_callProfiler;
+    imgui::ProfilerView m_profilerView;
     static constexpr size_t INSTRUCTION_TRACE_CAPACITY = 8;
-    DisassemblyLine m_intructionTrace[INSTRUCTION_TRACE_CAPACITY];
+    static constexpr size_t TRACE_RING_CAPACITY = 8192; // more than instructions in a frame
+    SPSCRing<TraceRecord> m_traceRing;
+    TraceRecord m_instructionTrace[INSTRUCTION_TRACE_CAPACITY]; // GUI thread only
+    size_t m_traceCount = 0;
 };
 
+static constexpr u32 CYCLES_PER_FRAME = 1000000 / 60;
+
 int main()
 {
     std::unique_ptr<Invaders> invaders = std::make_unique<Invaders>();
+    FramePacer pacer{ 60.0 };
     InvadersApp app{ *invaders.get() };
 
     std::thread emuThread{
         [&]() {
+            pacer.reset();
             while (app.isRunning()) {
-                //std::this_thread::sleep_for(std::chrono::nanoseconds{ 32 }); // TODO: temp
-                if (!app.isPaused()) {
-                    invaders->clock();
-                    if (invaders->getCPU().getCyclesLeft() == 0) {
-                        app.updateDisassembly();
-                    }
-                }
+                if (!app.isPaused())
+                    invaders->runCycles(CYCLES_PER_FRAME);
+                pacer.waitForNextFrame();
             }
         }
     };
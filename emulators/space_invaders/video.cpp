@@ -1,37 +1,43 @@
 #include "video.hpp"
 #include "shared/source/devices/cpu8080/cpu8080.hpp"
 
-void Video::reset()
+static constexpr u64 COUNTS_PER_FRAME = 1000000 / 60; // TODO(Kostu): do math from 2MHz
+static constexpr u64 COUNTS_PER_HALFFRAME = COUNTS_PER_FRAME / 2;
+
+Video::Video(CPU8080& cpu, Scheduler& scheduler, const u8* VRAM) :
+    m_cpuRef{ cpu },
+    m_schedulerRef{ scheduler },
+    m_VRAM{ VRAM },
+    m_frames{ std::vector<u32>(SCREEN_WIDTH * SCREEN_HEIGHT, 0xFF000000) }
 {
-    m_counter = 0;
+    m_halfFrameEvent = m_schedulerRef.registerEvent([this]() {
+        drawLines(0, 0xE00);
+        m_cpuRef.interrupt(0x08);
+        m_schedulerRef.scheduleIn(m_halfFrameEvent, COUNTS_PER_FRAME);
+    });
+
+    m_frameEvent = m_schedulerRef.registerEvent([this]() {
+        drawLines(0xE00, 0x1C00);
+        m_frames.publish();
+        m_cpuRef.interrupt(0x10);
+        m_schedulerRef.scheduleIn(m_frameEvent, COUNTS_PER_FRAME);
+    });
 }
 
-void Video::clock()
+void Video::reset()
 {
-    m_counter++;
-
-    constexpr size_t COUNTS_PER_FRAME = 1000000 / 60;
-    constexpr size_t COUNTS_PER_HALFFRAME = COUNTS_PER_FRAME / 2;
+    m_schedulerRef.scheduleIn(m_halfFrameEvent, COUNTS_PER_HALFFRAME);
+    m_schedulerRef.scheduleIn(m_frameEvent, COUNTS_PER_FRAME);
+}
 
-    if (m_counter == COUNTS_PER_HALFFRAME) { // TODO(Kostu): do math from 2MHz
-        size_t index = 0;
-        for (const u8* ptr = m_VRAM; ptr < m_VRAM + 0xE00; ptr++) {
-            u8 byte = *ptr;
-            for (size_t i = 0; i < 8; i++) {
-                    m_screenPixels[index++] = ((byte >> i) & 1) ? 0xFFFFFFFF : 0xFF000000;
-            }
-        }
-        m_cpuRef.interrupt(0x08);
-    }
-    else if (m_counter == COUNTS_PER_FRAME) {
-        size_t index = 28672;
-        for (const u8* ptr = m_VRAM + 0xE00; ptr < m_VRAM + 0x1C00; ptr++) {
-            u8 byte = *ptr;
-            for (size_t i = 0; i < 8; i++) {
-                m_screenPixels[index++] = ((byte >> i) & 1) ? 0xFFFFFFFF : 0xFF000000;
-            }
+void Video::drawLines(u16 firstByte, u16 lastByte)
+{
+    u32* pixels = m_frames.getWriteBuffer().data();
+    size_t index = firstByte * 8;
+    for (const u8* ptr = m_VRAM + firstByte; ptr < m_VRAM + lastByte; ptr++) {
+        u8 byte = *ptr;
+        for (size_t i = 0; i < 8; i++) {
+            pixels[index++] = ((byte >> i) & 1) ? 0xFFFFFFFF : 0xFF000000;
         }
-        m_cpuRef.interrupt(0x10);
-        m_counter = 0;
     }
 }
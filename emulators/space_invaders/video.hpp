@@ -1,7 +1,9 @@
 #pragma once
-#include "shared/source/types.hpp"
+#include "shared/source/scheduler.hpp"
+#include "shared/source/triple_buffer.hpp"
 
 #include <span>
+#include <vector>
 
 constexpr u16 SCREEN_WIDTH = 256;
 constexpr u16 SCREEN_HEIGHT = 224;
@@ -11,18 +13,23 @@ class CPU8080;
 class Video
 {
 public:
-    Video(CPU8080& cpu, const u8* VRAM) : m_cpuRef{ cpu }, m_VRAM{ VRAM } {};
+    Video(CPU8080& cpu, Scheduler& scheduler, const u8* VRAM);
 
     void reset();
-    void clock();
 
-    std::span<const u32> getScreenPixels() const { return { m_screenPixels, SCREEN_WIDTH * SCREEN_HEIGHT }; }
+    // Frame is published at the end of the frame, safe to call from other thread.
+    std::span<const u32> acquireScreenPixels() { return m_frames.acquire(); }
+    u64 getScreenSequence() const { return m_frames.getSequence(); }
 
     Video(const Video&) = delete;
     Video& operator=(const Video&) = delete;
 private:
+    void drawLines(u16 firstByte, u16 lastByte);
+
     CPU8080& m_cpuRef;
+    Scheduler& m_schedulerRef;
+    Scheduler::EventID m_halfFrameEvent;
+    Scheduler::EventID m_frameEvent;
     const u8* m_VRAM;
-    u32 m_screenPixels[SCREEN_WIDTH * SCREEN_HEIGHT];
-    u32 m_counter = 0;
+    TripleBuffer<std::vector<u32>> m_frames;
 };
@@ -0,0 +1,35 @@
+#include "vic20.hpp"
+
+#include "shared/source/headless_application.hpp"
+
+#include <memory>
+
+class VIC20Headless :
+    public HeadlessApplication
+{
+public:
+    explicit VIC20Headless(VIC20& vic20) :
+        HeadlessApplication{ {
+                .name = "vic20",
+                .screenWidth = VIC20::SCREEN_WIDTH,
+                .screenHeight = VIC20::SCREEN_HEIGHT,
+                .cyclesPerFrame = 312 * 71,
+                .clockFrequency = 1108405,
+                .needsROM = false
+        } },
+        m_vic20{ vic20 }
+    {}
+private:
+    void setCallProfiler(CallProfiler* profiler) override { m_vic20.setCallProfiler(profiler); }
+    u32 runCycles(u32 budget) override { return m_vic20.runCycles(budget); }
+    std::span<const u32> acquireScreenPixels() override { return m_vic20.getScreenPixels(); }
+
+    VIC20& m_vic20;
+};
+
+int main(int argc, char* argv[])
+{
+    std::unique_ptr<VIC20> vic20 = std::make_unique<VIC20>();
+    VIC20Headless app{ *vic20.get() };
+    return app.run(argc, argv);
+}
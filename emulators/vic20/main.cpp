@@ -1,6 +1,7 @@
 #include "vic20.hpp"
 
 #include "shared/source/application.hpp"
+#include "shared/source/frame_pacer.hpp"
 
 #include <glad/gl.h>
 #include <glw/glw.hpp>
@@ -26,21 +27,26 @@ public:
         m_vic20{ vic20 }
     {}
 private:
-    std::span<const unsigned int> getScreenPixels() const override { return m_vic20.getScreenPixels(); }
+    ScreenFrame acquireScreenFrame() override { return { m_vic20.getScreenPixels(), 0 }; }
 
     VIC20& m_vic20;
 };
 
+static constexpr u32 CYCLES_PER_FRAME = 312 * 71; // PAL
+static constexpr double FRAMES_PER_SECOND = 1108405.0 / CYCLES_PER_FRAME;
+
 int main()
 {
     std::unique_ptr<VIC20> vic20 = std::make_unique<VIC20>();
+    FramePacer pacer{ FRAMES_PER_SECOND };
     VIC20App app{ *vic20.get() };
 
     std::thread emuThread{
         [&]() {
+            pacer.reset();
             while (app.isRunning()) {
-                std::this_thread::sleep_for(std::chrono::nanoseconds{ 24 }); // TODO: temp
-                vic20->clock();
+                vic20->runCycles(CYCLES_PER_FRAME);
+                pacer.waitForNextFrame();
             }
         }
     };
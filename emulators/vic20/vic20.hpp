@@ -1,5 +1,7 @@
 #pragma once
 #include "shared/source/devices/cpu6502/cpu6502.hpp"
+#include "shared/source/firmware.hpp"
+#include "shared/source/memory_bus.hpp"
 
 #include <array>
 #include <span>
@@ -15,21 +17,24 @@ public:
     VIC20();
 
     void clock();
+    u32 runCycles(u32 budget);
+    void setBreakpoints(Breakpoints* breakpoints) { m_cpu.setBreakpoints(breakpoints); m_bus.setBreakpoints(breakpoints); }
+    void setProfiler(PCProfiler* profiler) { m_cpu.setProfiler(profiler); }
+    void setCallProfiler(CallProfiler* profiler) { m_cpu.setCallProfiler(profiler); }
 
     std::span<const u32> getScreenPixels() const { return m_screenPixels; }
 private:
-    u8 memoryRead(u16 address) const;
-    void memoryWrite(u16 address, u8 data);
+    MemoryBus16 m_bus;
 
     u8 m_LOW_RAM[0x400];
     u8 m_RAM[0x1000];
 
-    u8 m_CHARACTERS[0x1000];
+    Firmware m_CHARACTERS;
 
-    u8 m_BASIC[0x2000];
-    u8 m_KERNAL[0x2000];
+    Firmware m_BASIC;
+    Firmware m_KERNAL;
 
-    CPU6502 m_cpu{};
+    CPU6502Core<MemoryBus16> m_cpu{ m_bus };
 
     std::array<u32, SCREEN_WIDTH * SCREEN_HEIGHT> m_screenPixels;
 };
@@ -15,6 +15,10 @@ static void glfwErrorCallback(int error, const char* description)
 static void glfwKeyCallback(GLFWwindow* window, int key, int /*scancode*/, int action, int mods)
 {
     auto app = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
+    if (key == GLFW_KEY_BACKSPACE && app->supportsRewind()) {
+        app->setRewinding(action != GLFW_RELEASE);
+        return;
+    }
     app->onKeyCallback(key, action, mods);
 }
 
@@ -85,8 +89,11 @@ void Application::run()
 
         glw::Renderer::beginFrame();
         glViewport(m_viewportX, m_viewportY, m_viewportWidth, m_viewportHeight);
-        auto pixels = getScreenPixels();
-        m_screenTexture->setData(pixels.data(), pixels.size() * sizeof(unsigned int));
+        auto frame = acquireScreenFrame();
+        if (frame.sequence != m_screenSequence) {
+            m_screenTexture->setData(frame.pixels.data(), frame.pixels.size() * sizeof(unsigned int));
+            m_screenSequence = frame.sequence;
+        }
         m_screenTexture->bind(0);
         glw::Renderer::renderTexture(-1.f, 1.f, 1.f, -1.f, 0.f, 0.f, 1.f, 1.f);
         glw::Renderer::endFrame();
@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <memory>
 #include <span>
 
@@ -26,10 +27,22 @@ public:
     void run();
     void exit();
     bool isRunning() const { return m_isRunning; }
+    // True while rewind key (Backspace) is held, emulation thread should step back instead of running.
+    // Only apps that support rewind get it, the key goes to onKeyCallback() for all others.
+    bool isRewinding() const { return m_isRewinding.load(std::memory_order_relaxed); }
+    void setRewinding(bool rewinding) { m_isRewinding.store(rewinding, std::memory_order_relaxed); }
 
-    virtual std::span<const unsigned int> getScreenPixels() const = 0;
+    struct ScreenFrame
+    {
+        std::span<const unsigned int> pixels;
+        unsigned long long sequence; // has to change whenever pixels do, texture upload is skipped otherwise
+    };
+
+    // Called from render thread, should return newest completed frame.
+    virtual ScreenFrame acquireScreenFrame() = 0;
     virtual void onImGUIRender() {}
 
+    virtual bool supportsRewind() const { return false; }
     virtual void onKeyCallback(int /*key*/, int /*action*/, int /*mods*/) {}
     virtual void onTextCallback(unsigned int /*codepoint*/) {}
 
@@ -38,7 +51,9 @@ public:
 private:
     GLFWwindow* m_window = nullptr;
     std::unique_ptr<glw::Texture> m_screenTexture{};
+    unsigned long long m_screenSequence = ~0ull;
     bool m_isRunning = false;
+    std::atomic<bool> m_isRewinding = false;
     int m_viewportX;
     int m_viewportY;
     int m_viewportWidth;
@@ -0,0 +1,175 @@
+#include "breakpoints.hpp"
+
+#include <cassert>
+
+Breakpoints::Breakpoints(u32 addressBits, u32 alignmentShift) :
+    m_alignmentShift{ alignmentShift },
+    m_indexMask{ addressBits - alignmentShift >= 32 ? 0xFFFFFFFFu : (1u << (addressBits - alignmentShift)) - 1 },
+    m_pageCount{ (m_indexMask >> PAGE_BITS) + 1 },
+    m_pages{ new std::atomic<Page*>[m_pageCount]{} }
+{
+    assert(addressBits > alignmentShift && addressBits <= 32);
+}
+
+Breakpoints::~Breakpoints()
+{
+    for (u32 i = 0; i < m_pageCount; i++)
+        delete m_pages[i].load(std::memory_order_relaxed);
+}
+
+void Breakpoints::mapReadRegisterCallback(std::vector<const char*> registerNames, ReadRegisterCallback callback)
+{
+    m_registerNames = std::move(registerNames);
+    m_readRegister = callback;
+}
+
+void Breakpoints::addBreakpoint(u32 address)
+{
+    add(address, EXECUTE, nullptr);
+}
+
+void Breakpoints::addBreakpoint(u32 address, Condition condition)
+{
+    assert(condition.registerIndex < m_registerNames.size() && "Condition on unknown register!");
+    add(address, EXECUTE, &condition);
+}
+
+void Breakpoints::addWatchpoint(u32 address, u8 flags)
+{
+    assert((flags & ~(READ | WRITE)) == 0 && "Watchpoint can only watch reads and writes!");
+    add(address, flags, nullptr);
+}
+
+void Breakpoints::remove(u32 address)
+{
+    std::lock_guard lock{ m_mutex };
+    auto it = m_entries.find(address);
+    if (it == m_entries.end())
+        return;
+
+    bool wasWatched = it->second.flags & (READ | WRITE);
+    m_entries.erase(it);
+    storeFlags(address, 0);
+    m_entryCount.store((u32)m_entries.size(), std::memory_order_relaxed);
+    if (wasWatched)
+        m_watchGeneration.fetch_add(1, std::memory_order_release);
+}
+
+void Breakpoints::clear()
+{
+    std::lock_guard lock{ m_mutex };
+    for (auto& [address, entry] : m_entries)
+        storeFlags(address, 0);
+
+    m_entries.clear();
+    m_entryCount.store(0, std::memory_order_relaxed);
+    m_watchGeneration.fetch_add(1, std::memory_order_release);
+}
+
+std::vector<Breakpoints::Entry> Breakpoints::getEntries() const
+{
+    std::lock_guard lock{ m_mutex };
+    std::vector<Entry> entries;
+    entries.reserve(m_entries.size());
+    for (auto& [address, entry] : m_entries)
+        entries.push_back(entry);
+
+    return entries;
+}
+
+u8 Breakpoints::getWatchFlags(u32 first, u32 last) const
+{
+    std::lock_guard lock{ m_mutex };
+    u8 flags = 0;
+    for (auto it = m_entries.lower_bound(first); it != m_entries.end() && it->first <= last; it++)
+        flags |= it->second.flags & (READ | WRITE);
+
+    return flags;
+}
+
+void Breakpoints::checkAccess(u32 address, bool isWrite)
+{
+    u8 type = isWrite ? WRITE : READ;
+    if (getFlags(address) & type)
+        setHit(address, type);
+}
+
+bool Breakpoints::getHit(u32& address, u8& type) const
+{
+    if (!hasHit())
+        return false;
+
+    address = m_hitAddress.load(std::memory_order_relaxed);
+    type = m_hitType.load(std::memory_order_relaxed);
+    return true;
+}
+
+void Breakpoints::resume()
+{
+    if (m_hasHit.exchange(false, std::memory_order_acq_rel))
+        m_skipHit.store(m_hitType.load(std::memory_order_relaxed) == EXECUTE, std::memory_order_release);
+}
+
+bool Breakpoints::hitExecute(u32 pc)
+{
+    // Instruction we stopped at has to run once when resuming, or it would break again right away.
+    if (m_skipHit.exchange(false, std::memory_order_acq_rel) && pc == m_hitAddress.load(std::memory_order_relaxed))
+        return false;
+
+    if (getFlags(pc) & HAS_CONDITION) {
+        Condition condition;
+        {
+            std::lock_guard lock{ m_mutex };
+            auto it = m_entries.find(pc);
+            if (it == m_entries.end() || !it->second.hasCondition)
+                return false;
+            condition = it->second.condition;
+        }
+
+        if (!m_readRegister || m_readRegister(condition.registerIndex) != condition.value)
+            return false;
+    }
+
+    setHit(pc, EXECUTE);
+    return true;
+}
+
+void Breakpoints::setHit(u32 address, u8 type)
+{
+    m_hitAddress.store(address, std::memory_order_relaxed);
+    m_hitType.store(type, std::memory_order_relaxed);
+    m_hasHit.store(true, std::memory_order_release);
+}
+
+void Breakpoints::add(u32 address, u8 flags, const Condition* condition)
+{
+    std::lock_guard lock{ m_mutex };
+    Entry& entry = m_entries[address];
+    entry.address = address;
+    entry.flags |= flags;
+    if (flags & EXECUTE) {
+        entry.hasCondition = condition != nullptr;
+        if (condition)
+            entry.condition = *condition;
+    }
+
+    storeFlags(address, entry.flags | (entry.hasCondition ? HAS_CONDITION : 0));
+    m_entryCount.store((u32)m_entries.size(), std::memory_order_relaxed);
+    if (flags & (READ | WRITE))
+        m_watchGeneration.fetch_add(1, std::memory_order_release);
+}
+
+void Breakpoints::storeFlags(u32 address, u8 flags)
+{
+    u32 index = (address >> m_alignmentShift) & m_indexMask;
+    Page* page = m_pages[index >> PAGE_BITS].load(std::memory_order_relaxed);
+    if (!page) {
+        if (flags == 0)
+            return;
+
+        page = new Page;
+        m_pages[index >> PAGE_BITS].store(page, std::memory_order_release);
+    }
+
+    page->flags[index & PAGE_MASK].store(flags, std::memory_order_relaxed);
+}
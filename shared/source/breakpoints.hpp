@@ -0,0 +1,118 @@
+#pragma once
+#include "types.hpp"
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Execute breakpoints and memory watchpoints, shared by all CPUs.
+// Flags are kept per address in lazily allocated pages. CPUs test them only in a checked
+// run loop, see Instrumentation, entered when something is armed, so plain emulation pays
+// nothing per instruction.
+// Watchpoints are enforced by memory page tables, see MemoryBus16::syncWatchpoints().
+//
+// Breakpoints are edited from any thread and checked by the emulation thread.
+class Breakpoints
+{
+public:
+    enum Flags : u8 {
+        EXECUTE = 1 << 0,
+        READ    = 1 << 1,
+        WRITE   = 1 << 2
+    };
+
+    // Breaks only when register at given index holds the value, evaluated on hit.
+    struct Condition
+    {
+        u32 registerIndex;
+        u32 value;
+    };
+
+    struct Entry
+    {
+        u32 address;
+        u8 flags;
+        bool hasCondition;
+        Condition condition;
+    };
+
+    using ReadRegisterCallback = std::function<u32(u32 index)>;
+
+    // Addresses are shifted right by alignmentShift and have to fit in remaining addressBits.
+    explicit Breakpoints(u32 addressBits = 16, u32 alignmentShift = 0);
+    ~Breakpoints();
+
+    void mapReadRegisterCallback(std::vector<const char*> registerNames, ReadRegisterCallback callback);
+    const std::vector<const char*>& getRegisterNames() const { return m_registerNames; }
+
+    void addBreakpoint(u32 address);
+    void addBreakpoint(u32 address, Condition condition);
+    void addWatchpoint(u32 address, u8 flags);
+    void remove(u32 address);
+    void clear();
+    std::vector<Entry> getEntries() const;
+
+    bool isArmed() const { return m_entryCount.load(std::memory_order_relaxed) != 0; }
+    // Changes whenever set of watched addresses does, page tables compare it to know when to update.
+    u32 getWatchGeneration() const { return m_watchGeneration.load(std::memory_order_acquire); }
+    // READ and WRITE flags of all watchpoints in range.
+    u8 getWatchFlags(u32 first, u32 last) const;
+
+    // emulation thread:
+    bool checkExecute(u32 pc)
+    {
+        return (getFlags(pc) & EXECUTE) && hitExecute(pc);
+    }
+    void checkAccess(u32 address, bool isWrite);
+    bool hasHit() const { return m_hasHit.load(std::memory_order_acquire); }
+
+    // Address and type (one of Flags) of the last hit, false when there was none.
+    bool getHit(u32& address, u8& type) const;
+    // Continues after a hit, breakpoint that was hit is skipped once.
+    void resume();
+
+    Breakpoints(const Breakpoints&) = delete;
+    Breakpoints& operator=(const Breakpoints&) = delete;
+private:
+    static constexpr u32 PAGE_BITS = 12;
+    static constexpr u32 PAGE_MASK = (1u << PAGE_BITS) - 1;
+    static constexpr u8 HAS_CONDITION = 1 << 7;
+
+    struct Page
+    {
+        std::atomic<u8> flags[1u << PAGE_BITS]{};
+    };
+
+    u8 getFlags(u32 address) const
+    {
+        u32 index = (address >> m_alignmentShift) & m_indexMask;
+        const Page* page = m_pages[index >> PAGE_BITS].load(std::memory_order_acquire);
+        return page ? page->flags[index & PAGE_MASK].load(std::memory_order_relaxed) : 0;
+    }
+
+    bool hitExecute(u32 pc);
+    void setHit(u32 address, u8 type);
+    void add(u32 address, u8 flags, const Condition* condition);
+    void storeFlags(u32 address, u8 flags);
+
+    const u32 m_alignmentShift;
+    const u32 m_indexMask;
+    const u32 m_pageCount;
+    std::unique_ptr<std::atomic<Page*>[]> m_pages;
+
+    mutable std::mutex m_mutex;
+    std::map<u32, Entry> m_entries; // guarded by m_mutex, flags in pages mirror it
+    std::atomic<u32> m_entryCount{ 0 };
+    std::atomic<u32> m_watchGeneration{ 0 };
+
+    std::vector<const char*> m_registerNames;
+    ReadRegisterCallback m_readRegister = nullptr;
+
+    std::atomic<bool> m_hasHit{ false };
+    std::atomic<u32> m_hitAddress{ 0 };
+    std::atomic<u8> m_hitType{ 0 };
+    std::atomic<bool> m_skipHit{ false };
+};
@@ -0,0 +1,130 @@
+#include "call_profiler.hpp"
+#include "file_io.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+CallProfiler::CallProfiler() :
+    m_nodes{ new Node[MAX_NODES] }
+{
+    m_nodes[ROOT].parent = ROOT;
+    m_nodes[ROOT].address = 0;
+    m_nodes[ROOT].depth = 0;
+}
+
+void CallProfiler::call(u32 target)
+{
+    if (m_untrackedDepth > 0 || m_nodes[m_currentNode].depth == MAX_DEPTH) {
+        m_untrackedDepth++;
+        return;
+    }
+
+    u64 key = (u64)m_currentNode << 32 | target;
+    auto it = m_children.find(key);
+    u32 node;
+    if (it != m_children.end())
+        node = it->second;
+    else {
+        node = m_nodeCount.load(std::memory_order_relaxed);
+        if (node == MAX_NODES) {
+            m_untrackedDepth++;
+            return;
+        }
+
+        m_nodes[node].parent = m_currentNode;
+        m_nodes[node].address = target;
+        m_nodes[node].depth = m_nodes[m_currentNode].depth + 1;
+        m_nodeCount.store(node + 1, std::memory_order_release);
+        m_children.emplace(key, node);
+    }
+
+    auto& calls = m_nodes[node].calls;
+    calls.store(calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    m_currentNode = node;
+}
+
+void CallProfiler::ret()
+{
+    if (m_untrackedDepth > 0)
+        m_untrackedDepth--;
+    else
+        m_currentNode = m_nodes[m_currentNode].parent;
+}
+
+std::vector<CallProfiler::Function> CallProfiler::getFunctions() const
+{
+    u32 nodeCount = m_nodeCount.load(std::memory_order_acquire);
+
+    // Children are always created after their parents, so walking backwards sums whole subtrees.
+    std::vector<u64> totals(nodeCount);
+    for (u32 i = 0; i < nodeCount; i++)
+        totals[i] = m_nodes[i].selfCycles.load(std::memory_order_relaxed);
+    for (u32 i = nodeCount; i-- > 1;)
+        totals[m_nodes[i].parent] += totals[i];
+
+    std::unordered_map<u32, Function> functions;
+    for (u32 i = 1; i < nodeCount; i++) {
+        const Node& node = m_nodes[i];
+        Function& function = functions.try_emplace(node.address, Function{ node.address, 0, 0, 0 }).first->second;
+        function.calls += node.calls.load(std::memory_order_relaxed);
+        function.exclusiveCycles += node.selfCycles.load(std::memory_order_relaxed);
+
+        bool isRecursive = false;
+        for (u32 parent = node.parent; parent != ROOT && !isRecursive; parent = m_nodes[parent].parent)
+            isRecursive = m_nodes[parent].address == node.address;
+        if (!isRecursive)
+            function.inclusiveCycles += totals[i];
+    }
+
+    std::vector<Function> result;
+    result.reserve(functions.size());
+    for (auto& [address, function] : functions)
+        result.push_back(function);
+
+    std::sort(result.begin(), result.end(),
+        [](const Function& a, const Function& b) { return a.inclusiveCycles > b.inclusiveCycles; });
+    return result;
+}
+
+void CallProfiler::clear()
+{
+    u32 nodeCount = m_nodeCount.load(std::memory_order_acquire);
+    for (u32 i = 0; i < nodeCount; i++) {
+        m_nodes[i].calls.store(0, std::memory_order_relaxed);
+        m_nodes[i].selfCycles.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool CallProfiler::exportCollapsedStacks(const char* filename, unsigned int addressWidth) const
+{
+    u32 nodeCount = m_nodeCount.load(std::memory_order_acquire);
+
+    std::string text;
+    std::vector<u32> stack;
+    char frame[16];
+    for (u32 i = 0; i < nodeCount; i++) {
+        u64 cycles = m_nodes[i].selfCycles.load(std::memory_order_relaxed);
+        if (cycles == 0) continue;
+
+        // Cycles outside of any call seen by the profiler.
+        if (i == ROOT)
+            text += "[root]";
+
+        stack.clear();
+        for (u32 node = i; node != ROOT; node = m_nodes[node].parent)
+            stack.push_back(m_nodes[node].address);
+
+        for (auto it = stack.rbegin(); it != stack.rend(); it++) {
+            int length = std::snprintf(frame, sizeof(frame), "%0*X", (int)addressWidth, *it);
+            if (it != stack.rbegin()) text += ';';
+            text.append(frame, length);
+        }
+
+        text += ' ';
+        text += std::to_string(cycles);
+        text += '\n';
+    }
+
+    return writeFile(filename, text.data(), text.size());
+}
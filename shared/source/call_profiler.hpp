@@ -0,0 +1,75 @@
+#pragma once
+#include "types.hpp"
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Cycles per guest function, attributed through a shadow call stack.
+// CPUs report call and return instructions, every distinct stack becomes a node of a call tree
+// that accumulates cycles spent directly in it. Exclusive and inclusive cycles per function
+// are summed from the tree when queried, and the tree exports as collapsed stacks
+// ("outer;inner cycles" lines) that flamegraph tools read directly.
+//
+// Returns without a matching call are ignored at the top of the stack, so enabling the profiler
+// in the middle of a routine only loses attribution of that routine's callers.
+// One thread records, any thread can query and enable.
+class CallProfiler
+{
+public:
+    struct Function
+    {
+        u32 address;
+        u64 calls;
+        u64 inclusiveCycles;
+        u64 exclusiveCycles;
+    };
+
+    CallProfiler();
+
+    void setEnabled(bool enabled) { m_isEnabled.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return m_isEnabled.load(std::memory_order_relaxed); }
+
+    // emulation thread:
+    void call(u32 target);
+    void ret();
+    // Node instruction was started in, so cycles of calls go to the caller and of returns to the callee.
+    u32 getCurrentNode() const { return m_currentNode; }
+    void addCycles(u32 node, u32 cycles)
+    {
+        auto& self = m_nodes[node].selfCycles;
+        self.store(self.load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+    }
+
+    // Sorted by inclusive cycles. Recursive calls are counted once in inclusive cycles.
+    std::vector<Function> getFunctions() const;
+    // Call tree structure is kept, counts recorded while clearing may survive it.
+    void clear();
+    bool exportCollapsedStacks(const char* filename, unsigned int addressWidth) const;
+
+    CallProfiler(const CallProfiler&) = delete;
+    CallProfiler& operator=(const CallProfiler&) = delete;
+private:
+    static constexpr u32 MAX_NODES = 1 << 16;
+    static constexpr u32 MAX_DEPTH = 256;
+    static constexpr u32 ROOT = 0;
+
+    struct Node
+    {
+        u32 parent;
+        u32 address;
+        u32 depth;
+        std::atomic<u64> calls{ 0 };
+        std::atomic<u64> selfCycles{ 0 };
+    };
+
+    std::unique_ptr<Node[]> m_nodes;
+    std::atomic<u32> m_nodeCount{ 1 }; // published after node is filled in
+    std::atomic<bool> m_isEnabled{ false };
+
+    // emulation thread only:
+    std::unordered_map<u64, u32> m_children; // (parent << 32 | address) -> node
+    u32 m_currentNode = ROOT;
+    u32 m_untrackedDepth = 0; // calls past MAX_DEPTH or MAX_NODES, their returns must not pop tracked frames
+};
@@ -3,13 +3,19 @@
 
 #include <functional>
 
-class CPU6502
+class Breakpoints;
+class CallProfiler;
+class PCProfiler;
+class StateWriter;
+class StateReader;
+
+// Bus has to provide u8 read8(u16) and void write8(u16, u8).
+// Implementation lives in cpu6502.inl and is explicitly instantiated in cpu6502.cpp.
+template<typename Bus>
+class CPU6502Core
 {
 public:
-    using ReadMemoryCallback = std::function<u8(u16)>;
-    using WriteMemoryCallback = std::function<void(u16, u8)>;
-    void mapReadMemoryCallback(ReadMemoryCallback callback) { load8 = callback; }
-    void mapWriteMemoryCallback(WriteMemoryCallback callback) { store8 = callback; }
+    explicit CPU6502Core(Bus& bus) : m_bus{ bus } {}
 
     union Flags
     {
@@ -28,25 +34,44 @@ public:
 
     void reset();
     void clock();
+    u32 runInstruction();
+    u32 runCycles(u32 budget);
     void setIRQ(bool state) { m_irq = state; }
     void setNMI(bool state) { m_nmi = state; }
 
     void setPC(u16 value) { PC = value; }
     u16 getPC() const { return PC; }
     Flags getFlags() const { return F; }
+    u8 getA() const { return ACC; }
+    u8 getX() const { return X; }
+    u8 getY() const { return Y; }
+    u8 getSP() const { return SP; }
+
+    // While breakpoints are armed runCycles() stops before breakpoint and after watchpoint hits,
+    // returning less cycles than budget, and does not run again until the hit is resumed.
+    void setBreakpoints(Breakpoints* breakpoints) { m_breakpoints = breakpoints; }
+    // While profiler is enabled runCycles() records every instruction in it.
+    void setProfiler(PCProfiler* profiler) { m_profiler = profiler; }
+    // While call profiler is enabled runCycles() reports JSR, RTS, RTI and interrupts to it.
+    void setCallProfiler(CallProfiler* profiler) { m_callProfiler = profiler; }
+
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
 
     // test only:
     void runUntilEndlessLoop();
 
-    CPU6502() = default;
-    CPU6502(CPU6502&) = delete;
-    CPU6502& operator=(CPU6502&) = delete;
+    CPU6502Core(CPU6502Core&) = delete;
+    CPU6502Core& operator=(CPU6502Core&) = delete;
 private:
+    u32 runCyclesInstrumented(u32 budget);
+    void executeInstruction();
     void IRQ();
     void NMI();
 
-    ReadMemoryCallback load8 = nullptr;
-    WriteMemoryCallback store8 = nullptr;
+    Bus& m_bus;
+    u8 load8(u16 address) const { return m_bus.read8(address); }
+    void store8(u16 address, u8 data) const { m_bus.write8(address, data); }
     u16 load16(u16 address) const { return load8(address) | (load8(address + 1) << 8); }
     void store16(u16 address, u16 data) const { store8(address, data & 0xFF); store8(address + 1, data >> 8); }
     void push8(u8 data) { store8(0x100 + SP--, data); }
@@ -115,4 +140,41 @@ private:
     bool m_irq = false;
     bool m_nmi = false;
     bool m_isDuringNMI = false;
+    Breakpoints* m_breakpoints = nullptr;
+    PCProfiler* m_profiler = nullptr;
+    CallProfiler* m_callProfiler = nullptr;
+    CallProfiler* m_activeCallProfiler = nullptr; // set only inside runCyclesInstrumented()
+};
+
+class CPU6502CallbackBus
+{
+public:
+    using ReadMemoryCallback = std::function<u8(u16)>;
+    using WriteMemoryCallback = std::function<void(u16, u8)>;
+    void mapReadMemoryCallback(ReadMemoryCallback callback) { load8 = callback; }
+    void mapWriteMemoryCallback(WriteMemoryCallback callback) { store8 = callback; }
+
+    u8 read8(u16 address) const { return load8(address); }
+    void write8(u16 address, u8 data) const { store8(address, data); }
+private:
+    ReadMemoryCallback load8 = nullptr;
+    WriteMemoryCallback store8 = nullptr;
 };
+
+// Callback based variant, bus is the first base so it is constructed before the core.
+class CPU6502 :
+    private CPU6502CallbackBus,
+    public CPU6502Core<CPU6502CallbackBus>
+{
+public:
+    using CPU6502CallbackBus::ReadMemoryCallback;
+    using CPU6502CallbackBus::WriteMemoryCallback;
+    using CPU6502CallbackBus::mapReadMemoryCallback;
+    using CPU6502CallbackBus::mapWriteMemoryCallback;
+
+    CPU6502() : CPU6502Core{ *static_cast<CPU6502CallbackBus*>(this) } {}
+};
+
+class MemoryBus16;
+extern template class CPU6502Core<CPU6502CallbackBus>;
+extern template class CPU6502Core<MemoryBus16>;
@@ -1,4 +1,6 @@
 #include "cpu8080.hpp"
+#include "../../instrumentation.hpp"
+#include "../../save_state.hpp"
 
 #include <bitset>
 #include <cassert>
@@ -76,24 +78,117 @@ void CPU8080::clock()
     }
 
     if (m_cyclesLeft == 0)
-    {
-        if (m_interruptRequested) {
-            m_interruptRequested = false;
-            push16(m_state.PC);
-            m_state.PC = m_interruptVector;
-        }
+        executeNextInstruction();
 
-        if (!m_isHalted) {
-            u8 opcode = loadMemory8(m_state.PC++);
+    if (m_cyclesLeft > 0)
+        m_cyclesLeft--;
+}
 
-            executeInstruction(opcode);
-            m_cyclesLeft += m_conditionalTaken ? conditionalCycleCounts[opcode] : standardCycleCounts[opcode];
-            m_conditionalTaken = false;
+u32 CPU8080::runInstruction()
+{
+    // Finish instruction started with clock() if there is one.
+    if (m_cyclesLeft == 0) {
+        if (m_EIRequested) {
+            m_EIRequested = false;
+            m_interruptEnabled = true;
         }
+
+        executeNextInstruction();
     }
 
-    if (m_cyclesLeft > 0)
-        m_cyclesLeft--;
+    // Halted CPU idles one cycle at a time.
+    u32 cycles = m_cyclesLeft > 0 ? m_cyclesLeft : 1;
+    m_cyclesLeft = 0;
+
+    // clock() would apply it on the following cycle.
+    if (m_EIRequested) {
+        m_EIRequested = false;
+        m_interruptEnabled = true;
+    }
+
+    return cycles;
+}
+
+u32 CPU8080::runCycles(u32 budget)
+{
+    if ((m_breakpoints && m_breakpoints->isArmed()) || (m_profiler && m_profiler->isEnabled()) ||
+        (m_callProfiler && m_callProfiler->isEnabled()) || m_isTraceEnabled.load(std::memory_order_relaxed))
+        return runCyclesInstrumented(budget);
+
+    u32 cycles = 0;
+    while (cycles < budget)
+        cycles += runInstruction();
+
+    return cycles;
+}
+
+u32 CPU8080::runCyclesInstrumented(u32 budget)
+{
+    Instrumentation instrumentation{ m_breakpoints, m_profiler, m_callProfiler };
+    bool isTracing = traceInstruction && m_isTraceEnabled.load(std::memory_order_relaxed);
+    m_activeCallProfiler = instrumentation.callProfiler;
+    u32 cycles = instrumentation.run(budget,
+        [this]() -> u32 { return m_state.PC; },
+        [this]() { return m_cyclesLeft == 0; },
+        [this, isTracing]() {
+            if (isTracing && m_cyclesLeft == 0)
+                traceInstruction(m_state.PC);
+            return runInstruction();
+        });
+    m_activeCallProfiler = nullptr;
+    return cycles;
+}
+
+void CPU8080::saveState(StateWriter& writer) const
+{
+    writer.write(m_state.PC);
+    writer.write(m_state.SP);
+    writer.write(m_state.AF);
+    writer.write(m_state.BC);
+    writer.write(m_state.DE);
+    writer.write(m_state.HL);
+    writer.write(m_cyclesLeft);
+    writer.write(m_interruptVector);
+    writer.write(m_interruptRequested);
+    writer.write(m_interruptEnabled);
+    writer.write(m_isHalted);
+    writer.write(m_conditionalTaken);
+    writer.write(m_EIRequested);
+}
+
+void CPU8080::loadState(StateReader& reader)
+{
+    reader.read(m_state.PC);
+    reader.read(m_state.SP);
+    reader.read(m_state.AF);
+    reader.read(m_state.BC);
+    reader.read(m_state.DE);
+    reader.read(m_state.HL);
+    reader.read(m_cyclesLeft);
+    reader.read(m_interruptVector);
+    reader.read(m_interruptRequested);
+    reader.read(m_interruptEnabled);
+    reader.read(m_isHalted);
+    reader.read(m_conditionalTaken);
+    reader.read(m_EIRequested);
+}
+
+void CPU8080::executeNextInstruction()
+{
+    if (m_interruptRequested) {
+        m_interruptRequested = false;
+        push16(m_state.PC);
+        m_state.PC = m_interruptVector;
+        if (m_activeCallProfiler) m_activeCallProfiler->call(m_state.PC);
+    }
+
+    if (!m_isHalted) {
+        u8 opcode = loadMemory8(m_state.PC++);
+
+        executeInstruction(opcode);
+        m_cyclesLeft += m_conditionalTaken ? conditionalCycleCounts[opcode] : standardCycleCounts[opcode];
+        m_conditionalTaken = false;
+    }
 }
 
 void CPU8080::executeInstruction(u8 opcode)
@@ -420,6 +515,7 @@ void CPU8080::CALL(bool flag)
         m_conditionalTaken = true;
         push16(m_state.PC);
         m_state.PC = address;
+        if (m_activeCallProfiler) m_activeCallProfiler->call(m_state.PC);
     }
 }
 
@@ -523,6 +619,7 @@ void CPU8080::RET(bool flag)
     if (flag) {
         m_conditionalTaken = true;
         m_state.PC = pop16();
+        if (m_activeCallProfiler) m_activeCallProfiler->ret();
     }
 }
 
@@ -550,6 +647,7 @@ void CPU8080::RST(u8 vector)
 {
     push16(m_state.PC);
     m_state.PC = vector * 8;
+    if (m_activeCallProfiler) m_activeCallProfiler->call(m_state.PC);
 }
 
 void CPU8080::SUB(u8 value)
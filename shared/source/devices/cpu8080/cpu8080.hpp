@@ -1,8 +1,15 @@
 #pragma once
 #include "shared/source/types.hpp"
 
+#include <atomic>
 #include <functional>
 
+class Breakpoints;
+class CallProfiler;
+class PCProfiler;
+class StateWriter;
+class StateReader;
+
 class CPU8080
 {
 public:
@@ -59,15 +66,33 @@ public:
     void mapWriteMemoryCallback(WriteMemoryCallback callback) { storeMemory8 = callback; }
     void mapReadIOCallback(ReadIOCallback callback) { loadIO8 = callback; }
     void mapWriteIOCallback(WriteIOCallback callback) { storeIO8 = callback; }
+    // Called with PC before every instruction runCycles() runs while tracing is enabled.
+    using TraceCallback = std::function<void(u16)>;
+    void mapTraceCallback(TraceCallback callback) { traceInstruction = callback; }
 
     void reset();
     bool interrupt(u8 vector);
     void clock();
+    u32 runInstruction();
+    u32 runCycles(u32 budget);
 
     const State& getState() const { return m_state; }
     State& getState() { return m_state; }
     u8 getCyclesLeft() const { return m_cyclesLeft; }
 
+    // While breakpoints are armed runCycles() stops before breakpoint and after watchpoint hits,
+    // returning less cycles than budget, and does not run again until the hit is resumed.
+    void setBreakpoints(Breakpoints* breakpoints) { m_breakpoints = breakpoints; }
+    // While profiler is enabled runCycles() records every instruction in it.
+    void setProfiler(PCProfiler* profiler) { m_profiler = profiler; }
+    // While call profiler is enabled runCycles() reports CALL, RET, RST and interrupts to it.
+    void setCallProfiler(CallProfiler* profiler) { m_callProfiler = profiler; }
+    // Can be switched from any thread, takes effect on next runCycles().
+    void setTraceEnabled(bool enabled) { m_isTraceEnabled.store(enabled, std::memory_order_relaxed); }
+
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
     CPU8080() = default;
     CPU8080(CPU8080&) = delete;
     CPU8080& operator=(CPU8080&) = delete;
@@ -76,6 +101,7 @@ private:
     WriteMemoryCallback storeMemory8 = nullptr;
     ReadIOCallback loadIO8 = nullptr;
     WriteIOCallback storeIO8 = nullptr;
+    TraceCallback traceInstruction = nullptr;
     u16 loadMemory16(u16 address) const { return loadMemory8(address) | (loadMemory8(address + 1) << 8); }
     void storeMemory16(u16 address, u16 data) const { storeMemory8(address, data & 0xFF); storeMemory8(address + 1, data >> 8); }
     void push8(u8 data) { storeMemory8(--m_state.SP, data); }
@@ -83,6 +109,8 @@ private:
     u8 pop8() { return loadMemory8(m_state.SP++); }
     u16 pop16() { m_state.SP += 2; return loadMemory16(m_state.SP - 2); }
 
+    u32 runCyclesInstrumented(u32 budget);
+    void executeNextInstruction();
     void executeInstruction(u8 opcode);
 
     void setFlagsArithmeticStandard(u16 result, u8 auxiliaryResult);
@@ -122,4 +150,10 @@ private:
     bool m_isHalted;
     bool m_conditionalTaken;
     bool m_EIRequested;
+
+    Breakpoints* m_breakpoints = nullptr;
+    PCProfiler* m_profiler = nullptr;
+    CallProfiler* m_callProfiler = nullptr;
+    CallProfiler* m_activeCallProfiler = nullptr; // set only inside runCyclesInstrumented()
+    std::atomic<bool> m_isTraceEnabled{ false };
 };
@@ -293,11 +293,13 @@ void disassemble(const u8* code, size_t code_size, std::vector<DisassemblyLine>&
 #undef INST3
 }
 
-void disasmIntruction(u8 opcode, u8 byte1, u8 byte2, DisassemblyLine& output)
+u8 disasmIntruction(u8 opcode, u8 byte1, u8 byte2, DisassemblyLine& output)
 {
 #define INST1(mnemonic) sprintf_s(output.buffer, DisassemblyLine::BUFFER_SIZE, mnemonic)
-#define INST2(mnemonic) sprintf_s(output.buffer, DisassemblyLine::BUFFER_SIZE, mnemonic " 0x%02X", byte1)
-#define INSTW(mnemonic) sprintf_s(output.buffer, DisassemblyLine::BUFFER_SIZE, mnemonic " 0x%04X", (u16)byte2 << 8 | byte1)
+#define INST2(mnemonic) length = 2; sprintf_s(output.buffer, DisassemblyLine::BUFFER_SIZE, mnemonic " 0x%02X", byte1)
+#define INSTW(mnemonic) length = 3; sprintf_s(output.buffer, DisassemblyLine::BUFFER_SIZE, mnemonic " 0x%04X", (u16)byte2 << 8 | byte1)
+
+    u8 length = 1;
 
     switch (opcode)
     {
@@ -328,6 +330,7 @@ void disasmIntruction(u8 opcode, u8 byte1, u8 byte2, DisassemblyLine& output)
     case 0x19: INST1("DAD DE"); break;
     case 0x1A: INST1("LDAX DE"); break;
 
+    case 0x1E: INST2("MVI E,"); break;
     case 0x1F: INST1("RAR"); break;
 
     case 0x21: INSTW("LXI HL,"); break;
@@ -340,6 +343,7 @@ void disasmIntruction(u8 opcode, u8 byte1, u8 byte2, DisassemblyLine& output)
     case 0x2A: INSTW("LHLD"); break;
     case 0x2B: INST1("DEC HL"); break;
 
+    case 0x2E: INST2("MVI L,"); break;
     case 0x2F: INST1("CMA"); break;
 
     case 0x31: INSTW("LXI SP,"); break;
@@ -496,7 +500,9 @@ void disasmIntruction(u8 opcode, u8 byte1, u8 byte2, DisassemblyLine& output)
     case 0xC9: INST1("RET"); break;
     case 0xCA: INSTW("JZ"); break;
 
+    case 0xCC: INSTW("CZ"); break;
     case 0xCD: INSTW("CALL"); break;
+    case 0xCE: INST2("ACI"); break;
 
     case 0xD0: INST1("RET NC"); break;
     case 0xD1: INST1("POP DE"); break;
@@ -510,33 +516,46 @@ void disasmIntruction(u8 opcode, u8 byte1, u8 byte2, DisassemblyLine& output)
 
     case 0xDA: INSTW("JC"); break;
     case 0xDB: INST2("IN"); break;
+    case 0xDC: INSTW("CC"); break;
 
-    case 0xE1: INST1("POP HL"); break;
+    case 0xDE: INST2("SBI"); break;
 
+    case 0xE1: INST1("POP HL"); break;
+    case 0xE2: INSTW("JPO"); break;
     case 0xE3: INST1("XTHL"); break;
-
+    case 0xE4: INSTW("CPO"); break;
     case 0xE5: INST1("PUSH HL"); break;
     case 0xE6: INST2("ANI"); break;
 
     case 0xE9: INST1("PCHL"); break;
-
+    case 0xEA: INSTW("JPE"); break;
     case 0xEB: INST1("XCHG"); break;
+    case 0xEC: INSTW("CPE"); break;
+
+    case 0xEE: INST2("XRI"); break;
 
     case 0xF1: INST1("RP"); break;
+    case 0xF2: INSTW("JP"); break;
 
+    case 0xF4: INSTW("CP"); break;
     case 0xF5: INST1("PUSH AF"); break;
     case 0xF6: INST2("ORI"); break;
 
+    case 0xFA: INSTW("JM"); break;
     case 0xFB: INST1("EI"); break;
+    case 0xFC: INSTW("CM"); break;
 
     case 0xFE: INST2("CPI"); break;
 
     default:
-        assert(false);
+        // Not decoded yet or not an instruction at all, listings can start in the middle of data.
+        sprintf_s(output.buffer, DisassemblyLine::BUFFER_SIZE, "DB 0x%02X", opcode);
         break;
     }
 
 #undef INST1
 #undef INST2
 #undef INSTW
+
+    return length;
 }
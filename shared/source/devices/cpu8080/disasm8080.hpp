@@ -7,4 +7,5 @@ struct DisassemblyLine;
 
 void disassemble(const u8* code, size_t code_size, std::vector<DisassemblyLine>& output);
 
-void disasmIntruction(u8 opcode, u8 byte1, u8 byte2, DisassemblyLine& output);
+// Returns instruction length in bytes.
+u8 disasmIntruction(u8 opcode, u8 byte1, u8 byte2, DisassemblyLine& output);
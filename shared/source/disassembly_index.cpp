@@ -0,0 +1,150 @@
+#include "disassembly_index.hpp"
+
+#include <algorithm>
+#include <bit>
+
+static u32 selectBit(u64 word, u32 n)
+{
+    while (n--)
+        word &= word - 1;
+    return (u32)std::countr_zero(word);
+}
+
+DisassemblyIndex::DisassemblyIndex(u32 indexBits, u32 alignmentShift) :
+    m_alignmentShift{ alignmentShift },
+    m_indexMask{ indexBits >= 32 ? 0xFFFFFFFFu : (1u << indexBits) - 1 },
+    m_pageCount{ 1u << (std::max(indexBits, PAGE_BITS) - PAGE_BITS) },
+    m_groupCount{ (m_pageCount + (1u << GROUP_BITS) - 1) >> GROUP_BITS },
+    m_pages{ new std::atomic<Page*>[m_pageCount]{} },
+    m_groupCounts{ new std::atomic<u32>[m_groupCount]{} }
+{}
+
+DisassemblyIndex::~DisassemblyIndex()
+{
+    for (u32 i = 0; i < m_pageCount; i++)
+        delete m_pages[i].load(std::memory_order_relaxed);
+}
+
+bool DisassemblyIndex::contains(u32 address) const
+{
+    u32 index = (address >> m_alignmentShift) & m_indexMask;
+    const Page* page = m_pages[index >> PAGE_BITS].load(std::memory_order_acquire);
+    return page && (page->words[(index & PAGE_MASK) / 64].load(std::memory_order_relaxed) & (1ull << index % 64));
+}
+
+u32 DisassemblyIndex::rank(u32 address) const
+{
+    u32 index = (address >> m_alignmentShift) & m_indexMask;
+    u32 pageIndex = index >> PAGE_BITS;
+    u32 group = pageIndex >> GROUP_BITS;
+
+    u32 result = 0;
+    for (u32 i = 0; i < group; i++)
+        result += m_groupCounts[i].load(std::memory_order_relaxed);
+
+    for (u32 i = group << GROUP_BITS; i < pageIndex; i++)
+        if (const Page* page = m_pages[i].load(std::memory_order_acquire))
+            result += page->count.load(std::memory_order_relaxed);
+
+    if (const Page* page = m_pages[pageIndex].load(std::memory_order_acquire)) {
+        u32 bit = index & PAGE_MASK;
+        for (u32 i = 0; i < bit / 64; i++)
+            result += (u32)std::popcount(page->words[i].load(std::memory_order_relaxed));
+        u64 below = (1ull << bit % 64) - 1;
+        result += (u32)std::popcount(page->words[bit / 64].load(std::memory_order_relaxed) & below);
+    }
+
+    return result;
+}
+
+bool DisassemblyIndex::select(u32 n, u32& address) const
+{
+    // Counts are updated after bits, so while recording they may briefly disagree and search fail.
+    u32 group = 0;
+    for (; group < m_groupCount; group++) {
+        u32 count = m_groupCounts[group].load(std::memory_order_relaxed);
+        if (n < count) break;
+        n -= count;
+    }
+    if (group == m_groupCount)
+        return false;
+
+    u32 lastPage = std::min((group + 1) << GROUP_BITS, m_pageCount);
+    for (u32 pageIndex = group << GROUP_BITS; pageIndex < lastPage; pageIndex++) {
+        const Page* page = m_pages[pageIndex].load(std::memory_order_acquire);
+        if (!page) continue;
+
+        u32 count = page->count.load(std::memory_order_relaxed);
+        if (n >= count) {
+            n -= count;
+            continue;
+        }
+
+        for (u32 i = 0; i < WORDS_PER_PAGE; i++) {
+            u64 word = page->words[i].load(std::memory_order_relaxed);
+            u32 wordCount = (u32)std::popcount(word);
+            if (n < wordCount) {
+                address = toAddress(pageIndex, i * 64 + selectBit(word, n));
+                return true;
+            }
+            n -= wordCount;
+        }
+        return false;
+    }
+
+    return false;
+}
+
+bool DisassemblyIndex::findNext(u32 address, u32& next) const
+{
+    u32 index = (address >> m_alignmentShift) & m_indexMask;
+    if (index == m_indexMask)
+        return false;
+    index++;
+
+    u32 pageIndex = index >> PAGE_BITS;
+    u32 bit = index & PAGE_MASK;
+    while (pageIndex < m_pageCount) {
+        // Whole empty groups are skipped without touching their pages.
+        if (m_groupCounts[pageIndex >> GROUP_BITS].load(std::memory_order_relaxed) == 0) {
+            pageIndex = ((pageIndex >> GROUP_BITS) + 1) << GROUP_BITS;
+            bit = 0;
+            continue;
+        }
+
+        if (const Page* page = m_pages[pageIndex].load(std::memory_order_acquire)) {
+            for (u32 i = bit / 64; i < WORDS_PER_PAGE; i++) {
+                u64 word = page->words[i].load(std::memory_order_relaxed);
+                if (i == bit / 64)
+                    word &= ~0ull << bit % 64;
+                if (word) {
+                    next = toAddress(pageIndex, i * 64 + (u32)std::countr_zero(word));
+                    return true;
+                }
+            }
+        }
+
+        pageIndex++;
+        bit = 0;
+    }
+
+    return false;
+}
+
+void DisassemblyIndex::insert(u32 index)
+{
+    u32 pageIndex = index >> PAGE_BITS;
+    Page* page = m_pages[pageIndex].load(std::memory_order_relaxed);
+    if (!page) {
+        page = new Page;
+        m_pages[pageIndex].store(page, std::memory_order_release);
+    }
+
+    u64 mask = 1ull << index % 64;
+    if (page->words[(index & PAGE_MASK) / 64].fetch_or(mask, std::memory_order_relaxed) & mask)
+        return;
+
+    page->count.fetch_add(1, std::memory_order_relaxed);
+    m_groupCounts[pageIndex >> GROUP_BITS].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "types.hpp"
+
+#include <atomic>
+#include <memory>
+
+// Set of addresses at which instructions were executed, for debugger listings.
+// Addresses are kept in a sparse bitmap: pages of it are allocated when first touched, and
+// per page and per group of pages counts answer rank/select without walking whole address space.
+// Recording an already seen address is a single bit test. One thread records, any thread can query.
+class DisassemblyIndex
+{
+public:
+    // Address shifted right by alignmentShift has to fit in indexBits bits.
+    DisassemblyIndex(u32 indexBits, u32 alignmentShift);
+    ~DisassemblyIndex();
+
+    void record(u32 address)
+    {
+        u32 index = (address >> m_alignmentShift) & m_indexMask;
+        const Page* page = m_pages[index >> PAGE_BITS].load(std::memory_order_acquire);
+        if (!page || !(page->words[(index & PAGE_MASK) / 64].load(std::memory_order_relaxed) & (1ull << index % 64)))
+            insert(index);
+    }
+
+    bool contains(u32 address) const;
+    u32 getCount() const { return m_count.load(std::memory_order_relaxed); }
+    // Number of recorded addresses lower than address.
+    u32 rank(u32 address) const;
+    // Finds n-th lowest recorded address.
+    bool select(u32 n, u32& address) const;
+    // Finds lowest recorded address greater than address.
+    bool findNext(u32 address, u32& next) const;
+
+    DisassemblyIndex(const DisassemblyIndex&) = delete;
+    DisassemblyIndex& operator=(const DisassemblyIndex&) = delete;
+private:
+    static constexpr u32 PAGE_BITS = 14;
+    static constexpr u32 PAGE_MASK = (1u << PAGE_BITS) - 1;
+    static constexpr u32 WORDS_PER_PAGE = (1u << PAGE_BITS) / 64;
+    static constexpr u32 GROUP_BITS = 8; // pages per group
+
+    struct Page
+    {
+        std::atomic<u64> words[WORDS_PER_PAGE]{};
+        std::atomic<u32> count{ 0 };
+    };
+
+    void insert(u32 index);
+    u32 toAddress(u32 page, u32 bit) const { return ((page << PAGE_BITS) | bit) << m_alignmentShift; }
+
+    const u32 m_alignmentShift;
+    const u32 m_indexMask;
+    const u32 m_pageCount;
+    const u32 m_groupCount;
+    std::unique_ptr<std::atomic<Page*>[]> m_pages;
+    std::unique_ptr<std::atomic<u32>[]> m_groupCounts;
+    std::atomic<u32> m_count{ 0 };
+};
@@ -1,6 +1,8 @@
 #pragma once
 #include "types.hpp"
 
+#include <vector>
+
 struct DisassemblyLine
 {
     static constexpr size_t BUFFER_SIZE = 28;
@@ -8,3 +10,5 @@ struct DisassemblyLine
     u32 address;
     char buffer[BUFFER_SIZE];
 };
+
+using Disassembly = std::vector<DisassemblyLine>;
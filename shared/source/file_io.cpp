@@ -11,13 +11,16 @@ bool readFile(const char* filename, char* data, size_t& size, bool binary)
     bool retVal;
     if (data) {
         retVal = (bool)fin.read(data, size);
+        size = fin.gcount();
     }
     else {
-        fin.ignore(std::numeric_limits<std::streamsize>::max());
-        retVal = true;
+        // Seeking gives the size without reading the whole file.
+        fin.seekg(0, std::ios::end);
+        std::streamoff end = fin.tellg();
+        retVal = end >= 0;
+        size = retVal ? (size_t)end : 0;
     }
 
-    size = fin.gcount();
     fin.close();
     return retVal;
 }
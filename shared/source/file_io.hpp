@@ -1,5 +1,6 @@
 #pragma once
 #include <stddef.h>
 
+// With data == nullptr only size of the file is returned. Large images can use MappedFile instead.
 bool readFile(const char* filename, char* data, size_t& size, bool binary = false);
 bool writeFile(const char* filename, const char* data, size_t size, bool binary = false);
@@ -0,0 +1,24 @@
+#include "firmware.hpp"
+#include "file_io.hpp"
+
+#include <iostream>
+
+bool Firmware::load(std::span<const u8> embedded, const char* filename, size_t size)
+{
+    // Dumps are sometimes padded, only the beginning is mapped anyway.
+    if (embedded.size() >= size) {
+        m_buffer.reset();
+        m_data = embedded.data();
+        return true;
+    }
+
+    m_buffer = std::make_unique<u8[]>(size);
+    m_data = m_buffer.get();
+
+    if (!readFile(filename, (char*)m_buffer.get(), size, true)) {
+        std::cerr << "Could not read ROM file: " << filename << '\n';
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "types.hpp"
+
+#include <memory>
+#include <span>
+
+// ROM image used in place when embed_firmware() linked it into the binary,
+// otherwise read at runtime from filename relative to working directory.
+class Firmware
+{
+public:
+    // Image that can't be read is reported and left zeroed, so machine never runs on uninitialized ROM.
+    bool load(std::span<const u8> embedded, const char* filename, size_t size);
+
+    const u8* getData() const { return m_data; }
+    bool isEmbedded() const { return m_data && !m_buffer; }
+private:
+    const u8* m_data = nullptr;
+    std::unique_ptr<u8[]> m_buffer;
+};
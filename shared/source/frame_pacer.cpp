@@ -0,0 +1,116 @@
+#include "frame_pacer.hpp"
+
+#include <cmath>
+#include <thread>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#endif
+
+// Being further behind than this means emulation was stopped or host can't keep up,
+// catching up would only produce a burst of frames.
+static constexpr auto MAX_LAG = std::chrono::milliseconds(100);
+static constexpr auto SLEEP_QUANTUM = std::chrono::milliseconds(1);
+
+FramePacer::FramePacer(double framesPerSecond) :
+    m_frameDuration{ 1e9 / framesPerSecond }
+{
+#if defined(_WIN32)
+    // Default timer resolution is ~15ms which would leave us spinning most of the frame.
+    timeBeginPeriod(1);
+#endif
+    reset();
+}
+
+FramePacer::~FramePacer()
+{
+#if defined(_WIN32)
+    timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::reset()
+{
+    m_deadline = Clock::now();
+}
+
+void FramePacer::waitForNextFrame()
+{
+    u32 speed = getSpeed();
+    if (speed == UNLIMITED_SPEED) {
+        m_deadline = Clock::now();
+        m_frames.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    m_deadline += std::chrono::duration_cast<Clock::duration>(m_frameDuration * 100.0 / speed);
+    auto now = Clock::now();
+    if (now - m_deadline > MAX_LAG) {
+        m_resyncs.fetch_add(1, std::memory_order_relaxed);
+        m_frames.fetch_add(1, std::memory_order_relaxed);
+        m_deadline = now;
+        return;
+    }
+
+    bool late = now > m_deadline;
+    sleepUntil(m_deadline);
+    recordDrift(Clock::now() - m_deadline, late);
+}
+
+FramePacer::Stats FramePacer::getStats() const
+{
+    Stats stats;
+    stats.frames = m_frames.load(std::memory_order_relaxed);
+    stats.lateFrames = m_lateFrames.load(std::memory_order_relaxed);
+    stats.resyncs = m_resyncs.load(std::memory_order_relaxed);
+    stats.lastDriftUs = m_lastDriftNs.load(std::memory_order_relaxed) / 1000;
+    stats.maxDriftUs = m_maxDriftNs.load(std::memory_order_relaxed) / 1000;
+    u64 pacedFrames = stats.frames - stats.resyncs;
+    stats.averageDriftUs = pacedFrames ? m_totalDriftNs.load(std::memory_order_relaxed) / (s64)pacedFrames / 1000 : 0;
+    return stats;
+}
+
+void FramePacer::resetStats()
+{
+    m_frames.store(0, std::memory_order_relaxed);
+    m_lateFrames.store(0, std::memory_order_relaxed);
+    m_resyncs.store(0, std::memory_order_relaxed);
+    m_lastDriftNs.store(0, std::memory_order_relaxed);
+    m_maxDriftNs.store(0, std::memory_order_relaxed);
+    m_totalDriftNs.store(0, std::memory_order_relaxed);
+}
+
+void FramePacer::sleepUntil(Clock::time_point deadline)
+{
+    // Sleep in short quanta while there is more time left than a sleep is expected to take.
+    while (deadline - Clock::now() > std::chrono::duration<double, std::nano>(m_sleepEstimateNs)) {
+        auto start = Clock::now();
+        std::this_thread::sleep_for(SLEEP_QUANTUM);
+        double sleptNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        // Welford's online variance
+        m_sleepCount++;
+        double delta = sleptNs - m_sleepMeanNs;
+        m_sleepMeanNs += delta / m_sleepCount;
+        m_sleepM2 += delta * (sleptNs - m_sleepMeanNs);
+        m_sleepEstimateNs = m_sleepMeanNs + std::sqrt(m_sleepM2 / (m_sleepCount - 1));
+    }
+
+    while (Clock::now() < deadline)
+        std::this_thread::yield();
+}
+
+void FramePacer::recordDrift(Clock::duration drift, bool late)
+{
+    s64 driftNs = std::chrono::duration_cast<std::chrono::nanoseconds>(drift).count();
+    m_frames.fetch_add(1, std::memory_order_relaxed);
+    if (late)
+        m_lateFrames.fetch_add(1, std::memory_order_relaxed);
+    m_lastDriftNs.store(driftNs, std::memory_order_relaxed);
+    m_totalDriftNs.fetch_add(driftNs, std::memory_order_relaxed);
+    if (driftNs > m_maxDriftNs.load(std::memory_order_relaxed))
+        m_maxDriftNs.store(driftNs, std::memory_order_relaxed);
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "types.hpp"
+
+#include <atomic>
+#include <chrono>
+
+// Keeps emulation thread in sync with real time. Machine is run in frame sized slices
+// and waitForNextFrame() is called after each of them. Pacer sleeps while the deadline
+// is far away and spins only the last bit, which it can't trust the OS scheduler with.
+class FramePacer
+{
+public:
+    static constexpr u32 UNLIMITED_SPEED = 0;
+
+    struct Stats
+    {
+        u64 frames;
+        u64 lateFrames; // frames whose emulation didn't finish before their deadline
+        u64 resyncs;    // times pacer was too far behind and restarted timing from now
+        s64 lastDriftUs; // wake up time minus deadline, positive when late
+        s64 maxDriftUs;
+        s64 averageDriftUs;
+    };
+
+    explicit FramePacer(double framesPerSecond);
+    ~FramePacer();
+
+    // Speed in percent of real time, UNLIMITED_SPEED turns pacing off. Can be changed from any thread.
+    void setSpeed(u32 percent) { m_speed.store(percent, std::memory_order_relaxed); }
+    u32 getSpeed() const { return m_speed.load(std::memory_order_relaxed); }
+
+    // Restarts timing from now, has to be called when emulation was stopped for a while.
+    void reset();
+    void waitForNextFrame();
+
+    // Can be called from any thread.
+    Stats getStats() const;
+    void resetStats();
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void sleepUntil(Clock::time_point deadline);
+    void recordDrift(Clock::duration drift, bool late);
+
+    const std::chrono::duration<double, std::nano> m_frameDuration;
+    std::atomic<u32> m_speed{ 100 };
+    Clock::time_point m_deadline;
+
+    // Running estimate of how long a short sleep really takes (mean + standard deviation).
+    double m_sleepEstimateNs = 5e6;
+    double m_sleepMeanNs = 5e6;
+    double m_sleepM2 = 0.0;
+    u64 m_sleepCount = 1;
+
+    std::atomic<u64> m_frames{ 0 };
+    std::atomic<u64> m_lateFrames{ 0 };
+    std::atomic<u64> m_resyncs{ 0 };
+    std::atomic<s64> m_lastDriftNs{ 0 };
+    std::atomic<s64> m_maxDriftNs{ 0 };
+    std::atomic<s64> m_totalDriftNs{ 0 };
+};
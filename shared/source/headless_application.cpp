@@ -0,0 +1,118 @@
+#include "shared/source/headless_application.hpp"
+#include "shared/source/call_profiler.hpp"
+#include "shared/source/file_io.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+int HeadlessApplication::run(int argc, char* argv[])
+{
+    const char* romPath = nullptr;
+    const char* dumpPath = nullptr;
+    const char* callProfilePath = nullptr;
+    u64 frames = 60;
+    u64 cycles = 0;
+    bool printSerial = false;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--frames") == 0 && hasValue) frames = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--cycles") == 0 && hasValue) cycles = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--dump-frame") == 0 && hasValue) dumpPath = argv[++i];
+        else if (std::strcmp(argv[i], "--serial") == 0) printSerial = true;
+        else if (std::strcmp(argv[i], "--profile-calls") == 0 && hasValue) callProfilePath = argv[++i];
+        else if (int count = parseOption(argc, argv, i); count > 0) i += count - 1;
+        else if (argv[i][0] != '-' && !romPath) romPath = argv[i];
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (m_desc.needsROM && !romPath) {
+        printUsage();
+        return 1;
+    }
+
+    if (romPath && !loadROM(romPath)) {
+        std::cerr << "Could not load " << romPath << '\n';
+        return 1;
+    }
+
+    if (cycles == 0) cycles = frames * m_desc.cyclesPerFrame;
+
+    std::unique_ptr<CallProfiler> callProfiler;
+    if (callProfilePath) {
+        callProfiler = std::make_unique<CallProfiler>();
+        callProfiler->setEnabled(true);
+        setCallProfiler(callProfiler.get());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    u64 cyclesDone = 0;
+    while (cyclesDone < cycles) {
+        u32 budget = (u32)std::min<u64>(cycles - cyclesDone, m_desc.cyclesPerFrame);
+        u32 cyclesRun = runCycles(budget);
+        if (cyclesRun == 0) break; // machine stopped
+
+        cyclesDone += cyclesRun;
+    }
+    std::chrono::duration<double> hostTime = std::chrono::steady_clock::now() - start;
+
+    double emulatedTime = (double)cyclesDone / m_desc.clockFrequency;
+    double speed = hostTime.count() > 0.0 ? emulatedTime / hostTime.count() : 0.0;
+    std::cout << m_desc.name << ": " << cyclesDone << " cycles (" << cyclesDone / m_desc.cyclesPerFrame << " frames)"
+              << " in " << hostTime.count() << "s, " << speed << "x real time, "
+              << (hostTime.count() > 0.0 ? cyclesDone / hostTime.count() / 1000000.0 : 0.0) << " MHz\n";
+
+    if (printSerial)
+        std::cout << "serial: " << m_serialOutput << '\n';
+
+    if (callProfiler) {
+        setCallProfiler(nullptr);
+        if (!callProfiler->exportCollapsedStacks(callProfilePath, m_desc.addressWidth)) {
+            std::cerr << "Could not write " << callProfilePath << '\n';
+            return 1;
+        }
+    }
+
+    if (dumpPath && !dumpFrame(dumpPath)) {
+        std::cerr << "Could not write " << dumpPath << '\n';
+        return 1;
+    }
+
+    return 0;
+}
+
+bool HeadlessApplication::dumpFrame(const char* filename)
+{
+    auto pixels = acquireScreenPixels();
+    if (pixels.size() != (size_t)m_desc.screenWidth * m_desc.screenHeight)
+        return false;
+
+    // Binary PPM, pixels are stored as 0xAABBGGRR just like they are uploaded to the screen texture.
+    std::string header = "P6\n" + std::to_string(m_desc.screenWidth) + ' ' + std::to_string(m_desc.screenHeight) + "\n255\n";
+    std::vector<char> data{ header.begin(), header.end() };
+    data.reserve(header.size() + pixels.size() * 3);
+    for (u32 pixel : pixels) {
+        data.push_back((char)(pixel & 0xFF));
+        data.push_back((char)((pixel >> 8) & 0xFF));
+        data.push_back((char)((pixel >> 16) & 0xFF));
+    }
+
+    return writeFile(filename, data.data(), data.size(), true);
+}
+
+void HeadlessApplication::printUsage() const
+{
+    std::cerr << "usage: " << m_desc.name << "_headless" << (m_desc.needsROM ? " rom" : " [rom]")
+              << " [--frames N | --cycles N] [--dump-frame file.ppm] [--serial] [--profile-calls file.folded]";
+    if (m_desc.extraUsage)
+        std::cerr << ' ' << m_desc.extraUsage;
+    std::cerr << '\n';
+}
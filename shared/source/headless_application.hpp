@@ -0,0 +1,52 @@
+#pragma once
+#include "types.hpp"
+
+#include <span>
+#include <string>
+
+class CallProfiler;
+
+// Window-less counterpart of Application for batch runs and throughput measurement.
+// Runs the machine as fast as possible, then dumps framebuffer, serial output and timing stats.
+//
+// usage: <exe> [rom] [--frames N | --cycles N] [--dump-frame file.ppm] [--serial] [--profile-calls file.folded]
+class HeadlessApplication
+{
+public:
+    struct Description
+    {
+        const char* name;
+        unsigned int screenWidth;
+        unsigned int screenHeight;
+        u32 cyclesPerFrame;
+        u32 clockFrequency; // in cycles per second, used to compute emulation speed
+        bool needsROM;
+        const char* extraUsage = nullptr; // machine specific options
+        unsigned int addressWidth = 4;    // in hex digits, for profiler output
+    };
+
+    explicit HeadlessApplication(const Description& desc) : m_desc{ desc } {}
+    virtual ~HeadlessApplication() = default;
+
+    int run(int argc, char* argv[]);
+
+    virtual bool loadROM(const char* /*filename*/) { return true; }
+    // Handles machine specific option at argv[i], returns number of arguments used or 0 if unknown.
+    virtual int parseOption(int /*argc*/, char* /*argv*/[], int /*i*/) { return 0; }
+    virtual u32 runCycles(u32 budget) = 0;
+    // Machines supporting call profiling forward it to their CPU, nullptr detaches it.
+    virtual void setCallProfiler(CallProfiler* /*profiler*/) {}
+    // Newest completed frame.
+    virtual std::span<const u32> acquireScreenPixels() { return {}; }
+
+    HeadlessApplication(const HeadlessApplication&) = delete;
+    HeadlessApplication& operator=(const HeadlessApplication&) = delete;
+protected:
+    // Machines with serial port append what they send here.
+    std::string m_serialOutput;
+private:
+    bool dumpFrame(const char* filename);
+    void printUsage() const;
+
+    Description m_desc;
+};
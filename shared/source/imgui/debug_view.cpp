@@ -1,27 +1,112 @@
 #include "shared/source/imgui/debug_view.hpp"
+#include "shared/source/breakpoints.hpp"
 
 #include <imgui.h>
 
 namespace imgui {
 
+	static const char* typeName(u8 flags)
+	{
+		switch (flags & (Breakpoints::EXECUTE | Breakpoints::READ | Breakpoints::WRITE))
+		{
+		case Breakpoints::EXECUTE: return "exec";
+		case Breakpoints::READ: return "read";
+		case Breakpoints::WRITE: return "write";
+		case Breakpoints::READ | Breakpoints::WRITE: return "r/w";
+		default: return "mixed";
+		}
+	}
+
 	void DebugView::updateWindow()
 	{
+        if (breakpoints && breakpoints->hasHit()) isPaused = true;
+
         if (!open) return;
 
         if (ImGui::Begin("Debug Control&Status", &open, ImGuiWindowFlags_NoScrollbar))
         {
             if (isPaused) {
-                if (ImGui::Button("Start")) isPaused = false;
+                if (ImGui::Button("Start")) {
+                    if (breakpoints) breakpoints->resume();
+                    isPaused = false;
+                }
             }
             else {
                 if (ImGui::Button("Pause")) isPaused = true;
             }
             ImGui::SameLine();
-            if (ImGui::Button("Step") && stepCallback) stepCallback();
+            if (ImGui::Button("Step") && stepCallback) {
+                if (breakpoints) breakpoints->resume();
+                stepCallback();
+            }
             ImGui::SeparatorText("Status");
             if (cpuStatusCallback) cpuStatusCallback();
+            if (breakpoints) updateBreakpoints();
         }
         ImGui::End();
 	}
 
+	void DebugView::updateBreakpoints()
+	{
+        ImGui::SeparatorText("Breakpoints");
+
+        u32 hitAddress;
+        u8 hitType;
+        if (breakpoints->getHit(hitAddress, hitType))
+            ImGui::TextColored({ 1.f, 0.f, 0.f, 1.f }, "Hit %s at %0*X", typeName(hitType), addressWidth, hitAddress);
+
+        ImGui::SetNextItemWidth(ImGui::CalcTextSize("0").x * (addressWidth + 1));
+        ImGui::InputScalar("##address", ImGuiDataType_U32, &m_newAddress, nullptr, nullptr,
+            addressWidth > 4 ? "%08X" : "%04X", ImGuiInputTextFlags_CharsHexadecimal);
+
+        static const char* types[] = { "exec", "read", "write", "r/w" };
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(ImGui::CalcTextSize("write").x * 2);
+        ImGui::Combo("##type", &m_newType, types, hasWatchpoints ? 4 : 1);
+
+        // Condition is only available for execute breakpoints, on register value.
+        const auto& registerNames = breakpoints->getRegisterNames();
+        if (m_newType == 0 && !registerNames.empty()) {
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(ImGui::CalcTextSize("always").x * 2);
+            const char* preview = m_newConditionRegister < 0 ? "always" : registerNames[m_newConditionRegister];
+            if (ImGui::BeginCombo("##register", preview)) {
+                if (ImGui::Selectable("always", m_newConditionRegister < 0)) m_newConditionRegister = -1;
+                for (int i = 0; i < (int)registerNames.size(); i++)
+                    if (ImGui::Selectable(registerNames[i], m_newConditionRegister == i)) m_newConditionRegister = i;
+                ImGui::EndCombo();
+            }
+            if (m_newConditionRegister >= 0) {
+                ImGui::SameLine();
+                ImGui::Text("==");
+                ImGui::SameLine();
+                ImGui::SetNextItemWidth(ImGui::CalcTextSize("0").x * 9);
+                ImGui::InputScalar("##value", ImGuiDataType_U32, &m_newConditionValue, nullptr, nullptr, "%X", ImGuiInputTextFlags_CharsHexadecimal);
+            }
+        }
+
+        ImGui::SameLine();
+        if (ImGui::Button("Add")) {
+            if (m_newType > 0)
+                breakpoints->addWatchpoint(m_newAddress, (u8)(m_newType == 3 ? Breakpoints::READ | Breakpoints::WRITE : m_newType == 1 ? Breakpoints::READ : Breakpoints::WRITE));
+            else if (m_newConditionRegister >= 0)
+                breakpoints->addBreakpoint(m_newAddress, { (u32)m_newConditionRegister, m_newConditionValue });
+            else
+                breakpoints->addBreakpoint(m_newAddress);
+        }
+
+        for (const auto& entry : breakpoints->getEntries()) {
+            ImGui::PushID((int)entry.address);
+            if (ImGui::SmallButton("x")) breakpoints->remove(entry.address);
+            ImGui::SameLine();
+            if (entry.hasCondition)
+                ImGui::Text("%0*X %s if %s == %X", addressWidth, entry.address, typeName(entry.flags),
+                    registerNames[entry.condition.registerIndex], entry.condition.value);
+            else
+                ImGui::Text("%0*X %s", addressWidth, entry.address, typeName(entry.flags));
+            ImGui::PopID();
+        }
+        if (ImGui::Button("Clear all")) breakpoints->clear();
+	}
+
 } // namespace imgui
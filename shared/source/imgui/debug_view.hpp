@@ -1,6 +1,8 @@
 #pragma once
 #include <functional>
 
+class Breakpoints;
+
 namespace imgui {
 
 	struct DebugView
@@ -10,9 +12,22 @@ namespace imgui {
 		std::function<void()> stepCallback = nullptr;
 		std::function<void()> cpuStatusCallback = nullptr;
 
+		// Optional, machine pauses on hits and breakpoints can be edited.
+		Breakpoints* breakpoints = nullptr;
+		bool hasWatchpoints = false; // only machines with memory page table support them
+		int addressWidth = 4;
+
+		// Has to be called every frame, even when closed, to pause on hits.
 		void updateWindow();
 
 		DebugView(bool& isPaused) : isPaused{ isPaused } {}
+	private:
+		void updateBreakpoints();
+
+		unsigned int m_newAddress = 0;
+		int m_newType = 0;
+		int m_newConditionRegister = -1;
+		unsigned int m_newConditionValue = 0;
 	};
 
 } // namespace imgui
@@ -1,11 +1,36 @@
 #include "shared/source/imgui/disassembly_view.hpp"
+#include "shared/source/disassembly_index.hpp"
 #include "shared/source/disassembly_line.hpp"
 
 #include <imgui.h>
 
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
 namespace imgui {
 
-    void DisassemblyView::updateWindow(uint32_t pc)
+    static constexpr size_t CACHE_SIZE = 256;
+    // How far back decoding starts for variable length instructions, so it aligns with real boundaries.
+    static constexpr u32 RESYNC_INSTRUCTIONS = 16;
+
+    DisassemblyView::DisassemblyView(u32 startAddress, u32 endAddress, unsigned int addressWidth, u32 alignment, u32 maxInstructionSize) :
+        m_startAddress{ startAddress },
+        m_endAddress{ endAddress },
+        m_addressWidth{ addressWidth },
+        m_alignment{ alignment },
+        m_maxInstructionSize{ maxInstructionSize },
+        m_anchor{ startAddress }
+    {
+        assert(startAddress <= endAddress && alignment > 0 && "Invalid address range!");
+        assert(maxInstructionSize <= MAX_INSTRUCTION_SIZE && "Instruction too long for DisassemblyView!");
+
+        m_cache.reserve(CACHE_SIZE);
+        m_cacheSlots.reserve(CACHE_SIZE);
+    }
+
+    void DisassemblyView::updateWindow(u32 pc)
     {
         if (!open) return;
 
@@ -13,26 +38,135 @@ namespace imgui {
         {
             ImGui::BeginChild("##scrolling", ImVec2(0, 0), false, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoNav);
 
-            ImGuiListClipper clipper;
-            clipper.Begin((int)disassembly.size(), ImGui::GetTextLineHeight());
-
-            while (clipper.Step())
-                for (int line_i = clipper.DisplayStart; line_i < clipper.DisplayEnd; line_i++)
-                {
-                    auto& line = disassembly[line_i];
-                    if (line_i > 0) {
-                        auto& prev_line = disassembly[line_i - 1];
-                        if (line.address - prev_line.address > 4) ImGui::Separator();
-                    }
-                    constexpr const char* fmt = "%0*X:  %.*s";
-                    (pc == line.address) ?
-                    ImGui::TextColored({ 1.f, 0.f, 0.f, 1.f }, fmt, addressWidth, line.address, DisassemblyLine::BUFFER_SIZE, line.buffer) :
-                    ImGui::Text(fmt, addressWidth, line.address, DisassemblyLine::BUFFER_SIZE, line.buffer);
-                }
+            if (index) drawIndex(pc);
+            else drawRange(pc);
 
             ImGui::EndChild();
         }
         ImGui::End();
     }
 
+    const DisassemblyView::CachedLine& DisassemblyView::decodeCached(u32 address)
+    {
+        u32 available = (u32)std::min<u64>(m_maxInstructionSize, (u64)m_endAddress - address + 1);
+
+        auto it = m_cacheSlots.find(address);
+        if (it != m_cacheSlots.end()) {
+            CachedLine& cached = m_cache[it->second];
+            bool isValid = true;
+            for (u32 i = 0; i < cached.length && i < available && isValid; i++)
+                isValid = read8(address + i) == cached.bytes[i];
+
+            if (isValid) {
+                cached.lastUse = ++m_useCounter;
+                return cached;
+            }
+        }
+
+        size_t slot;
+        if (it != m_cacheSlots.end())
+            slot = it->second;
+        else if (m_cache.size() < CACHE_SIZE) {
+            slot = m_cache.size();
+            m_cache.emplace_back();
+        }
+        else {
+            auto lru = std::min_element(m_cache.begin(), m_cache.end(),
+                [](const CachedLine& a, const CachedLine& b) { return a.lastUse < b.lastUse; });
+            slot = lru - m_cache.begin();
+            m_cacheSlots.erase(lru->line.address);
+        }
+        m_cacheSlots[address] = slot;
+
+        CachedLine& cached = m_cache[slot];
+        std::memset(cached.bytes, 0, sizeof(cached.bytes));
+        for (u32 i = 0; i < available; i++)
+            cached.bytes[i] = read8(address + i);
+
+        cached.line.address = address;
+        cached.length = std::clamp(decode(address, cached.bytes, cached.line), 1u, m_maxInstructionSize);
+        cached.lastUse = ++m_useCounter;
+        return cached;
+    }
+
+    void DisassemblyView::drawLine(const DisassemblyLine& line, u32 pc)
+    {
+        constexpr const char* fmt = "%0*X:  %.*s";
+        (pc == line.address) ?
+        ImGui::TextColored({ 1.f, 0.f, 0.f, 1.f }, fmt, m_addressWidth, line.address, DisassemblyLine::BUFFER_SIZE, line.buffer) :
+        ImGui::Text(fmt, m_addressWidth, line.address, DisassemblyLine::BUFFER_SIZE, line.buffer);
+    }
+
+    void DisassemblyView::drawRange(u32 pc)
+    {
+        // One row per aligned address, so scrollbar position maps directly to address.
+        // Variable length instructions take more than one address, bottom of the list is left empty.
+        u64 rowCount = ((u64)m_endAddress - m_startAddress) / m_alignment + 1;
+
+        ImGuiListClipper clipper;
+        clipper.Begin((int)std::min<u64>(rowCount, std::numeric_limits<int>::max()), ImGui::GetTextLineHeight());
+
+        while (clipper.Step()) {
+            u32 top = m_startAddress + (u32)clipper.DisplayStart * m_alignment;
+            u32 address = top;
+
+            if (m_alignment < m_maxInstructionSize) {
+                // Walk from a point before top, landing on real instruction boundary near it.
+                // Executed PC and last frame's top line are known boundaries and are preferred.
+                u32 resyncBytes = RESYNC_INSTRUCTIONS * m_maxInstructionSize;
+                address = top - m_startAddress > resyncBytes ? top - resyncBytes : m_startAddress;
+                if (m_anchor >= address && m_anchor <= top) address = m_anchor;
+                if (pc >= address && pc <= top) address = pc;
+
+                while (address < top) {
+                    u32 next = address + decodeCached(address).length;
+                    if (address < pc && next > pc) next = pc;
+                    if (next < address) break; // wrapped around end of address space
+                    address = next;
+                }
+                m_anchor = address;
+            }
+
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                if (address < top || address > m_endAddress) {
+                    ImGui::NewLine();
+                    continue;
+                }
+
+                const CachedLine& cached = decodeCached(address);
+                drawLine(cached.line, pc);
+
+                u32 next = address + cached.length;
+                if (address < pc && next > pc) next = pc;
+                address = next;
+            }
+        }
+    }
+
+    void DisassemblyView::drawIndex(u32 pc)
+    {
+        ImGuiListClipper clipper;
+        clipper.Begin((int)index->getCount(), ImGui::GetTextLineHeight());
+
+        while (clipper.Step()) {
+            u32 address;
+            if (!index->select(clipper.DisplayStart, address))
+                continue;
+
+            u32 prevAddress = address;
+            if (clipper.DisplayStart > 0)
+                index->select(clipper.DisplayStart - 1, prevAddress);
+
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                // Separator marks a jump over code that was never executed.
+                if (address - prevAddress > m_maxInstructionSize) ImGui::Separator();
+                drawLine(decodeCached(address).line, pc);
+
+                prevAddress = address;
+                if (!index->findNext(address, address))
+                    break;
+            }
+        }
+    }
+
 } // namespace imgui
@@ -1,23 +1,60 @@
 #pragma once
-#include <vector>
+#include "shared/source/disassembly_line.hpp"
 
-struct DisassemblyLine;
+#include <functional>
+#include <unordered_map>
+#include <vector>
 
-using Disassembly = std::vector<DisassemblyLine>;
+class DisassemblyIndex;
 
 namespace imgui {
 
+    // Disassembles straight from guest memory, only the lines that are currently visible.
     struct DisassemblyView
     {
+        static constexpr u32 MAX_INSTRUCTION_SIZE = 8;
+
+        using Read8MemoryCallback = std::function<u8(u32 address)>;
+        // Formats instruction starting at address and returns its length in bytes.
+        using DecodeCallback = std::function<u32(u32 address, const u8* bytes, DisassemblyLine& line)>;
+
         bool open = false;
-        const Disassembly& disassembly;
-        unsigned int addressWidth;
+        Read8MemoryCallback read8 = nullptr;
+        DecodeCallback decode = nullptr;
+        // When set only executed addresses are listed, instead of whole address range.
+        const DisassemblyIndex* index = nullptr;
+
+        void updateWindow(u32 pc);
+
+        // Instructions are aligned to alignment bytes and are at most maxInstructionSize long.
+        DisassemblyView(u32 startAddress, u32 endAddress, unsigned int addressWidth, u32 alignment, u32 maxInstructionSize);
+    private:
+        struct CachedLine
+        {
+            u32 lastUse;
+            u32 length;
+            u8 bytes[MAX_INSTRUCTION_SIZE];
+            DisassemblyLine line;
+        };
+
+        const CachedLine& decodeCached(u32 address);
+        void drawLine(const DisassemblyLine& line, u32 pc);
+        void drawRange(u32 pc);
+        void drawIndex(u32 pc);
+
+        const u32 m_startAddress;
+        const u32 m_endAddress;
+        const unsigned int m_addressWidth;
+        const u32 m_alignment;
+        const u32 m_maxInstructionSize;
 
-        void updateWindow(uint32_t pc);
+        // Small LRU of decoded lines, entries are checked against memory before being reused.
+        std::vector<CachedLine> m_cache;
+        std::unordered_map<u32, size_t> m_cacheSlots;
+        u32 m_useCounter = 0;
 
-        DisassemblyView(const Disassembly& disassembly, unsigned int addressWidth) :
-            disassembly{ disassembly },
-            addressWidth{ addressWidth } {}
+        // First line shown last frame, known instruction boundary to resynchronize from.
+        u32 m_anchor;
     };
 
 } // namespace imgui
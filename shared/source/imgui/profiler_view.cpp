@@ -0,0 +1,132 @@
+#include "shared/source/imgui/profiler_view.hpp"
+
+#include <imgui.h>
+
+namespace imgui {
+
+    static constexpr size_t MAX_HOT_SPOTS = 64;
+    static constexpr size_t MAX_FUNCTIONS = 32;
+    static constexpr int REFRESH_FRAMES = 15;
+
+    void ProfilerView::updateWindow()
+    {
+        if (!open || !profiler) return;
+
+        if (ImGui::Begin("Profiler", &open))
+        {
+            int frame = ImGui::GetFrameCount();
+            bool refresh = frame - m_lastRefreshFrame >= REFRESH_FRAMES;
+            if (refresh) {
+                m_hotSpots = profiler->getHotSpots(MAX_HOT_SPOTS);
+                m_lastRefreshFrame = frame;
+            }
+
+            if (callProfiler) {
+                updateCallProfiler(refresh);
+                ImGui::SeparatorText("Addresses");
+            }
+
+            bool isEnabled = profiler->isEnabled();
+            if (ImGui::Checkbox("Enabled", &isEnabled)) profiler->setEnabled(isEnabled);
+            ImGui::SameLine();
+            if (ImGui::Button("Clear")) {
+                profiler->clear();
+                m_hotSpots.clear();
+            }
+
+            ImGui::SetNextItemWidth(ImGui::CalcTextSize("0").x * 24);
+            ImGui::InputText("##filename", m_exportFilename, sizeof(m_exportFilename));
+            ImGui::SameLine();
+            if (ImGui::Button("Export"))
+                m_hasExportFailed = !profiler->exportToFile(m_exportFilename, m_addressWidth);
+            if (m_hasExportFailed) {
+                ImGui::SameLine();
+                ImGui::TextColored({ 1.f, 0.f, 0.f, 1.f }, "Export failed!");
+            }
+
+            u64 totalCycles = profiler->getTotalCycles();
+            ImGui::Text("Total cycles: %llu", (unsigned long long)totalCycles);
+
+            if (ImGui::BeginTable("##hotspots", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit))
+            {
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableSetupColumn("Address");
+                ImGui::TableSetupColumn("Cycles");
+                ImGui::TableSetupColumn("%");
+                ImGui::TableSetupColumn("Instructions");
+                ImGui::TableHeadersRow();
+
+                for (const auto& hotSpot : m_hotSpots) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%0*X", (int)m_addressWidth, hotSpot.address);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%llu", (unsigned long long)hotSpot.cycles);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", totalCycles ? 100.0 * (double)hotSpot.cycles / (double)totalCycles : 0.0);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%llu", (unsigned long long)hotSpot.instructions);
+                }
+
+                ImGui::EndTable();
+            }
+        }
+        ImGui::End();
+    }
+
+    void ProfilerView::updateCallProfiler(bool refresh)
+    {
+        ImGui::SeparatorText("Functions");
+
+        bool isEnabled = callProfiler->isEnabled();
+        if (ImGui::Checkbox("Enabled##calls", &isEnabled)) callProfiler->setEnabled(isEnabled);
+        ImGui::SameLine();
+        if (ImGui::Button("Clear##calls")) {
+            callProfiler->clear();
+            m_functions.clear();
+        }
+
+        // Collapsed stacks, for flamegraph tools.
+        ImGui::SetNextItemWidth(ImGui::CalcTextSize("0").x * 24);
+        ImGui::InputText("##stacksFilename", m_stacksFilename, sizeof(m_stacksFilename));
+        ImGui::SameLine();
+        if (ImGui::Button("Export##calls"))
+            m_hasStacksExportFailed = !callProfiler->exportCollapsedStacks(m_stacksFilename, m_addressWidth);
+        if (m_hasStacksExportFailed) {
+            ImGui::SameLine();
+            ImGui::TextColored({ 1.f, 0.f, 0.f, 1.f }, "Export failed!");
+        }
+
+        if (refresh) {
+            m_functions = callProfiler->getFunctions();
+            if (m_functions.size() > MAX_FUNCTIONS)
+                m_functions.resize(MAX_FUNCTIONS);
+        }
+
+        if (ImGui::BeginTable("##functions", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit,
+            ImVec2(0.f, ImGui::GetTextLineHeightWithSpacing() * 10)))
+        {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Function");
+            ImGui::TableSetupColumn("Calls");
+            ImGui::TableSetupColumn("Inclusive");
+            ImGui::TableSetupColumn("Exclusive");
+            ImGui::TableHeadersRow();
+
+            for (const auto& function : m_functions) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%0*X", (int)m_addressWidth, function.address);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long)function.calls);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long)function.inclusiveCycles);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long)function.exclusiveCycles);
+            }
+
+            ImGui::EndTable();
+        }
+    }
+
+} // namespace imgui
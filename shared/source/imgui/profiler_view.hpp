@@ -0,0 +1,36 @@
+#pragma once
+#include "shared/source/call_profiler.hpp"
+#include "shared/source/pc_profiler.hpp"
+
+#include <vector>
+
+namespace imgui {
+
+    // Guest addresses where most cycles were spent, as recorded by PCProfiler,
+    // and optionally functions that took most cycles, as recorded by CallProfiler.
+    struct ProfilerView
+    {
+        bool open = false;
+        PCProfiler* profiler = nullptr;
+        CallProfiler* callProfiler = nullptr;
+
+        void updateWindow();
+
+        explicit ProfilerView(unsigned int addressWidth) : m_addressWidth{ addressWidth } {}
+    private:
+        void updateCallProfiler(bool refresh);
+
+        const unsigned int m_addressWidth;
+
+        // Collecting hot spots walks every counter, so list is refreshed only a few times per second.
+        std::vector<PCProfiler::HotSpot> m_hotSpots;
+        std::vector<CallProfiler::Function> m_functions;
+        int m_lastRefreshFrame = -1000;
+
+        char m_exportFilename[256] = "profile.csv";
+        bool m_hasExportFailed = false;
+        char m_stacksFilename[256] = "calls.folded";
+        bool m_hasStacksExportFailed = false;
+    };
+
+} // namespace imgui
@@ -0,0 +1,51 @@
+#pragma once
+#include "breakpoints.hpp"
+#include "call_profiler.hpp"
+#include "pc_profiler.hpp"
+#include "types.hpp"
+
+// Checked run loop shared by all CPUs, entered from runCycles() only while breakpoints are armed
+// or a profiler is enabled. Instruments that are not active are left null.
+//
+// Execute breakpoints are checked here, before each instruction. Watchpoints are not: they live in
+// memory page tables, so the machine owning the bus calls MemoryBus16::syncWatchpoints() at the start
+// of its runCycles() and accesses to watched pages report themselves, in this loop or not.
+struct Instrumentation
+{
+    Instrumentation(Breakpoints* bps, PCProfiler* pcProfiler, CallProfiler* callProf) :
+        breakpoints{ bps && bps->isArmed() ? bps : nullptr },
+        profiler{ pcProfiler && pcProfiler->isEnabled() ? pcProfiler : nullptr },
+        callProfiler{ callProf && callProf->isEnabled() ? callProf : nullptr } {}
+
+    // Runs until budget cycles are used or a breakpoint is hit, nothing runs while a hit is pending.
+    // getPC() is PC of the next instruction, isAtInstructionStart() is false in the middle
+    // of an instruction started with clock(), step() runs one instruction and returns its cycles,
+    // 0 when the machine can't run.
+    template<typename GetPC, typename IsAtInstructionStart, typename Step>
+    u32 run(u32 budget, GetPC getPC, IsAtInstructionStart isAtInstructionStart, Step step) const
+    {
+        u32 cycles = 0;
+        while (cycles < budget && !(breakpoints && breakpoints->hasHit())) {
+            u32 pc = getPC();
+            if (breakpoints && isAtInstructionStart() && breakpoints->checkExecute(pc))
+                break;
+
+            u32 node = callProfiler ? callProfiler->getCurrentNode() : 0;
+            u32 instructionCycles = step();
+            if (instructionCycles == 0)
+                break;
+
+            if (profiler)
+                profiler->record(pc, instructionCycles);
+            if (callProfiler)
+                callProfiler->addCycles(node, instructionCycles);
+            cycles += instructionCycles;
+        }
+
+        return cycles;
+    }
+
+    Breakpoints* const breakpoints;
+    PCProfiler* const profiler;
+    CallProfiler* const callProfiler;
+};
@@ -0,0 +1,157 @@
+#include "mapped_file.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+bool MappedFile::open(const char* filename, Mode mode, size_t size)
+{
+    close();
+
+    bool isWritable = mode == Mode::ReadWrite;
+    HANDLE file = CreateFileA(filename, isWritable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, nullptr,
+        isWritable && size ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    if (isWritable && size && (size_t)fileSize.QuadPart != size) {
+        LARGE_INTEGER newSize;
+        newSize.QuadPart = (LONGLONG)size;
+        if (!SetFilePointerEx(file, newSize, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+            CloseHandle(file);
+            return false;
+        }
+        fileSize = newSize;
+    }
+
+    if (size == 0)
+        size = (size_t)fileSize.QuadPart;
+    if (size == 0 || size > (size_t)fileSize.QuadPart) {
+        CloseHandle(file);
+        return false;
+    }
+
+    DWORD protection = mode == Mode::ReadOnly ? PAGE_READONLY : mode == Mode::CopyOnWrite ? PAGE_WRITECOPY : PAGE_READWRITE;
+    HANDLE mapping = CreateFileMappingA(file, nullptr, protection, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    DWORD access = mode == Mode::ReadOnly ? FILE_MAP_READ : mode == Mode::CopyOnWrite ? FILE_MAP_COPY : FILE_MAP_WRITE;
+    void* view = MapViewOfFile(mapping, access, 0, 0, size);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_data = (u8*)view;
+    m_size = size;
+    m_mode = mode;
+    m_fileHandle = file;
+    m_mappingHandle = mapping;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mappingHandle) CloseHandle((HANDLE)m_mappingHandle);
+    if (m_fileHandle) CloseHandle((HANDLE)m_fileHandle);
+
+    m_data = nullptr;
+    m_size = 0;
+    m_fileHandle = nullptr;
+    m_mappingHandle = nullptr;
+}
+
+bool MappedFile::flush()
+{
+    if (!m_data || m_mode != Mode::ReadWrite)
+        return false;
+
+    return FlushViewOfFile(m_data, m_size) && FlushFileBuffers((HANDLE)m_fileHandle);
+}
+
+#else
+
+bool MappedFile::open(const char* filename, Mode mode, size_t size)
+{
+    close();
+
+    bool isWritable = mode == Mode::ReadWrite;
+    // Private mapping never writes back, so copy-on-write only needs read access.
+    int file = ::open(filename, isWritable ? (size ? O_RDWR | O_CREAT : O_RDWR) : O_RDONLY, 0644);
+    if (file < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(file, &status) != 0) {
+        ::close(file);
+        return false;
+    }
+
+    size_t fileSize = (size_t)status.st_size;
+    if (isWritable && size && fileSize != size) {
+        if (ftruncate(file, (off_t)size) != 0) {
+            ::close(file);
+            return false;
+        }
+        fileSize = size;
+    }
+
+    if (size == 0)
+        size = fileSize;
+    if (size == 0 || size > fileSize) {
+        ::close(file);
+        return false;
+    }
+
+    int protection = mode == Mode::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+    int flags = isWritable ? MAP_SHARED : MAP_PRIVATE;
+    void* view = mmap(nullptr, size, protection, flags, file, 0);
+    // Mapping keeps its own reference to the file.
+    ::close(file);
+    if (view == MAP_FAILED)
+        return false;
+
+    m_data = (u8*)view;
+    m_size = size;
+    m_mode = mode;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data)
+        munmap(m_data, m_size);
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool MappedFile::flush()
+{
+    if (!m_data || m_mode != Mode::ReadWrite)
+        return false;
+
+    return msync(m_data, m_size, MS_SYNC) == 0;
+}
+
+#endif
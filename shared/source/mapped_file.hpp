@@ -0,0 +1,42 @@
+#pragma once
+#include "types.hpp"
+
+#include <stddef.h>
+
+// Whole file mapped into memory, so ROM images are available without reading them up front
+// and pages are loaded by the OS on first access.
+class MappedFile
+{
+public:
+    enum class Mode
+    {
+        ReadOnly,    // mapping must not be written
+        CopyOnWrite, // writes stay private to the mapping, file is left unchanged
+        ReadWrite    // writes go to the file, used for battery backed saves
+    };
+
+    // size == 0 maps whole file, otherwise its first size bytes and shorter files fail to open.
+    // For ReadWrite a non-zero size instead creates the file when it doesn't exist and resizes it
+    // when it differs, existing contents are kept. Empty files can't be mapped.
+    bool open(const char* filename, Mode mode, size_t size = 0);
+    void close();
+    // Writes ReadWrite mapping back to the file now instead of when OS decides to.
+    bool flush();
+
+    bool isOpen() const { return m_data != nullptr; }
+    u8* getData() { return m_data; }
+    const u8* getData() const { return m_data; }
+    size_t getSize() const { return m_size; }
+
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+private:
+    u8* m_data = nullptr;
+    size_t m_size = 0;
+    Mode m_mode = Mode::ReadOnly;
+    // Windows keeps file and mapping handles open for the lifetime of a view.
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+};
@@ -0,0 +1,163 @@
+#include "memory_bus.hpp"
+#include "breakpoints.hpp"
+
+#include <cstring>
+
+MemoryBus16::MemoryBus16()
+{
+    m_readCallbacks.push_back([](u16) -> u8 {
+        assert(false && "Unhandled memory read!");
+        return 0xFF;
+    });
+    m_writeCallbacks.push_back([](u16, u8) {
+        assert(false && "Unhandled memory write!");
+    });
+    m_readCallbacks.push_back([this](u16 address) {
+        if (m_breakpoints) m_breakpoints->checkAccess(address, false);
+        return readMapped(address);
+    });
+    m_writeCallbacks.push_back([this](u16 address, u8 data) {
+        if (m_breakpoints) m_breakpoints->checkAccess(address, true);
+        writeMapped(address, data);
+    });
+
+    std::memset(m_pageWatch, 0, sizeof(m_pageWatch));
+    unmap({ 0x0000, 0xFFFF });
+    std::memset(m_openBusPage, 0xFF, PAGE_SIZE);
+}
+
+void MemoryBus16::mapReadMemory(AddressRange16 range, const u8* memory, u16 mask)
+{
+    assert(mask >= PAGE_SIZE - 1);
+    forEachPage(range, [&](u16 page, u16 offset) {
+        m_mappedPages[page].read = memory + (offset & mask);
+        updatePage(page);
+    });
+}
+
+void MemoryBus16::mapWriteMemory(AddressRange16 range, u8* memory, u16 mask)
+{
+    assert(mask >= PAGE_SIZE - 1);
+    forEachPage(range, [&](u16 page, u16 offset) {
+        m_mappedPages[page].write = memory + (offset & mask);
+        updatePage(page);
+    });
+}
+
+void MemoryBus16::mapMemory(AddressRange16 range, u8* memory, u16 mask)
+{
+    mapReadMemory(range, memory, mask);
+    mapWriteMemory(range, memory, mask);
+}
+
+void MemoryBus16::mapReadCallback(AddressRange16 range, ReadCallback callback)
+{
+    mapReadCallback(range, addReadCallback(callback));
+}
+
+void MemoryBus16::mapWriteCallback(AddressRange16 range, WriteCallback callback)
+{
+    mapWriteCallback(range, addWriteCallback(callback));
+}
+
+void MemoryBus16::mapOpenBus(AddressRange16 range)
+{
+    forEachPage(range, [&](u16 page, u16) {
+        m_mappedPages[page].read = m_openBusPage;
+        m_mappedPages[page].write = m_openBusSink;
+        updatePage(page);
+    });
+}
+
+u8 MemoryBus16::addReadCallback(ReadCallback callback)
+{
+    assert(m_readCallbacks.size() < 0x100 && "Too many read callbacks!");
+    m_readCallbacks.push_back(callback);
+    return (u8)(m_readCallbacks.size() - 1);
+}
+
+u8 MemoryBus16::addWriteCallback(WriteCallback callback)
+{
+    assert(m_writeCallbacks.size() < 0x100 && "Too many write callbacks!");
+    m_writeCallbacks.push_back(callback);
+    return (u8)(m_writeCallbacks.size() - 1);
+}
+
+void MemoryBus16::mapReadCallback(AddressRange16 range, u8 callbackIndex)
+{
+    assert(callbackIndex < m_readCallbacks.size() && "Read callback was not added!");
+    forEachPage(range, [&](u16 page, u16) {
+        m_mappedPages[page].read = nullptr;
+        m_mappedPages[page].readCallback = callbackIndex;
+        updatePage(page);
+    });
+}
+
+void MemoryBus16::mapWriteCallback(AddressRange16 range, u8 callbackIndex)
+{
+    assert(callbackIndex < m_writeCallbacks.size() && "Write callback was not added!");
+    forEachPage(range, [&](u16 page, u16) {
+        m_mappedPages[page].write = nullptr;
+        m_mappedPages[page].writeCallback = callbackIndex;
+        updatePage(page);
+    });
+}
+
+void MemoryBus16::unmap(AddressRange16 range)
+{
+    forEachPage(range, [&](u16 page, u16) {
+        m_mappedPages[page] = { nullptr, nullptr, UNMAPPED_CALLBACK, UNMAPPED_CALLBACK };
+        updatePage(page);
+    });
+}
+
+void MemoryBus16::syncWatchpoints()
+{
+    u32 generation = m_breakpoints ? m_breakpoints->getWatchGeneration() : 0;
+    if (m_breakpoints == m_syncedBreakpoints && generation == m_syncedWatchGeneration)
+        return;
+
+    m_syncedBreakpoints = m_breakpoints;
+    m_syncedWatchGeneration = generation;
+    for (u16 page = 0; page < PAGE_COUNT; page++) {
+        u8 flags = m_breakpoints ? m_breakpoints->getWatchFlags(page << 8, (page << 8) | 0xFF) : 0;
+        m_pageWatch[page] = (flags & Breakpoints::READ ? 1 : 0) | (flags & Breakpoints::WRITE ? 2 : 0);
+        updatePage(page);
+    }
+}
+
+void MemoryBus16::forEachPage(AddressRange16 range, const std::function<void(u16 page, u16 offset)>& func)
+{
+    assert((range.start & (PAGE_SIZE - 1)) == 0 && "Range start is not page aligned!");
+    assert((range.end & (PAGE_SIZE - 1)) == PAGE_SIZE - 1 && "Range end is not page aligned!");
+
+    for (u16 page = range.start >> 8; page <= (range.end >> 8); page++)
+        func(page, (page << 8) - range.start);
+}
+
+void MemoryBus16::updatePage(u16 page)
+{
+    m_pages[page] = m_mappedPages[page];
+    if (m_pageWatch[page] & 1) {
+        m_pages[page].read = nullptr;
+        m_pages[page].readCallback = WATCH_CALLBACK;
+    }
+    if (m_pageWatch[page] & 2) {
+        m_pages[page].write = nullptr;
+        m_pages[page].writeCallback = WATCH_CALLBACK;
+    }
+}
+
+u8 MemoryBus16::readMapped(u16 address) const
+{
+    const Page& page = m_mappedPages[address >> 8];
+    if (page.read) return page.read[address & 0xFF];
+    return m_readCallbacks[page.readCallback](address);
+}
+
+void MemoryBus16::writeMapped(u16 address, u8 data)
+{
+    const Page& page = m_mappedPages[address >> 8];
+    if (page.write) page.write[address & 0xFF] = data;
+    else m_writeCallbacks[page.writeCallback](address, data);
+}
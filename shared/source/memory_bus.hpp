@@ -0,0 +1,95 @@
+#pragma once
+#include "address_range.hpp"
+
+#include <cassert>
+#include <functional>
+#include <vector>
+
+class Breakpoints;
+
+class MemoryBus16
+{
+public:
+    static constexpr u16 PAGE_SIZE = 0x100;
+    static constexpr u16 PAGE_COUNT = 0x100;
+
+    using ReadCallback = std::function<u8(u16)>;
+    using WriteCallback = std::function<void(u16, u8)>;
+
+    MemoryBus16();
+
+    // All ranges have to be page aligned. Smaller memories can be mirrored over
+    // a range with mask (e.g. 0x3FF for 1KB), it has to cover at least a page.
+    void mapReadMemory(AddressRange16 range, const u8* memory, u16 mask = 0xFFFF);
+    void mapWriteMemory(AddressRange16 range, u8* memory, u16 mask = 0xFFFF);
+    void mapMemory(AddressRange16 range, u8* memory, u16 mask = 0xFFFF);
+    void mapReadCallback(AddressRange16 range, ReadCallback callback);
+    void mapWriteCallback(AddressRange16 range, WriteCallback callback);
+    void mapOpenBus(AddressRange16 range); // reads return 0xFF, writes are ignored
+
+    // Callbacks added once can be mapped by index any number of times,
+    // for ranges that switch between memory and callbacks at runtime.
+    u8 addReadCallback(ReadCallback callback);
+    u8 addWriteCallback(WriteCallback callback);
+    void mapReadCallback(AddressRange16 range, u8 callbackIndex);
+    void mapWriteCallback(AddressRange16 range, u8 callbackIndex);
+    void unmap(AddressRange16 range);
+
+    // Pages with watchpoints are redirected through a check before reaching what is mapped there,
+    // so all other pages keep their fast path. Remapping a watched page keeps it watched.
+    // Watchpoints are applied by syncWatchpoints(), called by the thread accessing the bus.
+    void setBreakpoints(Breakpoints* breakpoints) { m_breakpoints = breakpoints; }
+    void syncWatchpoints();
+
+    const u8* getReadPointer(u16 address) const
+    {
+        const Page& page = m_pages[address >> 8];
+        return page.read ? page.read + (address & 0xFF) : nullptr;
+    }
+
+    u8 read8(u16 address) const
+    {
+        const Page& page = m_pages[address >> 8];
+        if (page.read) return page.read[address & 0xFF];
+        return m_readCallbacks[page.readCallback](address);
+    }
+
+    void write8(u16 address, u8 data)
+    {
+        const Page& page = m_pages[address >> 8];
+        if (page.write) page.write[address & 0xFF] = data;
+        else m_writeCallbacks[page.writeCallback](address, data);
+    }
+
+    MemoryBus16(const MemoryBus16&) = delete;
+    MemoryBus16& operator=(const MemoryBus16&) = delete;
+private:
+    // Page with nullptr memory dispatches to callback at given index.
+    // Index 0 is always the unmapped access handler.
+    struct Page {
+        const u8* read;
+        u8* write;
+        u8 readCallback;
+        u8 writeCallback;
+    };
+
+    // Callback indices reserved by the bus itself.
+    static constexpr u8 UNMAPPED_CALLBACK = 0;
+    static constexpr u8 WATCH_CALLBACK = 1;
+
+    static void forEachPage(AddressRange16 range, const std::function<void(u16 page, u16 offset)>& func);
+    void updatePage(u16 page);
+    u8 readMapped(u16 address) const;
+    void writeMapped(u16 address, u8 data);
+
+    Page m_pages[PAGE_COUNT]; // what accesses go through, differs from mapped for watched pages
+    Page m_mappedPages[PAGE_COUNT];
+    u8 m_pageWatch[PAGE_COUNT];
+    Breakpoints* m_breakpoints = nullptr;
+    const Breakpoints* m_syncedBreakpoints = nullptr;
+    u32 m_syncedWatchGeneration = 0;
+    std::vector<ReadCallback> m_readCallbacks;
+    std::vector<WriteCallback> m_writeCallbacks;
+    u8 m_openBusPage[PAGE_SIZE];
+    u8 m_openBusSink[PAGE_SIZE];
+};
@@ -0,0 +1,88 @@
+#include "pc_profiler.hpp"
+#include "file_io.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <string>
+
+PCProfiler::PCProfiler(u32 addressBits, u32 alignmentShift) :
+    m_alignmentShift{ alignmentShift },
+    m_indexMask{ addressBits - alignmentShift >= 32 ? 0xFFFFFFFFu : (1u << (addressBits - alignmentShift)) - 1 },
+    m_pageCount{ (m_indexMask >> PAGE_BITS) + 1 },
+    m_pages{ new std::atomic<Page*>[m_pageCount]{} }
+{
+    assert(addressBits > alignmentShift && addressBits <= 32);
+}
+
+PCProfiler::~PCProfiler()
+{
+    for (u32 i = 0; i < m_pageCount; i++)
+        delete m_pages[i].load(std::memory_order_relaxed);
+}
+
+std::vector<PCProfiler::HotSpot> PCProfiler::getHotSpots(size_t maxCount) const
+{
+    std::vector<HotSpot> hotSpots;
+    for (u32 pageIndex = 0; pageIndex < m_pageCount; pageIndex++) {
+        const Page* page = m_pages[pageIndex].load(std::memory_order_acquire);
+        if (!page) continue;
+
+        for (u32 i = 0; i <= PAGE_MASK; i++) {
+            u64 instructions = page->counters[i].instructions.load(std::memory_order_relaxed);
+            if (instructions == 0) continue;
+
+            u32 address = ((pageIndex << PAGE_BITS) | i) << m_alignmentShift;
+            hotSpots.push_back({ address, instructions, page->counters[i].cycles.load(std::memory_order_relaxed) });
+        }
+    }
+
+    auto byCycles = [](const HotSpot& a, const HotSpot& b) { return a.cycles > b.cycles; };
+    if (hotSpots.size() > maxCount) {
+        std::partial_sort(hotSpots.begin(), hotSpots.begin() + maxCount, hotSpots.end(), byCycles);
+        hotSpots.resize(maxCount);
+    }
+    else
+        std::sort(hotSpots.begin(), hotSpots.end(), byCycles);
+
+    return hotSpots;
+}
+
+void PCProfiler::clear()
+{
+    for (u32 pageIndex = 0; pageIndex < m_pageCount; pageIndex++) {
+        Page* page = m_pages[pageIndex].load(std::memory_order_acquire);
+        if (!page) continue;
+
+        for (Counter& counter : page->counters) {
+            counter.instructions.store(0, std::memory_order_relaxed);
+            counter.cycles.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    m_totalCycles.store(0, std::memory_order_relaxed);
+}
+
+bool PCProfiler::exportToFile(const char* filename, unsigned int addressWidth) const
+{
+    auto hotSpots = getHotSpots(SIZE_MAX);
+    u64 totalCycles = std::max<u64>(getTotalCycles(), 1);
+
+    std::string text = "address,cycles,percent,instructions\n";
+    char line[96];
+    for (const HotSpot& hotSpot : hotSpots) {
+        int length = std::snprintf(line, sizeof(line), "%0*X,%llu,%.3f,%llu\n",
+            (int)addressWidth, hotSpot.address, (unsigned long long)hotSpot.cycles,
+            100.0 * (double)hotSpot.cycles / (double)totalCycles, (unsigned long long)hotSpot.instructions);
+        text.append(line, length);
+    }
+
+    return writeFile(filename, text.data(), text.size());
+}
+
+PCProfiler::Page* PCProfiler::allocatePage(u32 pageIndex)
+{
+    Page* page = new Page;
+    m_pages[pageIndex].store(page, std::memory_order_release);
+    return page;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "types.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Executed instructions and cycles per guest PC, to find where emulated time is spent.
+// Counters live in pages allocated on first use: for 16-bit CPUs that adds up to a flat
+// 64K entry table, for PSX only pages of code that actually ran get allocated.
+// CPUs check isEnabled() once per runCycles() call, so a disabled profiler costs nothing.
+//
+// One thread records, any thread can query and enable.
+class PCProfiler
+{
+public:
+    struct HotSpot
+    {
+        u32 address;
+        u64 instructions;
+        u64 cycles;
+    };
+
+    // Address shifted right by alignmentShift has to fit in addressBits - alignmentShift bits.
+    explicit PCProfiler(u32 addressBits = 16, u32 alignmentShift = 0);
+    ~PCProfiler();
+
+    void setEnabled(bool enabled) { m_isEnabled.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return m_isEnabled.load(std::memory_order_relaxed); }
+
+    // emulation thread:
+    void record(u32 pc, u32 cycles)
+    {
+        u32 index = (pc >> m_alignmentShift) & m_indexMask;
+        Page* page = m_pages[index >> PAGE_BITS].load(std::memory_order_relaxed);
+        if (!page)
+            page = allocatePage(index >> PAGE_BITS);
+
+        // Single writer, so plain load and store are enough and cheaper than read-modify-write.
+        Counter& counter = page->counters[index & PAGE_MASK];
+        counter.instructions.store(counter.instructions.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        counter.cycles.store(counter.cycles.load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+        m_totalCycles.store(m_totalCycles.load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+    }
+
+    u64 getTotalCycles() const { return m_totalCycles.load(std::memory_order_relaxed); }
+    // At most maxCount addresses with most cycles, sorted by cycles.
+    std::vector<HotSpot> getHotSpots(size_t maxCount) const;
+    // Counts recorded while clearing may survive it.
+    void clear();
+    // Text table of all executed addresses, sorted by cycles.
+    bool exportToFile(const char* filename, unsigned int addressWidth) const;
+
+    PCProfiler(const PCProfiler&) = delete;
+    PCProfiler& operator=(const PCProfiler&) = delete;
+private:
+    static constexpr u32 PAGE_BITS = 12;
+    static constexpr u32 PAGE_MASK = (1u << PAGE_BITS) - 1;
+
+    struct Counter
+    {
+        std::atomic<u64> instructions{ 0 };
+        std::atomic<u64> cycles{ 0 };
+    };
+
+    struct Page
+    {
+        Counter counters[1u << PAGE_BITS];
+    };
+
+    Page* allocatePage(u32 pageIndex);
+
+    const u32 m_alignmentShift;
+    const u32 m_indexMask;
+    const u32 m_pageCount;
+    std::unique_ptr<std::atomic<Page*>[]> m_pages;
+
+    std::atomic<bool> m_isEnabled{ false };
+    std::atomic<u64> m_totalCycles{ 0 };
+};
@@ -0,0 +1,189 @@
+#include "rewind_buffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// Differing bytes separated by fewer equal bytes than this are cheaper to keep in one literal.
+static constexpr size_t MIN_EQUAL_RUN = 4;
+
+static void writeVarint(std::vector<u8>& out, size_t value)
+{
+    while (value >= 0x80) {
+        out.push_back((u8)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((u8)value);
+}
+
+static size_t readVarint(const u8* data, size_t& pos)
+{
+    size_t value = 0;
+    u32 shift = 0;
+    u8 byte;
+    do {
+        byte = data[pos++];
+        value |= (size_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+static size_t countEqual(const u8* lhs, const u8* rhs, size_t size)
+{
+    size_t i = 0;
+    while (size - i >= 8) {
+        u64 a, b;
+        std::memcpy(&a, lhs + i, 8);
+        std::memcpy(&b, rhs + i, 8);
+        if (a != b) break;
+        i += 8;
+    }
+    while (i < size && lhs[i] == rhs[i]) i++;
+    return i;
+}
+
+// Delta is a sequence of: varint equal run, varint literal size, literal bytes (old ^ new),
+// always closed by a final equal run. XOR makes the same delta turn either state into the other.
+static void encodeDelta(const u8* older, const u8* newer, size_t size, std::vector<u8>& out)
+{
+    out.clear();
+    size_t i = 0;
+    while (true) {
+        size_t equal = countEqual(older + i, newer + i, size - i);
+        writeVarint(out, equal);
+        i += equal;
+        if (i == size)
+            return;
+
+        size_t start = i;
+        while (i < size) {
+            if (older[i] != newer[i]) {
+                i++;
+                continue;
+            }
+
+            size_t run = countEqual(older + i, newer + i, std::min(MIN_EQUAL_RUN, size - i));
+            if (run == MIN_EQUAL_RUN || i + run == size)
+                break;
+            i += run;
+        }
+
+        writeVarint(out, i - start);
+        for (size_t j = start; j < i; j++)
+            out.push_back(older[j] ^ newer[j]);
+    }
+}
+
+static void applyDelta(u8* state, const u8* delta, size_t deltaSize)
+{
+    size_t pos = 0;
+    size_t offset = 0;
+    while (true) {
+        offset += readVarint(delta, pos);
+        if (pos == deltaSize)
+            return;
+
+        size_t literal = readVarint(delta, pos);
+        for (size_t i = 0; i < literal; i++)
+            state[offset + i] ^= delta[pos + i];
+        pos += literal;
+        offset += literal;
+    }
+}
+
+RewindBuffer::RewindBuffer(size_t maxFrames, size_t maxBytes) :
+    m_maxFrames{ maxFrames },
+    m_storage(maxBytes)
+{}
+
+void RewindBuffer::push(std::span<const u8> state)
+{
+    if (m_current.size() != state.size()) {
+        clear();
+        if (m_maxFrames > 0)
+            m_current.assign(state.begin(), state.end());
+        return;
+    }
+
+    encodeDelta(state.data(), m_current.data(), state.size(), m_encoded);
+    std::memcpy(m_current.data(), state.data(), state.size());
+
+    size_t offset;
+    if (allocate(m_encoded.size(), offset)) {
+        std::memcpy(m_storage.data() + offset, m_encoded.data(), m_encoded.size());
+        m_deltas.push_back({ offset, m_encoded.size() });
+        m_writeOffset = offset + m_encoded.size();
+        m_usedBytes += m_encoded.size();
+    }
+
+    while (!m_deltas.empty() && m_deltas.size() + 1 > m_maxFrames)
+        dropOldest();
+}
+
+bool RewindBuffer::pop(std::vector<u8>& state)
+{
+    if (m_current.empty())
+        return false;
+
+    state.assign(m_current.begin(), m_current.end());
+    if (m_deltas.empty()) {
+        m_current.clear();
+        return true;
+    }
+
+    Delta newest = m_deltas.back();
+    m_deltas.pop_back();
+    applyDelta(m_current.data(), m_storage.data() + newest.offset, newest.size);
+    m_usedBytes -= newest.size;
+    m_writeOffset = m_deltas.empty() ? 0 : m_deltas.back().offset + m_deltas.back().size;
+    return true;
+}
+
+void RewindBuffer::clear()
+{
+    m_deltas.clear();
+    m_writeOffset = 0;
+    m_usedBytes = 0;
+    m_current.clear();
+}
+
+bool RewindBuffer::allocate(size_t size, size_t& offset)
+{
+    if (size > m_storage.size()) {
+        // Can't be stored at all, older history can't be reached past it anyway.
+        while (!m_deltas.empty())
+            dropOldest();
+        return false;
+    }
+
+    while (!m_deltas.empty()) {
+        size_t oldest = m_deltas.front().offset;
+        if (m_writeOffset > oldest) {
+            if (m_storage.size() - m_writeOffset >= size) {
+                offset = m_writeOffset;
+                return true;
+            }
+            if (oldest >= size) {
+                offset = 0;
+                return true;
+            }
+        }
+        else if (oldest - m_writeOffset >= size) {
+            offset = m_writeOffset;
+            return true;
+        }
+
+        dropOldest();
+    }
+
+    offset = 0;
+    return true;
+}
+
+void RewindBuffer::dropOldest()
+{
+    m_usedBytes -= m_deltas.front().size;
+    m_deltas.pop_front();
+    if (m_deltas.empty())
+        m_writeOffset = 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "types.hpp"
+
+#include <deque>
+#include <span>
+#include <vector>
+
+// History of per-frame save states. Only the newest state is kept whole, older ones are
+// stored as XOR deltas against their successor, with unchanged bytes run-length encoded.
+// Frames mostly touch a small part of the state, so a delta is usually a few hundred bytes.
+// Deltas live in a fixed size ring, the oldest ones are dropped when it runs out of space.
+class RewindBuffer
+{
+public:
+    RewindBuffer(size_t maxFrames, size_t maxBytes);
+
+    // State of a different size than the previous one starts a new history.
+    void push(std::span<const u8> state);
+    // Removes the newest state and returns it, false when history is empty.
+    bool pop(std::vector<u8>& state);
+    void clear();
+
+    size_t getFrameCount() const { return m_current.empty() ? 0 : m_deltas.size() + 1; }
+    size_t getUsedBytes() const { return m_current.size() + m_usedBytes; }
+
+    RewindBuffer(const RewindBuffer&) = delete;
+    RewindBuffer& operator=(const RewindBuffer&) = delete;
+private:
+    struct Delta
+    {
+        size_t offset;
+        size_t size;
+    };
+
+    bool allocate(size_t size, size_t& offset);
+    void dropOldest();
+
+    const size_t m_maxFrames;
+    std::vector<u8> m_storage;
+    std::deque<Delta> m_deltas; // oldest first
+    size_t m_writeOffset = 0;
+    size_t m_usedBytes = 0;
+    std::vector<u8> m_current;
+    std::vector<u8> m_encoded;
+};
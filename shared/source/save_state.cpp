@@ -0,0 +1,23 @@
+#include "save_state.hpp"
+
+static constexpr u32 STATE_MAGIC = makeStateID("EMUS");
+
+StateWriter::StateWriter(std::vector<u8>& buffer, u32 machineID, u32 version) :
+    m_buffer{ buffer }
+{
+    m_buffer.clear();
+    write(STATE_MAGIC);
+    write(machineID);
+    write(version);
+}
+
+StateReader::StateReader(std::span<const u8> data, u32 machineID, u32 version) :
+    m_data{ data }
+{
+    u32 magic, savedMachineID, savedVersion;
+    read(magic);
+    read(savedMachineID);
+    read(savedVersion);
+    if (magic != STATE_MAGIC || savedMachineID != machineID || savedVersion != version)
+        m_isValid = false;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "types.hpp"
+
+#include <bit>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Save state is a flat blob:
+//   u32 magic, u32 machine id, u32 machine state version, then devices in an order fixed by the machine.
+// Values are little-endian and unpadded, memories are stored as raw blocks,
+// so taking a snapshot costs about as much as copying the guest RAM.
+static_assert(std::endian::native == std::endian::little, "Save states are written straight from memory!");
+
+constexpr u32 makeStateID(const char (&id)[5])
+{
+    return (u32)id[0] | ((u32)id[1] << 8) | ((u32)id[2] << 16) | ((u32)id[3] << 24);
+}
+
+class StateWriter
+{
+public:
+    // Buffer is cleared but keeps its capacity, so snapshots taken every frame don't allocate.
+    StateWriter(std::vector<u8>& buffer, u32 machineID, u32 version);
+
+    template<typename T>
+        requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+    void write(T value) { writeBytes(&value, sizeof(T)); }
+    void write(bool value) { write<u8>(value ? 1 : 0); }
+    void writeBytes(const void* data, size_t size)
+    {
+        if (size == 0) return;
+
+        size_t offset = m_buffer.size();
+        m_buffer.resize(offset + size);
+        std::memcpy(m_buffer.data() + offset, data, size);
+    }
+
+    StateWriter(const StateWriter&) = delete;
+    StateWriter& operator=(const StateWriter&) = delete;
+private:
+    std::vector<u8>& m_buffer;
+};
+
+// Reading past the end or a header mismatch makes reader invalid, from then on it only returns zeros.
+class StateReader
+{
+public:
+    StateReader(std::span<const u8> data, u32 machineID, u32 version);
+
+    template<typename T>
+        requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+    void read(T& value) { readBytes(&value, sizeof(T)); }
+    void read(bool& value) { u8 byte = 0; read(byte); value = byte != 0; }
+    void readBytes(void* data, size_t size)
+    {
+        if (!m_isValid || m_data.size() - m_offset < size) {
+            std::memset(data, 0, size);
+            m_isValid = false;
+            return;
+        }
+
+        std::memcpy(data, m_data.data() + m_offset, size);
+        m_offset += size;
+    }
+
+    // For devices that find saved data inconsistent with their configuration.
+    void invalidate() { m_isValid = false; }
+    bool isValid() const { return m_isValid; }
+    bool isAtEnd() const { return m_offset == m_data.size(); }
+
+    StateReader(const StateReader&) = delete;
+    StateReader& operator=(const StateReader&) = delete;
+private:
+    std::span<const u8> m_data;
+    size_t m_offset = 0;
+    bool m_isValid = true;
+};
@@ -0,0 +1,161 @@
+#include "scheduler.hpp"
+#include "save_state.hpp"
+
+#include <cassert>
+#include <utility>
+
+Scheduler::EventID Scheduler::registerEvent(EventCallback callback)
+{
+    m_events.push_back({ callback, NEVER, 0, NOT_QUEUED });
+    return (EventID)(m_events.size() - 1);
+}
+
+void Scheduler::reset()
+{
+    for (EventID id : m_heap)
+        m_events[id].heapIndex = NOT_QUEUED;
+
+    m_heap.clear();
+    m_now = 0;
+    m_order = 0;
+}
+
+void Scheduler::schedule(EventID id, u64 timestamp)
+{
+    assert(id < m_events.size() && "Unregistered event!");
+
+    Event& event = m_events[id];
+    event.timestamp = timestamp;
+    event.order = m_order++;
+
+    if (event.heapIndex == NOT_QUEUED) {
+        event.heapIndex = (u32)m_heap.size();
+        m_heap.push_back(id);
+        siftUp(event.heapIndex);
+    }
+    else {
+        siftUp(event.heapIndex);
+        siftDown(event.heapIndex);
+    }
+}
+
+void Scheduler::cancel(EventID id)
+{
+    assert(id < m_events.size() && "Unregistered event!");
+
+    if (m_events[id].heapIndex != NOT_QUEUED)
+        removeAt(m_events[id].heapIndex);
+}
+
+void Scheduler::advance(u64 cycles)
+{
+    u64 target = m_now + cycles;
+    while (!m_heap.empty() && m_events[m_heap.front()].timestamp <= target) {
+        EventID id = m_heap.front();
+        removeAt(0);
+
+        if (m_events[id].timestamp > m_now)
+            m_now = m_events[id].timestamp;
+        m_events[id].callback();
+    }
+
+    m_now = target;
+}
+
+void Scheduler::saveState(StateWriter& writer) const
+{
+    writer.write(m_now);
+    writer.write(m_order);
+    writer.write((u32)m_events.size());
+    for (const Event& event : m_events) {
+        writer.write(event.heapIndex != NOT_QUEUED);
+        writer.write(event.timestamp);
+        writer.write(event.order);
+    }
+}
+
+void Scheduler::loadState(StateReader& reader)
+{
+    reader.read(m_now);
+    reader.read(m_order);
+    u32 eventCount;
+    reader.read(eventCount);
+    if (eventCount != m_events.size()) {
+        reader.invalidate();
+        return;
+    }
+
+    m_heap.clear();
+    for (EventID id = 0; id < eventCount; id++) {
+        Event& event = m_events[id];
+        bool isQueued;
+        reader.read(isQueued);
+        reader.read(event.timestamp);
+        reader.read(event.order);
+
+        event.heapIndex = NOT_QUEUED;
+        if (isQueued) {
+            event.heapIndex = (u32)m_heap.size();
+            m_heap.push_back(id);
+            siftUp(event.heapIndex);
+        }
+    }
+}
+
+bool Scheduler::isEarlier(EventID lhs, EventID rhs) const
+{
+    const Event& a = m_events[lhs];
+    const Event& b = m_events[rhs];
+    return a.timestamp != b.timestamp ? a.timestamp < b.timestamp : a.order < b.order;
+}
+
+void Scheduler::siftUp(u32 index)
+{
+    while (index > 0) {
+        u32 parent = (index - 1) / 2;
+        if (!isEarlier(m_heap[index], m_heap[parent])) break;
+
+        swapNodes(index, parent);
+        index = parent;
+    }
+}
+
+void Scheduler::siftDown(u32 index)
+{
+    u32 size = (u32)m_heap.size();
+    while (true) {
+        u32 smallest = index;
+        u32 left = index * 2 + 1;
+        u32 right = left + 1;
+        if (left < size && isEarlier(m_heap[left], m_heap[smallest])) smallest = left;
+        if (right < size && isEarlier(m_heap[right], m_heap[smallest])) smallest = right;
+        if (smallest == index) break;
+
+        swapNodes(index, smallest);
+        index = smallest;
+    }
+}
+
+void Scheduler::swapNodes(u32 a, u32 b)
+{
+    std::swap(m_heap[a], m_heap[b]);
+    m_events[m_heap[a]].heapIndex = a;
+    m_events[m_heap[b]].heapIndex = b;
+}
+
+void Scheduler::removeAt(u32 index)
+{
+    m_events[m_heap[index]].heapIndex = NOT_QUEUED;
+
+    u32 last = (u32)m_heap.size() - 1;
+    if (index != last) {
+        m_heap[index] = m_heap[last];
+        m_events[m_heap[index]].heapIndex = index;
+    }
+    m_heap.pop_back();
+
+    if (index < m_heap.size()) {
+        siftUp(index);
+        siftDown(index);
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "types.hpp"
+
+#include <functional>
+#include <vector>
+
+class StateWriter;
+class StateReader;
+
+// Min-heap of device events keyed by absolute cycle timestamps.
+// Devices register their events once and (re)schedule them whenever their next
+// interesting cycle changes, machine runs CPU freely until the nearest deadline.
+class Scheduler
+{
+public:
+    using EventID = u32;
+    using EventCallback = std::function<void()>;
+
+    static constexpr u64 NEVER = ~0ull;
+
+    EventID registerEvent(EventCallback callback);
+
+    void reset(); // drops pending events and rewinds time, registrations are kept
+    void schedule(EventID id, u64 timestamp);
+    void scheduleIn(EventID id, u64 delay) { schedule(id, m_now + delay); }
+    void cancel(EventID id);
+    bool isScheduled(EventID id) const { return m_events[id].heapIndex != NOT_QUEUED; }
+
+    // Moves time forward and dispatches every event due on the way, in timestamp order.
+    // During a callback getNow() returns timestamp of the event, so periodic events
+    // rescheduled with scheduleIn() do not drift.
+    void advance(u64 cycles);
+
+    u64 getNow() const { return m_now; }
+    u64 getNextEventTime() const { return m_heap.empty() ? NEVER : m_events[m_heap.front()].timestamp; }
+    u64 getCyclesUntilNextEvent() const { return m_heap.empty() ? NEVER : getNextEventTime() - m_now; }
+
+    // Callbacks are not saved, events have to be registered in the same order before loading.
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
+    Scheduler() = default;
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+private:
+    static constexpr u32 NOT_QUEUED = ~0u;
+
+    struct Event {
+        EventCallback callback;
+        u64 timestamp;
+        u64 order; // keeps events with the same timestamp in scheduling order
+        u32 heapIndex;
+    };
+
+    bool isEarlier(EventID lhs, EventID rhs) const;
+    void siftUp(u32 index);
+    void siftDown(u32 index);
+    void swapNodes(u32 a, u32 b);
+    void removeAt(u32 index);
+
+    std::vector<Event> m_events;
+    std::vector<EventID> m_heap;
+    u64 m_now = 0;
+    u64 m_order = 0;
+};
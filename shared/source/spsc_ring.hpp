@@ -0,0 +1,70 @@
+#pragma once
+#include "types.hpp"
+
+#include <atomic>
+#include <bit>
+#include <memory>
+
+// Lock-free single producer / single consumer FIFO of fixed capacity.
+// Producer never waits, when the ring is full push fails and the element is dropped,
+// which suits debug records that must not slow emulation down.
+//
+// Head and tail live on separate cache lines and each side keeps a cached copy of the
+// other's index, so in steady state push and pop touch shared cache lines only when needed.
+template<typename T>
+class SPSCRing
+{
+public:
+    // Capacity is rounded up to a power of two.
+    explicit SPSCRing(size_t capacity) :
+        m_mask{ std::bit_ceil(capacity < 2 ? 2 : capacity) - 1 },
+        m_elements{ new T[m_mask + 1] }
+    {}
+
+    // producer side:
+    bool push(const T& element)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail > m_mask) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail > m_mask)
+                return false;
+        }
+
+        m_elements[head & m_mask] = element;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side:
+    bool pop(T& element)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cachedHead) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail == m_cachedHead)
+                return false;
+        }
+
+        element = m_elements[tail & m_mask];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t getCapacity() const { return m_mask + 1; }
+
+    SPSCRing(const SPSCRing&) = delete;
+    SPSCRing& operator=(const SPSCRing&) = delete;
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    const size_t m_mask;
+    std::unique_ptr<T[]> m_elements;
+
+    // Indices only ever grow, element position is index & mask.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_head{ 0 };
+    size_t m_cachedTail = 0; // producer only
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail{ 0 };
+    size_t m_cachedHead = 0; // consumer only
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include "types.hpp"
+
+#include <atomic>
+
+// Lock-free single producer / single consumer handoff of whole frames.
+// Producer draws into the write buffer and publishes it with one atomic exchange,
+// consumer always gets the newest published buffer without ever blocking the producer.
+//
+// Sequence number is incremented on every publish, consumer can compare it with
+// the previous one to find out whether a new frame actually arrived.
+template<typename T>
+class TripleBuffer
+{
+public:
+    explicit TripleBuffer(const T& initial = T{}) :
+        m_buffers{ initial, initial, initial }
+    {}
+
+    // producer side:
+    T& getWriteBuffer() { return m_buffers[m_writeIndex]; }
+    void publish()
+    {
+        u64 state = m_writeIndex | FRESH_BIT | (++m_writeSequence << SEQUENCE_SHIFT);
+        m_writeIndex = m_state.exchange(state, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // consumer side:
+    const T& acquire()
+    {
+        if (m_state.load(std::memory_order_relaxed) & FRESH_BIT) {
+            u64 state = m_state.exchange(m_readIndex, std::memory_order_acq_rel);
+            m_readIndex = state & INDEX_MASK;
+            m_readSequence = state >> SEQUENCE_SHIFT;
+        }
+        return m_buffers[m_readIndex];
+    }
+    // Sequence of the buffer returned by the last acquire, 0 until first frame is published.
+    u64 getSequence() const { return m_readSequence; }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+private:
+    // state layout: bits 0-1 index of the middle buffer, bit 2 fresh flag, bits 3-63 sequence
+    static constexpr u64 INDEX_MASK = 0b11;
+    static constexpr u64 FRESH_BIT = 0b100;
+    static constexpr u64 SEQUENCE_SHIFT = 3;
+
+    T m_buffers[3];
+    std::atomic<u64> m_state{ 1 };
+
+    // producer only:
+    u64 m_writeIndex = 0;
+    u64 m_writeSequence = 0;
+
+    // consumer only:
+    u64 m_readIndex = 2;
+    u64 m_readSequence = 0;
+};
@@ -0,0 +1,101 @@
+#include "shared/source/breakpoints.hpp"
+#include "shared/source/devices/cpu6502/cpu6502.hpp"
+#include "shared/source/memory_bus.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(BreakpointsTests, ExecuteBreakpointIsSkippedOnceAfterResume)
+{
+    Breakpoints breakpoints{ 32, 2 };
+    EXPECT_FALSE(breakpoints.isArmed());
+
+    breakpoints.addBreakpoint(0xBFC00180);
+    EXPECT_TRUE(breakpoints.isArmed());
+    EXPECT_FALSE(breakpoints.checkExecute(0xBFC00184));
+    EXPECT_TRUE(breakpoints.checkExecute(0xBFC00180));
+
+    u32 address;
+    u8 type;
+    ASSERT_TRUE(breakpoints.getHit(address, type));
+    EXPECT_EQ(address, 0xBFC00180u);
+    EXPECT_EQ(type, Breakpoints::EXECUTE);
+
+    breakpoints.resume();
+    EXPECT_FALSE(breakpoints.hasHit());
+    EXPECT_FALSE(breakpoints.checkExecute(0xBFC00180));
+    EXPECT_TRUE(breakpoints.checkExecute(0xBFC00180));
+
+    breakpoints.remove(0xBFC00180);
+    EXPECT_FALSE(breakpoints.isArmed());
+    EXPECT_FALSE(breakpoints.checkExecute(0xBFC00180));
+}
+
+struct BreakpointsCPUTests :
+    public testing::Test
+{
+    u8 ram[0x10000]{};
+    MemoryBus16 bus;
+    CPU6502Core<MemoryBus16> cpu{ bus };
+    Breakpoints breakpoints;
+
+    BreakpointsCPUTests()
+    {
+        // 0200: INX; STX $10; JMP $0200
+        const u8 program[] = { 0xE8, 0x86, 0x10, 0x4C, 0x00, 0x02 };
+        std::memcpy(ram + 0x200, program, sizeof(program));
+
+        bus.mapMemory({ 0x0000, 0xFFFF }, ram);
+        bus.setBreakpoints(&breakpoints);
+        cpu.setBreakpoints(&breakpoints);
+        cpu.reset();
+        cpu.setPC(0x0200);
+    }
+};
+
+TEST_F(BreakpointsCPUTests, ConditionalBreakpointStopsRunAtMatchingRegister)
+{
+    u32 registerReads = 0;
+    breakpoints.mapReadRegisterCallback({ "X" }, [&](u32) -> u32 { registerReads++; return cpu.getX(); });
+    breakpoints.addBreakpoint(0x0201, { 0, 5 });
+
+    u32 cycles = cpu.runCycles(1000);
+    EXPECT_LT(cycles, 1000u);
+    EXPECT_TRUE(breakpoints.hasHit());
+    EXPECT_EQ(cpu.getPC(), 0x0201);
+    EXPECT_EQ(cpu.getX(), 5);
+    EXPECT_EQ(registerReads, 5u); // evaluated only when reaching the address
+
+    // nothing runs until resumed
+    EXPECT_EQ(cpu.runCycles(1000), 0u);
+
+    breakpoints.resume();
+    EXPECT_GE(cpu.runCycles(100), 100u);
+    EXPECT_FALSE(breakpoints.hasHit());
+}
+
+TEST_F(BreakpointsCPUTests, WriteWatchpointRedirectsOnlyItsPage)
+{
+    breakpoints.addWatchpoint(0x0010, Breakpoints::WRITE);
+    bus.syncWatchpoints();
+
+    EXPECT_EQ(bus.getReadPointer(0x0010), ram + 0x10);
+    EXPECT_EQ(bus.getReadPointer(0x0200), ram + 0x200);
+
+    // Remapping keeps page watched.
+    bus.mapMemory({ 0x0000, 0x00FF }, ram);
+
+    cpu.runCycles(1000);
+    u32 address;
+    u8 type;
+    ASSERT_TRUE(breakpoints.getHit(address, type));
+    EXPECT_EQ(address, 0x0010u);
+    EXPECT_EQ(type, Breakpoints::WRITE);
+    EXPECT_EQ(cpu.getPC(), 0x0203); // stopped right after the store
+    EXPECT_EQ(ram[0x10], 1);        // and store went through
+
+    breakpoints.clear();
+    bus.syncWatchpoints();
+    breakpoints.resume();
+    bus.write8(0x0010, 0xAA);
+    EXPECT_FALSE(breakpoints.hasHit());
+}
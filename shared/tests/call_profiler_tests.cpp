@@ -0,0 +1,82 @@
+#include "shared/source/call_profiler.hpp"
+#include "shared/source/devices/cpu6502/cpu6502.hpp"
+#include "shared/source/file_io.hpp"
+#include "shared/source/memory_bus.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+TEST(CallProfilerTests, CyclesAreAttributedThroughCallStack)
+{
+    CallProfiler profiler;
+    auto run = [&](u32 cycles) { profiler.addCycles(profiler.getCurrentNode(), cycles); };
+
+    run(1);               // outside of any call
+    profiler.call(0x1000);
+    run(10);
+    profiler.call(0x2000);
+    run(5);
+    profiler.call(0x2000); // recursion
+    run(5);
+    profiler.ret();
+    profiler.ret();
+    run(10);
+    profiler.ret();
+    profiler.ret();        // unmatched, ignored
+    run(1);
+
+    auto functions = profiler.getFunctions();
+    ASSERT_EQ(functions.size(), 2u);
+    EXPECT_EQ(functions[0].address, 0x1000u);
+    EXPECT_EQ(functions[0].calls, 1u);
+    EXPECT_EQ(functions[0].inclusiveCycles, 30u);
+    EXPECT_EQ(functions[0].exclusiveCycles, 20u);
+    EXPECT_EQ(functions[1].address, 0x2000u);
+    EXPECT_EQ(functions[1].calls, 2u);
+    EXPECT_EQ(functions[1].inclusiveCycles, 10u);
+    EXPECT_EQ(functions[1].exclusiveCycles, 10u);
+
+    std::string filename = (std::filesystem::temp_directory_path() / "call_profiler_tests.folded").string();
+    ASSERT_TRUE(profiler.exportCollapsedStacks(filename.c_str(), 4));
+
+    char text[256];
+    size_t size = sizeof(text);
+    readFile(filename.c_str(), text, size);
+    std::remove(filename.c_str());
+    EXPECT_EQ(std::string(text, size), "[root] 2\n1000 20\n1000;2000 5\n1000;2000;2000 5\n");
+}
+
+TEST(CallProfilerTests, CPU6502ReportsSubroutines)
+{
+    u8 ram[0x10000]{};
+    // 0200: JSR $0300; JMP $0200
+    // 0300: INX; RTS
+    const u8 main[] = { 0x20, 0x00, 0x03, 0x4C, 0x00, 0x02 };
+    const u8 subroutine[] = { 0xE8, 0x60 };
+    std::memcpy(ram + 0x200, main, sizeof(main));
+    std::memcpy(ram + 0x300, subroutine, sizeof(subroutine));
+
+    MemoryBus16 bus;
+    bus.mapMemory({ 0x0000, 0xFFFF }, ram);
+    CPU6502Core<MemoryBus16> cpu{ bus };
+    CallProfiler profiler;
+    cpu.setCallProfiler(&profiler);
+    cpu.reset();
+    cpu.setPC(0x0200);
+
+    cpu.runCycles(100);
+    EXPECT_TRUE(profiler.getFunctions().empty());
+
+    profiler.setEnabled(true);
+    u32 cycles = cpu.runCycles(1000);
+
+    auto functions = profiler.getFunctions();
+    ASSERT_EQ(functions.size(), 1u);
+    EXPECT_EQ(functions[0].address, 0x0300u);
+    EXPECT_GT(functions[0].calls, 10u);
+    EXPECT_EQ(functions[0].inclusiveCycles, functions[0].exclusiveCycles);
+    EXPECT_LT(functions[0].inclusiveCycles, cycles);
+}
@@ -1,5 +1,6 @@
 #include "shared/source/devices/cpu6502/cpu6502.hpp"
 #include "shared/source/file_io.hpp"
+#include "shared/source/memory_bus.hpp"
 
 #include <gtest/gtest.h>
 
@@ -41,3 +42,20 @@ TEST_F(CPU6502Tests, qwerty)
 
     EXPECT_EQ(cpu.getPC(), 0x3469);
 }
+
+TEST_F(CPU6502Tests, FunctionalTestOnMemoryBus)
+{
+    size_t size = 0x10000;
+    ASSERT_TRUE(readFile("test_files/6502/6502_functional_test.bin", (char*)ram, size, true));
+
+    MemoryBus16 bus;
+    bus.mapMemory({ 0x0000, 0xFFFF }, ram);
+    CPU6502Core<MemoryBus16> busCPU{ bus };
+
+    busCPU.reset();
+    busCPU.setPC(0x0400);
+
+    busCPU.runUntilEndlessLoop();
+
+    EXPECT_EQ(busCPU.getPC(), 0x3469);
+}
@@ -29,3 +29,29 @@ TEST_F(CPU8080Tests, JMPTest)
     preExecutionState.PC = 0xDEAD;
     compareCPUStates(preExecutionState, postExecutionState);
 }
+
+TEST_F(CPU8080Tests, RunInstructionTest)
+{
+    rom[0x0] = 0x00; // NOP
+    rom[0x1] = 0xC3;
+    rom[0x2] = 0x00;
+    rom[0x3] = 0x00; // JMP 0x0000
+
+    EXPECT_EQ(cpu.runInstruction(), 4);
+    EXPECT_EQ(cpu.getState().PC, 0x0001);
+    EXPECT_EQ(cpu.runInstruction(), 10);
+    EXPECT_EQ(cpu.getState().PC, 0x0000);
+}
+
+TEST_F(CPU8080Tests, RunCyclesTest)
+{
+    rom[0x0] = 0x00; // NOP
+    rom[0x1] = 0xC3;
+    rom[0x2] = 0x00;
+    rom[0x3] = 0x00; // JMP 0x0000
+
+    EXPECT_EQ(cpu.runCycles(28), 28);
+    EXPECT_EQ(cpu.getState().PC, 0x0000);
+    EXPECT_EQ(cpu.runCycles(5), 14);
+    EXPECT_EQ(cpu.getState().PC, 0x0000);
+}
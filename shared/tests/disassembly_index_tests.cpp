@@ -0,0 +1,66 @@
+#include "shared/source/disassembly_index.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+TEST(DisassemblyIndexTests, RecordsEachAddressOnce)
+{
+    DisassemblyIndex index{ 30, 2 };
+    EXPECT_EQ(index.getCount(), 0u);
+    EXPECT_FALSE(index.contains(0xBFC00000));
+
+    for (u32 i = 0; i < 3; i++)
+        for (u32 address = 0xBFC00000; address < 0xBFC00040; address += 4)
+            index.record(address);
+
+    EXPECT_EQ(index.getCount(), 16u);
+    EXPECT_TRUE(index.contains(0xBFC00000));
+    EXPECT_TRUE(index.contains(0xBFC0003C));
+    EXPECT_FALSE(index.contains(0xBFC00040));
+    EXPECT_FALSE(index.contains(0x80000000));
+}
+
+TEST(DisassemblyIndexTests, EmptyIndexHasNoLines)
+{
+    DisassemblyIndex index{ 16, 0 };
+    u32 address;
+    EXPECT_FALSE(index.select(0, address));
+    EXPECT_FALSE(index.findNext(0, address));
+    EXPECT_EQ(index.rank(0xFFFF), 0u);
+}
+
+TEST(DisassemblyIndexTests, ListsAddressesInOrderAcrossPages)
+{
+    // Scattered like PSX code: RAM in KSEG0, BIOS in KSEG1, spanning many pages and groups.
+    std::vector<u32> addresses;
+    for (u32 i = 0; i < 200; i++) {
+        addresses.push_back(0x80000000 + i * 0x1234 * 4);
+        addresses.push_back(0xBFC00000 + i * 4);
+    }
+    addresses.push_back(0x00000000);
+    addresses.push_back(0xFFFFFFFC);
+
+    DisassemblyIndex index{ 30, 2 };
+    for (u32 address : addresses)
+        index.record(address);
+
+    std::sort(addresses.begin(), addresses.end());
+    ASSERT_EQ(index.getCount(), addresses.size());
+
+    u32 address;
+    ASSERT_TRUE(index.select(0, address));
+    for (u32 i = 0; i < addresses.size(); i++) {
+        ASSERT_EQ(address, addresses[i]) << "line " << i;
+        EXPECT_EQ(index.rank(address), i);
+
+        u32 selected;
+        ASSERT_TRUE(index.select(i, selected));
+        EXPECT_EQ(selected, address);
+
+        bool hasNext = index.findNext(address, address);
+        EXPECT_EQ(hasNext, i + 1 < addresses.size());
+    }
+    EXPECT_FALSE(index.select((u32)addresses.size(), address));
+}
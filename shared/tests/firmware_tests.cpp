@@ -0,0 +1,23 @@
+#include "shared/source/firmware.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(FirmwareTests, EmbeddedImageIsUsedInPlace)
+{
+    static constexpr u8 embedded[4] = { 1, 2, 3, 4 };
+
+    Firmware firmware;
+    EXPECT_TRUE(firmware.load(embedded, "firmware_tests_missing.bin", 4));
+    EXPECT_TRUE(firmware.isEmbedded());
+    EXPECT_EQ(firmware.getData(), embedded);
+}
+
+TEST(FirmwareTests, MissingImageIsZeroFilled)
+{
+    Firmware firmware;
+    EXPECT_FALSE(firmware.load({}, "firmware_tests_missing.bin", 0x100));
+    EXPECT_FALSE(firmware.isEmbedded());
+    ASSERT_NE(firmware.getData(), nullptr);
+    for (u32 i = 0; i < 0x100; i++)
+        EXPECT_EQ(firmware.getData()[i], 0);
+}
@@ -0,0 +1,41 @@
+#include "shared/source/frame_pacer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+TEST(FramePacerTests, UnlimitedSpeedDoesNotWait)
+{
+    FramePacer pacer{ 1.0 };
+    pacer.setSpeed(FramePacer::UNLIMITED_SPEED);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; i++)
+        pacer.waitForNextFrame();
+
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+    EXPECT_EQ(pacer.getStats().frames, 100);
+}
+
+TEST(FramePacerTests, FramesAreNotFinishedBeforeTheirDeadline)
+{
+    FramePacer pacer{ 1000.0 };
+
+    auto start = std::chrono::steady_clock::now();
+    pacer.reset();
+    for (int i = 0; i < 20; i++)
+        pacer.waitForNextFrame();
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+    // half speed doubles frame time
+    pacer.setSpeed(50);
+    start = std::chrono::steady_clock::now();
+    pacer.reset();
+    for (int i = 0; i < 10; i++)
+        pacer.waitForNextFrame();
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+    auto stats = pacer.getStats();
+    EXPECT_EQ(stats.frames, 30);
+    EXPECT_GE(stats.maxDriftUs, 0);
+}
@@ -0,0 +1,60 @@
+#include "shared/source/headless_application.hpp"
+#include "shared/source/file_io.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+struct TestHeadlessApplication :
+    public HeadlessApplication
+{
+    TestHeadlessApplication() :
+        HeadlessApplication{ {
+                .name = "test",
+                .screenWidth = 2,
+                .screenHeight = 1,
+                .cyclesPerFrame = 10,
+                .clockFrequency = 1000,
+                .needsROM = false
+        } }
+    {}
+
+    u32 runCycles(u32 budget) override {
+        EXPECT_LE(budget, 10u);
+        totalCycles += budget;
+        calls++;
+        return budget;
+    }
+
+    std::span<const u32> acquireScreenPixels() override { return pixels; }
+
+    u32 pixels[2]{ 0xFF0000FF, 0xFF00FF00 }; // red, green
+    u64 totalCycles = 0;
+    u32 calls = 0;
+};
+
+TEST(HeadlessApplicationTests, RunsRequestedCyclesInFrameSlices)
+{
+    TestHeadlessApplication app;
+    char* argv[] = { (char*)"test", (char*)"--cycles", (char*)"25" };
+
+    EXPECT_EQ(app.run(3, argv), 0);
+    EXPECT_EQ(app.totalCycles, 25);
+    EXPECT_EQ(app.calls, 3);
+}
+
+TEST(HeadlessApplicationTests, DumpsFramebufferAsPPM)
+{
+    TestHeadlessApplication app;
+    char* argv[] = { (char*)"test", (char*)"--frames", (char*)"1", (char*)"--dump-frame", (char*)"headless_test_frame.ppm" };
+
+    ASSERT_EQ(app.run(5, argv), 0);
+
+    char data[32]{};
+    size_t size = sizeof(data);
+    readFile("headless_test_frame.ppm", data, size, true);
+
+    const char expected[] = "P6\n2 1\n255\n\xFF\x00\x00\x00\xFF\x00";
+    ASSERT_EQ(size, sizeof(expected) - 1);
+    EXPECT_EQ(std::memcmp(data, expected, size), 0);
+}
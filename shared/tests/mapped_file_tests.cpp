@@ -0,0 +1,61 @@
+#include "shared/source/file_io.hpp"
+#include "shared/source/mapped_file.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+TEST(MappedFileTests, ReadWriteMappingCreatesAndUpdatesFile)
+{
+    std::string filename = (std::filesystem::temp_directory_path() / "mapped_file_tests_rw.sav").string();
+    std::remove(filename.c_str());
+
+    {
+        MappedFile file;
+        ASSERT_TRUE(file.open(filename.c_str(), MappedFile::Mode::ReadWrite, 0x2000));
+        ASSERT_EQ(file.getSize(), 0x2000u);
+        EXPECT_EQ(file.getData()[0x1FFF], 0);
+        file.getData()[0] = 0x12;
+        file.getData()[0x1FFF] = 0x34;
+        EXPECT_TRUE(file.flush());
+    }
+
+    char data[0x2000];
+    size_t size = sizeof(data);
+    ASSERT_TRUE(readFile(filename.c_str(), data, size, true));
+    EXPECT_EQ(size, 0x2000u);
+    EXPECT_EQ((u8)data[0], 0x12);
+    EXPECT_EQ((u8)data[0x1FFF], 0x34);
+
+    // Existing contents survive reopening.
+    MappedFile file;
+    ASSERT_TRUE(file.open(filename.c_str(), MappedFile::Mode::ReadWrite, 0x2000));
+    EXPECT_EQ(file.getData()[0], 0x12);
+    file.close();
+    std::remove(filename.c_str());
+}
+
+TEST(MappedFileTests, CopyOnWriteMappingLeavesFileUnchanged)
+{
+    std::string filename = (std::filesystem::temp_directory_path() / "mapped_file_tests_cow.bin").string();
+    const char contents[] = "ROM";
+    ASSERT_TRUE(writeFile(filename.c_str(), contents, 3, true));
+
+    MappedFile file;
+    EXPECT_FALSE(file.open(filename.c_str(), MappedFile::Mode::ReadOnly, 4));
+    ASSERT_TRUE(file.open(filename.c_str(), MappedFile::Mode::CopyOnWrite));
+    ASSERT_EQ(file.getSize(), 3u);
+    file.getData()[0] = 'X';
+    EXPECT_EQ(file.getData()[0], 'X');
+    file.close();
+
+    size_t size = 0;
+    ASSERT_TRUE(readFile(filename.c_str(), nullptr, size, true));
+    EXPECT_EQ(size, 3u);
+    char data[3];
+    ASSERT_TRUE(readFile(filename.c_str(), data, size, true));
+    EXPECT_EQ(std::string(data, size), "ROM");
+    std::remove(filename.c_str());
+}
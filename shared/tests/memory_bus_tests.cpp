@@ -0,0 +1,92 @@
+#include "shared/source/memory_bus.hpp"
+
+#include <gtest/gtest.h>
+
+struct MemoryBus16Tests :
+    public testing::Test
+{
+    u8 ram[0x400]{};
+    u8 rom[0x100]{};
+
+    MemoryBus16 bus;
+};
+
+TEST_F(MemoryBus16Tests, MemoryPagesAccessHostMemory)
+{
+    bus.mapMemory({ 0x0000, 0x03FF }, ram);
+
+    bus.write8(0x0123, 0x45);
+    EXPECT_EQ(ram[0x123], 0x45);
+    EXPECT_EQ(bus.read8(0x0123), 0x45);
+    EXPECT_EQ(bus.getReadPointer(0x0123), ram + 0x123);
+}
+
+TEST_F(MemoryBus16Tests, MaskMirrorsMemoryOverRange)
+{
+    bus.mapMemory({ 0x8000, 0x8FFF }, ram, 0x3FF);
+
+    bus.write8(0x8C05, 0x12);
+    EXPECT_EQ(ram[0x005], 0x12);
+    EXPECT_EQ(bus.read8(0x8005), 0x12);
+    EXPECT_EQ(bus.read8(0x8405), 0x12);
+}
+
+TEST_F(MemoryBus16Tests, ReadOnlyMemoryAndWriteCallbackShareRange)
+{
+    rom[0x10] = 0xAB;
+    u16 writtenAddress = 0;
+    u8 writtenData = 0;
+    bus.mapReadMemory({ 0xFF00, 0xFFFF }, rom);
+    bus.mapWriteCallback({ 0xFF00, 0xFFFF }, [&](u16 address, u8 data) {
+        writtenAddress = address;
+        writtenData = data;
+    });
+
+    bus.write8(0xFF10, 0x77);
+    EXPECT_EQ(bus.read8(0xFF10), 0xAB);
+    EXPECT_EQ(writtenAddress, 0xFF10);
+    EXPECT_EQ(writtenData, 0x77);
+}
+
+TEST_F(MemoryBus16Tests, CallbackPagesReceiveFullAddress)
+{
+    bus.mapReadCallback({ 0xD000, 0xD3FF }, [](u16 address) { return u8(address >> 4); });
+
+    EXPECT_EQ(bus.read8(0xD120), 0x12);
+    EXPECT_EQ(bus.getReadPointer(0xD120), nullptr);
+}
+
+TEST_F(MemoryBus16Tests, OpenBusReadsFFAndIgnoresWrites)
+{
+    bus.mapOpenBus({ 0x2000, 0x7FFF });
+
+    bus.write8(0x3000, 0x00);
+    EXPECT_EQ(bus.read8(0x3000), 0xFF);
+}
+
+TEST_F(MemoryBus16Tests, RemappingSwitchesBanks)
+{
+    rom[0x42] = 0x11;
+    ram[0x42] = 0x22;
+
+    bus.mapReadMemory({ 0xE000, 0xE0FF }, rom);
+    EXPECT_EQ(bus.read8(0xE042), 0x11);
+
+    bus.mapReadMemory({ 0xE000, 0xE0FF }, ram);
+    EXPECT_EQ(bus.read8(0xE042), 0x22);
+}
+
+TEST_F(MemoryBus16Tests, AddedCallbackCanBeMappedAgain)
+{
+    u8 callbackIndex = bus.addReadCallback([](u16) -> u8 { return 0x33; });
+    ram[0x42] = 0x22;
+
+    bus.mapReadCallback({ 0xA000, 0xA0FF }, callbackIndex);
+    EXPECT_EQ(bus.read8(0xA042), 0x33);
+
+    bus.mapReadMemory({ 0xA000, 0xA0FF }, ram);
+    EXPECT_EQ(bus.read8(0xA042), 0x22);
+
+    bus.mapReadCallback({ 0xA000, 0xA0FF }, callbackIndex);
+    EXPECT_EQ(bus.read8(0xA042), 0x33);
+}
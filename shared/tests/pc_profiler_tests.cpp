@@ -0,0 +1,57 @@
+#include "shared/source/devices/cpu6502/cpu6502.hpp"
+#include "shared/source/memory_bus.hpp"
+#include "shared/source/pc_profiler.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(PCProfilerTests, HotSpotsAreSortedByCycles)
+{
+    PCProfiler profiler{ 32, 2 };
+    profiler.record(0xBFC00000, 1);
+    profiler.record(0x80010000, 1);
+    profiler.record(0x80010000, 1);
+    profiler.record(0x80010004, 5);
+
+    auto hotSpots = profiler.getHotSpots(2);
+    ASSERT_EQ(hotSpots.size(), 2u);
+    EXPECT_EQ(hotSpots[0].address, 0x80010004u);
+    EXPECT_EQ(hotSpots[0].cycles, 5u);
+    EXPECT_EQ(hotSpots[0].instructions, 1u);
+    EXPECT_EQ(hotSpots[1].address, 0x80010000u);
+    EXPECT_EQ(hotSpots[1].cycles, 2u);
+    EXPECT_EQ(hotSpots[1].instructions, 2u);
+    EXPECT_EQ(profiler.getTotalCycles(), 8u);
+
+    profiler.clear();
+    EXPECT_TRUE(profiler.getHotSpots(2).empty());
+    EXPECT_EQ(profiler.getTotalCycles(), 0u);
+}
+
+TEST(PCProfilerTests, CPURecordsOnlyWhileEnabled)
+{
+    u8 ram[0x10000]{};
+    // 0200: INX; JMP $0200
+    const u8 program[] = { 0xE8, 0x4C, 0x00, 0x02 };
+    std::memcpy(ram + 0x200, program, sizeof(program));
+
+    MemoryBus16 bus;
+    bus.mapMemory({ 0x0000, 0xFFFF }, ram);
+    CPU6502Core<MemoryBus16> cpu{ bus };
+    PCProfiler profiler;
+    cpu.setProfiler(&profiler);
+    cpu.reset();
+    cpu.setPC(0x0200);
+
+    cpu.runCycles(100);
+    EXPECT_EQ(profiler.getTotalCycles(), 0u);
+
+    profiler.setEnabled(true);
+    u32 cycles = cpu.runCycles(1000);
+    EXPECT_EQ(profiler.getTotalCycles(), cycles);
+
+    auto hotSpots = profiler.getHotSpots(8);
+    ASSERT_EQ(hotSpots.size(), 2u);
+    EXPECT_EQ(hotSpots[0].address, 0x0201u); // JMP takes more cycles than INX
+    EXPECT_EQ(hotSpots[1].address, 0x0200u);
+    EXPECT_EQ(hotSpots[0].cycles + hotSpots[1].cycles, cycles);
+}
@@ -0,0 +1,89 @@
+#include "shared/source/rewind_buffer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+static std::vector<std::vector<u8>> makeStates(size_t count, size_t size)
+{
+    std::mt19937 rng{ 1234 };
+    std::vector<std::vector<u8>> states;
+    std::vector<u8> state(size);
+    for (auto& byte : state) byte = (u8)rng();
+
+    for (size_t i = 0; i < count; i++) {
+        // Few scattered changes and one small block, like a frame's worth of RAM writes.
+        for (size_t j = 0; j < 8; j++)
+            state[rng() % size] = (u8)rng();
+        size_t block = rng() % (size - 32);
+        for (size_t j = 0; j < 32; j++)
+            state[block + j]++;
+        states.push_back(state);
+    }
+    return states;
+}
+
+TEST(RewindBufferTests, StatesArePoppedBackNewestFirst)
+{
+    auto states = makeStates(100, 4096);
+    RewindBuffer rewind{ 1000, 1024 * 1024 };
+    for (auto& state : states)
+        rewind.push(state);
+
+    EXPECT_EQ(rewind.getFrameCount(), states.size());
+    EXPECT_LT(rewind.getUsedBytes(), 4096 + states.size() * 128);
+
+    std::vector<u8> state;
+    for (size_t i = states.size(); i-- > 0;) {
+        ASSERT_TRUE(rewind.pop(state));
+        ASSERT_EQ(state, states[i]) << "frame " << i;
+    }
+    EXPECT_FALSE(rewind.pop(state));
+    EXPECT_EQ(rewind.getFrameCount(), 0);
+}
+
+TEST(RewindBufferTests, OldestFramesAreDroppedWhenFull)
+{
+    auto states = makeStates(300, 4096);
+
+    RewindBuffer byFrames{ 50, 1024 * 1024 };
+    RewindBuffer byBytes{ 1000, 8 * 1024 };
+    for (auto& state : states) {
+        byFrames.push(state);
+        byBytes.push(state);
+    }
+
+    EXPECT_EQ(byFrames.getFrameCount(), 50);
+    EXPECT_LE(byBytes.getUsedBytes(), 4096 + 8 * 1024);
+    EXPECT_LT(byBytes.getFrameCount(), states.size());
+
+    // Remaining history still rewinds correctly after ring wrapped around.
+    std::vector<u8> state;
+    size_t frames = byBytes.getFrameCount();
+    for (size_t i = 0; i < frames; i++) {
+        ASSERT_TRUE(byBytes.pop(state));
+        ASSERT_EQ(state, states[states.size() - 1 - i]);
+    }
+
+    // Interleaving pushes and pops keeps the chain consistent.
+    byFrames.pop(state);
+    byFrames.pop(state);
+    byFrames.push(states[0]);
+    ASSERT_TRUE(byFrames.pop(state));
+    EXPECT_EQ(state, states[0]);
+    ASSERT_TRUE(byFrames.pop(state));
+    EXPECT_EQ(state, states[states.size() - 3]);
+}
+
+TEST(RewindBufferTests, DifferentStateSizeStartsNewHistory)
+{
+    RewindBuffer rewind{ 10, 1024 };
+    rewind.push(std::vector<u8>(16, 1));
+    rewind.push(std::vector<u8>(16, 2));
+    rewind.push(std::vector<u8>(32, 3));
+
+    EXPECT_EQ(rewind.getFrameCount(), 1);
+    std::vector<u8> state;
+    ASSERT_TRUE(rewind.pop(state));
+    EXPECT_EQ(state, std::vector<u8>(32, 3));
+}
@@ -0,0 +1,53 @@
+#include "shared/source/save_state.hpp"
+
+#include <gtest/gtest.h>
+
+static constexpr u32 TEST_ID = makeStateID("TEST");
+
+TEST(SaveStateTests, ValuesAreReadBackInWriteOrder)
+{
+    std::vector<u8> state;
+    StateWriter writer{ state, TEST_ID, 1 };
+    writer.write((u8)0x12);
+    writer.write((u16)0x3456);
+    writer.write(true);
+    writer.write((u64)0x0123456789ABCDEF);
+    const u8 memory[3]{ 1, 2, 3 };
+    writer.writeBytes(memory, sizeof(memory));
+
+    // header + 1 + 2 + 1 + 8 + 3, stored without padding
+    EXPECT_EQ(state.size(), 12 + 15);
+    EXPECT_EQ(state[13], 0x56); // little-endian
+
+    StateReader reader{ state, TEST_ID, 1 };
+    u8 byte; u16 word; bool flag; u64 quad; u8 block[3];
+    reader.read(byte);
+    reader.read(word);
+    reader.read(flag);
+    reader.read(quad);
+    reader.readBytes(block, sizeof(block));
+
+    EXPECT_TRUE(reader.isValid());
+    EXPECT_TRUE(reader.isAtEnd());
+    EXPECT_EQ(byte, 0x12);
+    EXPECT_EQ(word, 0x3456);
+    EXPECT_TRUE(flag);
+    EXPECT_EQ(quad, 0x0123456789ABCDEF);
+    EXPECT_EQ(block[2], 3);
+}
+
+TEST(SaveStateTests, HeaderMismatchOrOverrunInvalidatesReader)
+{
+    std::vector<u8> state;
+    StateWriter writer{ state, TEST_ID, 1 };
+    writer.write((u32)0xDEADBEEF);
+
+    EXPECT_FALSE((StateReader{ state, makeStateID("TSET"), 1 }.isValid()));
+    EXPECT_FALSE((StateReader{ state, TEST_ID, 2 }.isValid()));
+
+    StateReader reader{ state, TEST_ID, 1 };
+    u64 tooBig = 1;
+    reader.read(tooBig);
+    EXPECT_FALSE(reader.isValid());
+    EXPECT_EQ(tooBig, 0);
+}
@@ -0,0 +1,112 @@
+#include "shared/source/save_state.hpp"
+#include "shared/source/scheduler.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+struct SchedulerTests :
+    public testing::Test
+{
+    Scheduler scheduler;
+    std::string log;
+};
+
+TEST_F(SchedulerTests, EventsAreDispatchedInTimestampOrder)
+{
+    auto a = scheduler.registerEvent([&]() { log += 'a'; });
+    auto b = scheduler.registerEvent([&]() { log += 'b'; });
+    auto c = scheduler.registerEvent([&]() { log += 'c'; });
+
+    scheduler.schedule(a, 30);
+    scheduler.schedule(b, 10);
+    scheduler.schedule(c, 20);
+    EXPECT_EQ(scheduler.getNextEventTime(), 10);
+    EXPECT_EQ(scheduler.getCyclesUntilNextEvent(), 10);
+
+    scheduler.advance(9);
+    EXPECT_EQ(log, "");
+
+    scheduler.advance(25);
+    EXPECT_EQ(log, "bca");
+    EXPECT_EQ(scheduler.getNow(), 34);
+    EXPECT_EQ(scheduler.getNextEventTime(), Scheduler::NEVER);
+}
+
+TEST_F(SchedulerTests, EventsWithTheSameTimestampKeepSchedulingOrder)
+{
+    auto a = scheduler.registerEvent([&]() { log += 'a'; });
+    auto b = scheduler.registerEvent([&]() { log += 'b'; });
+
+    scheduler.schedule(b, 5);
+    scheduler.schedule(a, 5);
+    scheduler.advance(5);
+
+    EXPECT_EQ(log, "ba");
+}
+
+TEST_F(SchedulerTests, RescheduleAndCancel)
+{
+    auto a = scheduler.registerEvent([&]() { log += 'a'; });
+    auto b = scheduler.registerEvent([&]() { log += 'b'; });
+
+    scheduler.schedule(a, 10);
+    scheduler.schedule(b, 20);
+    scheduler.schedule(a, 30);
+    scheduler.cancel(b);
+    EXPECT_FALSE(scheduler.isScheduled(b));
+    EXPECT_TRUE(scheduler.isScheduled(a));
+
+    scheduler.advance(29);
+    EXPECT_EQ(log, "");
+    scheduler.advance(1);
+    EXPECT_EQ(log, "a");
+    EXPECT_FALSE(scheduler.isScheduled(a));
+}
+
+TEST_F(SchedulerTests, PeriodicEventDoesNotDrift)
+{
+    std::vector<u64> timestamps;
+    Scheduler::EventID tick = 0;
+    tick = scheduler.registerEvent([&]() {
+        timestamps.push_back(scheduler.getNow());
+        scheduler.scheduleIn(tick, 7);
+    });
+
+    scheduler.scheduleIn(tick, 7);
+    scheduler.advance(3);
+    scheduler.advance(20);
+
+    EXPECT_EQ(timestamps, (std::vector<u64>{ 7, 14, 21 }));
+    EXPECT_EQ(scheduler.getNow(), 23);
+    EXPECT_EQ(scheduler.getNextEventTime(), 28);
+}
+
+TEST_F(SchedulerTests, LoadedStateDispatchesEventsInSavedOrder)
+{
+    auto a = scheduler.registerEvent([&]() { log += 'a'; });
+    auto b = scheduler.registerEvent([&]() { log += 'b'; });
+    auto c = scheduler.registerEvent([&]() { log += 'c'; });
+
+    scheduler.advance(5);
+    scheduler.schedule(b, 10);
+    scheduler.schedule(a, 10);
+    scheduler.schedule(c, 8);
+
+    std::vector<u8> state;
+    StateWriter writer{ state, 0, 0 };
+    scheduler.saveState(writer);
+
+    scheduler.reset();
+    scheduler.schedule(a, 1);
+
+    StateReader reader{ state, 0, 0 };
+    scheduler.loadState(reader);
+    ASSERT_TRUE(reader.isValid());
+    EXPECT_EQ(scheduler.getNow(), 5);
+    EXPECT_EQ(scheduler.getNextEventTime(), 8);
+
+    scheduler.advance(5);
+    EXPECT_EQ(log, "cba");
+}
@@ -0,0 +1,56 @@
+#include "shared/source/spsc_ring.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+TEST(SPSCRingTests, ElementsComeOutInOrderAndFullRingDropsPushes)
+{
+    SPSCRing<u32> ring{ 3 };
+    ASSERT_EQ(ring.getCapacity(), 4u);
+
+    u32 value;
+    EXPECT_FALSE(ring.pop(value));
+
+    // wrap around few times
+    u32 next = 0, expected = 0;
+    for (u32 round = 0; round < 5; round++) {
+        for (u32 i = 0; i < 4; i++)
+            EXPECT_TRUE(ring.push(next++));
+        EXPECT_FALSE(ring.push(1000));
+
+        for (u32 i = 0; i < 3; i++) {
+            ASSERT_TRUE(ring.pop(value));
+            EXPECT_EQ(value, expected++);
+        }
+        ASSERT_TRUE(ring.pop(value));
+        EXPECT_EQ(value, expected++);
+        EXPECT_FALSE(ring.pop(value));
+    }
+}
+
+TEST(SPSCRingTests, ConsumerSeesEveryPushedElementOnce)
+{
+    constexpr u64 COUNT = 200000;
+    SPSCRing<u64> ring{ 64 };
+
+    std::thread producer{
+        [&]() {
+            for (u64 i = 1; i <= COUNT; i++)
+                while (!ring.push(i))
+                    std::this_thread::yield();
+        }
+    };
+
+    u64 expected = 1, value;
+    while (expected <= COUNT) {
+        if (ring.pop(value)) {
+            ASSERT_EQ(value, expected);
+            expected++;
+        }
+        else std::this_thread::yield();
+    }
+
+    producer.join();
+    EXPECT_FALSE(ring.pop(value));
+}
@@ -0,0 +1,63 @@
+#include "shared/source/triple_buffer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+TEST(TripleBufferTests, AcquireReturnsNewestPublishedBuffer)
+{
+    TripleBuffer<int> buffer{ -1 };
+
+    EXPECT_EQ(buffer.acquire(), -1);
+    EXPECT_EQ(buffer.getSequence(), 0);
+
+    buffer.getWriteBuffer() = 1;
+    buffer.publish();
+    buffer.getWriteBuffer() = 2;
+    buffer.publish();
+
+    EXPECT_EQ(buffer.acquire(), 2);
+    EXPECT_EQ(buffer.getSequence(), 2);
+
+    // nothing new was published, same buffer and sequence are kept
+    EXPECT_EQ(buffer.acquire(), 2);
+    EXPECT_EQ(buffer.getSequence(), 2);
+
+    buffer.getWriteBuffer() = 3;
+    buffer.publish();
+    EXPECT_EQ(buffer.acquire(), 3);
+    EXPECT_EQ(buffer.getSequence(), 3);
+}
+
+TEST(TripleBufferTests, ConsumerNeverSeesTornFrame)
+{
+    constexpr u64 FRAME_COUNT = 20000;
+    TripleBuffer<std::vector<u64>> buffer{ std::vector<u64>(256, 0) };
+
+    std::thread producer{
+        [&]() {
+            for (u64 frame = 1; frame <= FRAME_COUNT; frame++) {
+                for (auto& value : buffer.getWriteBuffer())
+                    value = frame;
+                buffer.publish();
+            }
+        }
+    };
+
+    u64 lastSequence = 0;
+    bool inOrder = true;
+    bool torn = false;
+    while (lastSequence < FRAME_COUNT) {
+        const auto& frame = buffer.acquire();
+        u64 sequence = buffer.getSequence();
+        inOrder &= sequence >= lastSequence;
+        for (u64 value : frame)
+            torn |= value != sequence;
+        lastSequence = sequence;
+    }
+
+    producer.join();
+    EXPECT_TRUE(inOrder);
+    EXPECT_FALSE(torn);
+}